@@ -0,0 +1,264 @@
+/**
+ * Command Line Interface of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <fstream>
+#include <format>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <print>
+
+// cpb includes
+#include <cpb/query_result.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/profiler.hpp>
+#include <cpb/query.hpp>
+#include <cpb/time.hpp>
+
+// custom includes
+#include <cli/batch.hpp>
+
+namespace {
+
+/// A query of the file, and the result of running it.
+struct batch_query {
+	/// Line of the file, starting at 1.
+	size_t line;
+	/// The query as written in the file.
+	std::string text;
+	/// The parsed query.
+	cpb::querier Q;
+	/// Is the query valid?
+	bool valid;
+
+	/// Number of positions that match the query.
+	size_t count = 0;
+	/// Time it took to find them, in microseconds.
+	double time = 0;
+};
+
+[[nodiscard]] bool
+read_queries(const std::string_view file, std::vector<batch_query>& queries)
+{
+	std::ifstream fin(file.data());
+	if (not fin.is_open()) {
+		std::print(std::cerr, "Query file '{}' could not be opened.\n", file);
+		return false;
+	}
+
+	std::string line;
+	size_t line_number = 0;
+	while (std::getline(fin, line)) {
+		++line_number;
+		if (not line.empty() and line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty() or line[0] == '#') {
+			continue;
+		}
+
+		batch_query& q = queries.emplace_back();
+		q.line = line_number;
+		q.valid = cpb::parse_query(line, q.Q);
+		q.text = std::move(line);
+		if (not q.valid) {
+			std::print(
+				std::cerr, "Invalid query in line {}: '{}'\n", q.line, q.text
+			);
+		}
+	}
+	return true;
+}
+
+void run_queries(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index *const index,
+	std::vector<batch_query>& queries,
+	const size_t num_threads
+)
+{
+	PROFILE_FUNCTION;
+
+	std::atomic<size_t> next = 0;
+	const auto worker = [&]()
+	{
+		// reused by all the queries of this thread
+		cpb::query_result result;
+
+		size_t i = next.fetch_add(1, std::memory_order_relaxed);
+		while (i < queries.size()) {
+			batch_query& q = queries[i];
+			if (q.valid) {
+				const auto begin = cpb::now();
+				result.build(db, q.Q, {}, nullptr, index);
+				const auto end = cpb::now();
+				q.count = result.size();
+				q.time = cpb::elapsed_time(begin, end);
+			}
+			i = next.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	std::vector<std::jthread> threads;
+	threads.reserve(num_threads - 1);
+	for (size_t t = 1; t < num_threads; ++t) {
+		threads.emplace_back(worker);
+	}
+	worker();
+}
+
+/**
+ * @brief Returns @e text with every character in @e special preceded by
+ * @e escape.
+ *
+ * Invalid queries are written as they are in the file, so they may contain
+ * anything.
+ */
+[[nodiscard]] std::string escape_text(
+	const std::string_view text,
+	const std::string_view special,
+	const char escape
+)
+{
+	std::string s;
+	s.reserve(text.size());
+	for (const char c : text) {
+		if (special.find(c) != std::string_view::npos) {
+			s += escape;
+		}
+		s += c;
+	}
+	return s;
+}
+
+void write_csv(const std::vector<batch_query>& queries, std::string& out)
+{
+	auto it = std::back_inserter(out);
+	std::format_to(it, "line,query,count,microseconds\n");
+	for (const batch_query& q : queries) {
+		if (q.valid) {
+			std::format_to(
+				it,
+				"{},\"{}\",{},{:.1f}\n",
+				q.line,
+				escape_text(q.text, "\"", '"'),
+				q.count,
+				q.time
+			);
+		}
+		else {
+			std::format_to(
+				it, "{},\"{}\",,\n", q.line, escape_text(q.text, "\"", '"')
+			);
+		}
+	}
+}
+
+void write_json(const std::vector<batch_query>& queries, std::string& out)
+{
+	auto it = std::back_inserter(out);
+	out += "[\n";
+	for (size_t i = 0; i < queries.size(); ++i) {
+		const batch_query& q = queries[i];
+		if (q.valid) {
+			std::format_to(
+				it,
+				"{{\"line\":{},\"query\":\"{}\",\"count\":{},"
+				"\"microseconds\":{:.1f}}}",
+				q.line,
+				escape_text(q.text, "\"\\", '\\'),
+				q.count,
+				q.time
+			);
+		}
+		else {
+			std::format_to(
+				it,
+				"{{\"line\":{},\"query\":\"{}\",\"error\":\"invalid query\"}}",
+				q.line,
+				escape_text(q.text, "\"\\", '\\')
+			);
+		}
+		out += (i + 1 < queries.size() ? ",\n" : "\n");
+	}
+	out += "]\n";
+}
+
+} // namespace
+
+bool run_query_file(const cpb::PuzzleDatabase& db, const batch_options& options)
+{
+	PROFILE_FUNCTION;
+
+	std::vector<batch_query> queries;
+	if (not read_queries(options.query_file, queries)) {
+		return false;
+	}
+
+	const size_t num_threads = std::max<size_t>(1, options.num_threads);
+	const auto begin = cpb::now();
+	run_queries(db, options.index, queries, num_threads);
+	const auto end = cpb::now();
+	const double total = cpb::elapsed_time(begin, end);
+
+	std::string out;
+	out.reserve(queries.size() * 64);
+	if (options.format == batch_format::csv) {
+		write_csv(queries, out);
+	}
+	else {
+		write_json(queries, out);
+	}
+
+	if (options.output_file.empty()) {
+		std::cout << out;
+		std::cout.flush();
+	}
+	else {
+		std::ofstream fout(options.output_file.data());
+		if (not fout.is_open()) {
+			std::print(
+				std::cerr,
+				"Output file '{}' could not be opened.\n",
+				options.output_file
+			);
+			return false;
+		}
+		fout << out;
+	}
+
+	std::print(
+		std::cerr,
+		"Ran {} queries with {} threads in {} ({:.1f} queries per second).\n",
+		queries.size(),
+		num_threads,
+		cpb::time_to_str(total),
+		total > 0 ? static_cast<double>(queries.size()) * 1e6 / total : 0.0
+	);
+	return true;
+}
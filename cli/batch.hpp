@@ -0,0 +1,67 @@
+/**
+ * Command Line Interface of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <cstddef>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+
+/// Format of the results of a batch of queries.
+enum class batch_format {
+	/// One line per query: line, query, count, microseconds.
+	csv,
+	/// An array with one object per query.
+	json
+};
+
+/// Options of a batch of queries.
+struct batch_options {
+	/// File with one query per line.
+	std::string_view query_file;
+	/// File the results are written to. Standard output if empty.
+	std::string_view output_file;
+	/// Format of the results.
+	batch_format format = batch_format::csv;
+	/// Number of threads running queries concurrently.
+	size_t num_threads = 1;
+	/// The index of the database, if any.
+	const cpb::database_index *index = nullptr;
+};
+
+/**
+ * @brief Runs all the queries in a file against @e db.
+ *
+ * Every line of the file contains a query in the syntax of
+ * @ref cpb::parse_query. Empty lines and lines starting with '#' are
+ * skipped. The number of positions that match every query and the time it
+ * took to find them are written in the format requested. A summary of the
+ * throughput is printed at the end.
+ * @returns Whether or not the files could be read and written.
+ */
+[[nodiscard]] bool
+run_query_file(const cpb::PuzzleDatabase& db, const batch_options& options);
@@ -23,8 +23,18 @@
 
 // C++ includes
 #include <iostream>
+#include <optional>
+#include <fstream>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <sstream>
 #include <print>
 
+// C includes
+#include <fcntl.h>
+#include <unistd.h>
+
 // ctree includes
 #include <ctree/ctree.hpp>
 #include <ctree/range_iterator.hpp>
@@ -34,14 +44,21 @@
 // cpb includes
 #include <cpb/profiler.hpp>
 #include <cpb/arena_allocator.hpp>
+#include <cpb/schema_builder.hpp>
+#include <cpb/query_planner.hpp>
+#include <cpb/database_index.hpp>
 #include <cpb/database.hpp>
 #include <cpb/position.hpp>
 #include <cpb/lichess.hpp>
 #include <cpb/formats.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/query_export.hpp>
 #include <cpb/query.hpp>
 #include <cpb/time.hpp>
 
 // custom includes
+#include <cli/batch.hpp>
+#include <cli/output_writer.hpp>
 #include <cli/query.hpp>
 
 template <class... Args>
@@ -140,9 +157,64 @@ void show_turn_query() noexcept
 	}
 }
 
+void show_square_query() noexcept
+{
+	std::print("Query for squares? ");
+	if (Q.squares.empty()) {
+		std::print("No\n");
+		return;
+	}
+	std::print("\n");
+	for (size_t s = 0; s < 64; ++s) {
+		for (size_t c = 0; c < cpb::NUM_SQUARE_CONTENTS; ++c) {
+			if ((Q.squares.required[c] >> s) & 1) {
+				std::print(
+					"    {}{}: {}\n",
+					static_cast<char>('a' + s % 8),
+					static_cast<char>('1' + s / 8),
+					cpb::SQUARE_CONTENTS[c]
+				);
+			}
+		}
+	}
+}
+
+void show_endgame_query() noexcept
+{
+	std::print("Query for endgame class? ");
+	if (not Q.endgame) {
+		std::print("No\n");
+	}
+	else {
+		std::print("    {}\n", cpb::to_string(*Q.endgame));
+	}
+}
+
+void show_pawn_query() noexcept
+{
+	std::print("Query for pawn structure? ");
+	if (not Q.pawn_structure) {
+		std::print("No\n");
+	}
+	else {
+		std::print("    {}\n", cpb::to_string(*Q.pawn_structure));
+	}
+}
+
+void show_king_query() noexcept
+{
+	std::print("Query for king squares? ");
+	if (not Q.kings) {
+		std::print("No\n");
+	}
+	else {
+		std::print("    {}\n", cpb::to_string(*Q.kings));
+	}
+}
+
 void process_query() noexcept
 {
-	std::print("what (piece/global/turn/reset)> ");
+	std::print("what (piece/global/turn/square/endgame/pawns/kings/reset)> ");
 	std::string option;
 	std::cin >> option;
 
@@ -254,6 +326,109 @@ void process_query() noexcept
 			Q.query_player_turn = {};
 		}
 	}
+	else if (option == "square") {
+		std::print("square (a1..h8)> ");
+		std::string square;
+		std::cin >> square;
+
+		// set, unset
+		std::print("action (set/unset)> ");
+		std::string action_type;
+		std::cin >> action_type;
+
+		const std::optional<size_t> s = cpb::parse_square(square);
+		if (not s) {
+			printerr("Unknown square '{}'\n", square);
+			return;
+		}
+
+		if (action_type == "set") {
+			std::print("content (PRNBQKprnbqk or . for empty)> ");
+			char content;
+			std::cin >> content;
+
+			const size_t c = cpb::square_content_index(content);
+			if (c == cpb::NUM_SQUARE_CONTENTS) {
+				printerr("Unknown content '{}'\n", content);
+				return;
+			}
+			Q.squares.set(*s, c);
+		}
+		else if (action_type == "unset") {
+			for (uint64_t& r : Q.squares.required) {
+				r &= ~(uint64_t{1} << *s);
+			}
+		}
+	}
+	else if (option == "endgame") {
+		// set, unset
+		std::print("action (set/unset)> ");
+		std::string action_type;
+		std::cin >> action_type;
+
+		if (action_type == "set") {
+			std::print("class (as in KRPvKR, '*' for more pawns)> ");
+			std::string endgame;
+			std::cin >> endgame;
+
+			const std::optional<cpb::endgame_class> E =
+				cpb::parse_endgame_class(endgame);
+			if (not E) {
+				printerr("Invalid endgame class '{}'\n", endgame);
+				return;
+			}
+			Q.endgame = *E;
+		}
+		else if (action_type == "unset") {
+			Q.endgame = {};
+		}
+	}
+	else if (option == "pawns") {
+		// set, unset
+		std::print("action (set/unset)> ");
+		std::string action_type;
+		std::cin >> action_type;
+
+		if (action_type == "set") {
+			std::print("pawns (as in e:d4,e3/d5,e6, 'c' to contain them)> ");
+			std::string pawns;
+			std::cin >> pawns;
+
+			const std::optional<cpb::pawn_query> P =
+				cpb::parse_pawn_query(pawns);
+			if (not P) {
+				printerr("Invalid pawn structure '{}'\n", pawns);
+				return;
+			}
+			Q.pawn_structure = *P;
+		}
+		else if (action_type == "unset") {
+			Q.pawn_structure = {};
+		}
+	}
+	else if (option == "kings") {
+		// set, unset
+		std::print("action (set/unset)> ");
+		std::string action_type;
+		std::cin >> action_type;
+
+		if (action_type == "set") {
+			std::print("squares (as in w:1;b:g8,h; with ranks and files)> ");
+			std::string kings;
+			std::cin >> kings;
+
+			const std::optional<cpb::king_query> K =
+				cpb::parse_king_query(kings);
+			if (not K) {
+				printerr("Invalid king squares '{}'\n", kings);
+				return;
+			}
+			Q.kings = *K;
+		}
+		else if (action_type == "unset") {
+			Q.kings = {};
+		}
+	}
 	else if (option == "reset") {
 		unset_query_field(Q.pawns, "white");
 		unset_query_field(Q.pawns, "black");
@@ -277,7 +452,158 @@ void process_query() noexcept
 
 		Q.query_total_pieces = {};
 		Q.query_player_turn = {};
+		Q.squares.reset();
+		Q.endgame = {};
+		Q.pawn_structure = {};
+		Q.kings = {};
+	}
+}
+
+/// Options of the command 'run'.
+struct run_options {
+	/// Maximum number of positions written.
+	size_t limit = std::numeric_limits<size_t>::max();
+	/// File the positions are written to. Standard output if empty.
+	std::string output_file;
+	/// Format of the positions.
+	output_format format = output_format::pretty;
+};
+
+/**
+ * @brief Parses the options of the command 'run' from @e line.
+ *
+ * The options are '--limit n', '--output file' and '--format f' where f is
+ * one of 'fen', 'board' or 'pretty'.
+ * @returns Whether or not all the options are valid.
+ */
+[[nodiscard]] bool parse_run_options(const std::string& line, run_options& opts)
+{
+	std::istringstream in(line);
+	std::string name;
+	while (in >> name) {
+		if (name == "--limit") {
+			if (not (in >> opts.limit)) {
+				printerr("Missing number of positions after '--limit'\n");
+				return false;
+			}
+		}
+		else if (name == "--output") {
+			if (not (in >> opts.output_file)) {
+				printerr("Missing file name after '--output'\n");
+				return false;
+			}
+		}
+		else if (name == "--format") {
+			std::string format;
+			in >> format;
+			const std::optional<output_format> f = parse_output_format(format);
+			if (not f) {
+				printerr("Unknown output format '{}'\n", format);
+				return false;
+			}
+			opts.format = *f;
+		}
+		else {
+			printerr("Unknown option of 'run' '{}'\n", name);
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Options of the command 'export'.
+struct export_command_options {
+	/// File the positions are written to.
+	std::string output_file;
+	/// Format of the file.
+	cpb::export_format format = cpb::export_format::fen;
+	/// Number of threads formatting the positions.
+	size_t num_threads = 1;
+};
+
+/**
+ * @brief Parses the options of the command 'export' from @e line.
+ *
+ * The options are '--output file' (mandatory), '--format f' where f is one
+ * of 'fen', 'csv' or 'ndjson', and '--threads n'.
+ * @returns Whether or not all the options are valid.
+ */
+[[nodiscard]] bool
+parse_export_options(const std::string& line, export_command_options& opts)
+{
+	std::istringstream in(line);
+	std::string name;
+	while (in >> name) {
+		if (name == "--output") {
+			if (not (in >> opts.output_file)) {
+				printerr("Missing file name after '--output'\n");
+				return false;
+			}
+		}
+		else if (name == "--format") {
+			std::string format;
+			in >> format;
+			const std::optional<cpb::export_format> f =
+				cpb::parse_export_format(format);
+			if (not f) {
+				printerr("Unknown export format '{}'\n", format);
+				return false;
+			}
+			opts.format = *f;
+		}
+		else if (name == "--threads") {
+			if (not (in >> opts.num_threads)) {
+				printerr("Missing number of threads after '--threads'\n");
+				return false;
+			}
+		}
+		else {
+			printerr("Unknown option of 'export' '{}'\n", name);
+			return false;
+		}
+	}
+	if (opts.output_file.empty()) {
+		printerr("Missing option '--output'\n");
+		return false;
 	}
+	return true;
+}
+
+void export_positions(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const export_command_options& opts
+)
+{
+	PROFILE_FUNCTION;
+
+	std::ofstream fout(opts.output_file, std::ios::binary);
+	if (not fout.is_open()) {
+		printerr("Output file '{}' could not be opened.\n", opts.output_file);
+		return;
+	}
+
+	const auto begin = cpb::now();
+	const std::optional<size_t> count = cpb::export_query(
+		db,
+		Q,
+		opts.format,
+		[&fout](const std::string_view chunk)
+		{
+			const auto size = static_cast<std::streamsize>(chunk.size());
+			fout.write(chunk.data(), size);
+			return fout.good();
+		},
+		{.num_threads = opts.num_threads, .index = &index}
+	);
+	const auto end = cpb::now();
+
+	if (not count) {
+		printerr("The positions could not be written.\n");
+		return;
+	}
+	std::print("Exported {} positions.\n", *count);
+	std::print("In {}.\n", cpb::time_to_str(cpb::elapsed_time(begin, end)));
 }
 
 void load_lichess_database(
@@ -291,8 +617,9 @@ void load_lichess_database(
 	const auto begin = cpb::now();
 	const size_t initial_db_size = db.size();
 	const auto res =
-		(read_memory_profile ? cpb::lichess::load_database_initialized(file, db)
-							 : cpb::lichess::load_database(file, db));
+		(read_memory_profile
+			 ? cpb::lichess::load_database_initialized(file, db, square_levels)
+			 : cpb::lichess::load_database(file, db, square_levels));
 	const auto end = cpb::now();
 
 	if (res.has_value()) {
@@ -331,6 +658,21 @@ int main(int argc, char *argv[])
 	bool read_memory_profile = false;
 	std::string_view input_memory_profile;
 
+	// choose the squares of the last levels from a sample of the database
+	bool auto_square_levels = false;
+	// positions in the sample used to choose the square levels
+	size_t schema_sample_size = 100000;
+	// secondary layouts of the database used by the query planner
+	std::vector<cpb::index_layout> index_layouts;
+	// index the positions by pawn skeleton
+	bool index_pawns = false;
+	// index the positions by the squares of the kings
+	bool index_kings = false;
+
+	// run the queries of a file instead of the interactive prompt
+	bool run_batch = false;
+	batch_options batch;
+
 	std::vector<std::pair<std::string_view, cpb::database_format>>
 		lichess_databases;
 
@@ -352,6 +694,68 @@ int main(int argc, char *argv[])
 			output_memory_profile = argv[i + 1];
 			++i;
 		}
+		else if (option_name == "--query-file") {
+			run_batch = true;
+			batch.query_file = argv[i + 1];
+			++i;
+		}
+		else if (option_name == "--query-output") {
+			batch.output_file = argv[i + 1];
+			++i;
+		}
+		else if (option_name == "--query-format") {
+			const std::string_view format(argv[i + 1]);
+			if (format == "csv") {
+				batch.format = batch_format::csv;
+			}
+			else if (format == "json") {
+				batch.format = batch_format::json;
+			}
+			else {
+				printerr("Unknown query format '{}'\n", format);
+				return 1;
+			}
+			++i;
+		}
+		else if (option_name == "--query-threads") {
+			batch.num_threads = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--square-levels") {
+			if (std::string_view{argv[i + 1]} == "auto") {
+				auto_square_levels = true;
+				++i;
+				continue;
+			}
+			const std::optional<cpb::square_levels> levels =
+				cpb::parse_square_levels(argv[i + 1]);
+			if (not levels) {
+				printerr("Invalid square levels '{}'\n", argv[i + 1]);
+				return 1;
+			}
+			square_levels = *levels;
+			auto_square_levels = false;
+			++i;
+		}
+		else if (option_name == "--index-layouts") {
+			const auto layouts = cpb::parse_index_layouts(argv[i + 1]);
+			if (not layouts) {
+				printerr("Invalid index layouts '{}'\n", argv[i + 1]);
+				return 1;
+			}
+			index_layouts = *layouts;
+			++i;
+		}
+		else if (option_name == "--index-pawns") {
+			index_pawns = true;
+		}
+		else if (option_name == "--index-kings") {
+			index_kings = true;
+		}
+		else if (option_name == "--schema-sample-size") {
+			schema_sample_size = std::max(1ul, std::stoul(argv[i + 1]));
+			++i;
+		}
 #if defined USE_INSTRUMENTATION
 		else if (option_name == "--instrumentation-session") {
 			intstrumentation_session = argv[i + 1];
@@ -372,6 +776,33 @@ int main(int argc, char *argv[])
 	PROFILER_START_SESSION(intstrumentation_session, "id");
 	PROFILE_FUNCTION;
 
+	// a memory profile has its own square levels
+	if (auto_square_levels and not read_memory_profile and
+		not lichess_databases.empty()) {
+		std::print("--------------------------\n");
+		std::print(
+			"Choosing the square levels from {} positions of '{}'.\n",
+			schema_sample_size,
+			lichess_databases.front().first
+		);
+		const auto levels = cpb::choose_square_levels(
+			lichess_databases.front().first, schema_sample_size
+		);
+		if (not levels) {
+			printerr("The square levels could not be chosen.\n");
+			if (levels.error() == cpb::lichess::load_error::file_error) {
+				printerr("    File could not be loaded.\n");
+			}
+			else if (levels.error() ==
+					 cpb::lichess::load_error::invalid_position) {
+				printerr("    Contains some invalid position.\n");
+			}
+			return 1;
+		}
+		square_levels = *levels;
+		std::print("    Square levels: {}\n", cpb::to_string(square_levels));
+	}
+
 	cpb::arena_allocator arena;
 	cpb::PuzzleDatabase db;
 
@@ -380,12 +811,6 @@ int main(int argc, char *argv[])
 		std::print("Reading memory profile '{}'.\n", input_memory_profile);
 
 		std::ifstream fin(input_memory_profile.data());
-
-		size_t total_bytes;
-		fin >> total_bytes;
-		std::print("    Total bytes: {}\n", total_bytes);
-		arena.initialize(total_bytes);
-
 		if (not fin.is_open()) {
 			printerr(
 				"Input memory profile file '{}' could not be opened.\n",
@@ -394,6 +819,21 @@ int main(int argc, char *argv[])
 			return 1;
 		}
 
+		// the tree has to be filled with the levels it was profiled with
+		const std::optional<cpb::square_levels> levels =
+			cpb::read_profile_header(fin);
+		if (not levels) {
+			printerr("Invalid memory profile header.\n");
+			return 1;
+		}
+		square_levels = *levels;
+		std::print("    Square levels: {}\n", cpb::to_string(square_levels));
+
+		size_t total_bytes;
+		fin >> total_bytes;
+		std::print("    Total bytes: {}\n", total_bytes);
+		arena.initialize(total_bytes);
+
 		classtree::initialize(db, fin, &arena);
 		fin.close();
 	}
@@ -406,17 +846,54 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	cpb::database_index index;
+	index.levels = square_levels;
+	index.layouts.enable(index_layouts);
+	index.skeletons.enable(index_pawns);
+	index.kings.enable(index_kings);
+	index.add(db);
+	batch.index = &index;
+
 	std::print("===========================\n");
 
+	if (run_batch) {
+		if (not run_query_file(db, batch)) {
+			return 1;
+		}
+	}
+
+	std::mt19937_64 gen(std::random_device{}());
+	// reused by all the executions of 'run'
+	output_writer writer;
+
 	std::string option;
-	std::print("option> ");
-	while (std::cin >> option and option != "exit") {
+	if (not run_batch) {
+		std::print("option> ");
+	}
+	while (not run_batch and std::cin >> option and option != "exit") {
 		if (option == "query") {
 			process_query();
 		}
 		else if (option == "info") {
 			std::print("Databse statistics:\n");
 			std::print("    Size: {}\n", db.size());
+			std::print(
+				"    Square levels: {}\n", cpb::to_string(square_levels)
+			);
+			const cpb::level_statistics stats = cpb::measure_levels(db);
+			std::print("    Leaves: {}\n", stats.num_leaves);
+			std::print("    Index bytes: {}\n", index.num_bytes());
+			std::print(
+				"    Expected leaf size: {:.2f}\n", stats.expected_leaf_size
+			);
+			for (size_t l = 0; l < cpb::NUM_LEVELS; ++l) {
+				std::print(
+					"    Level {:>2}: entropy {:.3f} bits, fan-out {:.2f}\n",
+					l,
+					stats.entropy[l],
+					stats.fan_out[l]
+				);
+			}
 		}
 		else if (option == "show") {
 			show_piece_query("pawns", Q.pawns);
@@ -426,8 +903,53 @@ int main(int argc, char *argv[])
 			show_piece_query("queens", Q.queens);
 			show_total_query();
 			show_turn_query();
+			show_square_query();
+			show_endgame_query();
+			show_pawn_query();
+			show_king_query();
+
+			const cpb::query_plan plan =
+				cpb::plan_query(Q, index.layouts.find(db));
+			std::print(
+				"Query plan: {} (estimated cost {:.0f})\n",
+				cpb::to_string(plan.layout),
+				plan.cost
+			);
 		}
 		else if (option == "run") {
+			std::string line;
+			std::getline(std::cin, line);
+
+			run_options opts;
+			if (not parse_run_options(line, opts)) {
+				std::print("option> ");
+				continue;
+			}
+
+			int fd = STDOUT_FILENO;
+			if (not opts.output_file.empty()) {
+				fd = ::open(
+					opts.output_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644
+				);
+				if (fd < 0) {
+					printerr(
+						"Output file '{}' could not be opened.\n",
+						opts.output_file
+					);
+					std::print("option> ");
+					continue;
+				}
+			}
+			// the positions bypass the buffers of the standard output
+			std::cout.flush();
+			std::fflush(stdout);
+			writer.set_file_descriptor(fd);
+
+			// the functions of the levels only look at the bounds
+			const cpb::querier saved_query = Q;
+			cpb::restrict_to_endgame(Q);
+			cpb::restrict_to_pawns(Q);
+
 			auto it = db.get_const_range_iterator_begin(
 				white_pawns,
 				black_pawns,
@@ -440,28 +962,69 @@ int main(int argc, char *argv[])
 				white_queens,
 				black_queens,
 				turn_func,
-				true_func,
-				true_func,
-				true_func,
-				true_func,
-				true_func
+				square_func<0>,
+				square_func<1>,
+				square_func<2>,
+				square_func<3>,
+				square_func<4>
 			);
 
 			size_t num_positions = 0;
-			while (not it.end()) {
-				const auto& pos = *it;
-				std::cout << pos.to_pretty_string() << '\n';
+			while (not it.end() and num_positions < opts.limit) {
+				const bool pawns_match =
+					not Q.pawn_structure or
+					Q.pawn_structure->matches(cpb::make_pawn_skeleton(*it));
+				const bool kings_match =
+					not Q.kings or
+					Q.kings->matches(cpb::make_king_placement(*it));
+				const bool matches =
+					Q.squares.matches(*it) and pawns_match and kings_match;
+				if (matches) {
+					writer.write(*it, opts.format);
+					++num_positions;
+				}
 				++it;
-				++num_positions;
+			}
+			Q = saved_query;
+			writer.set_file_descriptor(STDOUT_FILENO);
+			if (fd != STDOUT_FILENO) {
+				::close(fd);
 			}
 			std::print("Num positions: {}\n", num_positions);
 		}
+		else if (option == "export") {
+			std::string line;
+			std::getline(std::cin, line);
+
+			export_command_options opts;
+			if (parse_export_options(line, opts)) {
+				export_positions(db, index, opts);
+			}
+		}
+		else if (option == "random") {
+			std::print("how many> ");
+			size_t k;
+			std::cin >> k;
+
+			cpb::query_result result;
+			result.build(db, Q, {}, nullptr, &index);
+
+			const std::vector<size_t> indices = result.random_indices(k, gen);
+			for (const size_t i : indices) {
+				std::cout << result.seek(i).to_pretty_string() << '\n';
+			}
+			std::print(
+				"Num positions: {} out of {}\n", indices.size(), result.size()
+			);
+		}
 		else {
 			std::print("Unknown option '{}'\n", option);
 		}
 		std::print("option> ");
 	}
-	std::print("\n");
+	if (not run_batch) {
+		std::print("\n");
+	}
 
 	if (write_memory_profile) {
 		std::print("--------------------------\n");
@@ -474,6 +1037,7 @@ int main(int argc, char *argv[])
 			);
 			return 1;
 		}
+		cpb::write_profile_header(fout, square_levels);
 		classtree::output_profile<true>(db, fout);
 		fout.close();
 	}
@@ -0,0 +1,131 @@
+/**
+ * Command Line Interface of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <print>
+
+// C includes
+#include <unistd.h>
+
+// cpb includes
+#include <cpb/fen_parser.hpp>
+
+// custom includes
+#include <cli/output_writer.hpp>
+
+/// Largest number of bytes written for a single position.
+static constexpr size_t MAX_POSITION_LENGTH =
+	std::max<size_t>(cpb::MAX_FEN_LENGTH, 64 + 8 + 1) + 1;
+
+std::optional<output_format>
+parse_output_format(const std::string_view name) noexcept
+{
+	if (name == "fen") {
+		return output_format::fen;
+	}
+	if (name == "board") {
+		return output_format::board;
+	}
+	if (name == "pretty") {
+		return output_format::pretty;
+	}
+	return {};
+}
+
+output_writer::output_writer()
+	: m_fd(STDOUT_FILENO),
+	  m_buffer(new char[BUFFER_SIZE])
+{ }
+
+output_writer::~output_writer() noexcept
+{
+	flush();
+}
+
+void output_writer::set_file_descriptor(const int fd) noexcept
+{
+	flush();
+	m_fd = fd;
+}
+
+void output_writer::write(
+	const cpb::position& p, const output_format format
+) noexcept
+{
+	if (m_size + MAX_POSITION_LENGTH > BUFFER_SIZE) {
+		flush();
+	}
+
+	char *const buf = m_buffer.get() + m_size;
+	size_t n = 0;
+	switch (format) {
+	case output_format::fen:
+		n = cpb::make_fen(p, buf);
+		break;
+
+	case output_format::board:
+		for (size_t rank = 8; rank >= 1; --rank) {
+			for (size_t file = 1; file <= 8; ++file) {
+				buf[n++] = p[file, rank];
+			}
+		}
+		break;
+
+	case output_format::pretty:
+		for (size_t rank = 8; rank >= 1; --rank) {
+			for (size_t file = 1; file <= 8; ++file) {
+				buf[n++] = p[file, rank];
+			}
+			buf[n++] = '\n';
+		}
+		buf[n++] = (p.player_turn == cpb::TURN_WHITE ? 'w' : 'b');
+		break;
+	}
+	buf[n++] = '\n';
+	m_size += n;
+}
+
+bool output_writer::flush() noexcept
+{
+	const char *data = m_buffer.get();
+	size_t remaining = m_size;
+	m_size = 0;
+
+	while (remaining > 0) {
+		const ssize_t w = ::write(m_fd, data, remaining);
+		if (w < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::print(std::cerr, "Output could not be written.\n");
+			return false;
+		}
+		data += w;
+		remaining -= static_cast<size_t>(w);
+	}
+	return true;
+}
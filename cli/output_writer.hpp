@@ -0,0 +1,94 @@
+/**
+ * Command Line Interface of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <cstddef>
+#include <memory>
+
+// cpb includes
+#include <cpb/position.hpp>
+
+/// Format in which positions are written.
+enum class output_format {
+	/// A FEN string.
+	fen,
+	/// The 64 squares of the board in one line, from a8 to h1.
+	board,
+	/// The 8 ranks of the board in 8 lines, followed by the player to move.
+	pretty
+};
+
+/// Returns the format named @e name, if any.
+[[nodiscard]] std::optional<output_format>
+parse_output_format(const std::string_view name) noexcept;
+
+/**
+ * @brief Writes positions into a file descriptor through a large buffer.
+ *
+ * Positions are formatted directly into the buffer, without intermediate
+ * strings, and the buffer is handed to the system with write(2) only when
+ * it is full. The buffer is allocated once and reused for every output.
+ */
+class output_writer {
+public:
+
+	/// Size of the buffer, in bytes.
+	static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+	/// Constructor. Positions are written into the standard output.
+	output_writer();
+	/// Destructor. Flushes the buffer.
+	~output_writer() noexcept;
+
+	output_writer(const output_writer&) = delete;
+	output_writer& operator= (const output_writer&) = delete;
+
+	/**
+	 * @brief Sets the file descriptor positions are written into.
+	 *
+	 * The buffer is flushed into the previous one first.
+	 */
+	void set_file_descriptor(const int fd) noexcept;
+
+	/// Writes @e p in format @e format, followed by a new line.
+	void write(const cpb::position& p, const output_format format) noexcept;
+
+	/**
+	 * @brief Hands the contents of the buffer to the system.
+	 * @returns Whether or not all the contents could be written.
+	 */
+	bool flush() noexcept;
+
+private:
+
+	/// File descriptor positions are written into.
+	int m_fd;
+	/// The buffer.
+	std::unique_ptr<char[]> m_buffer;
+	/// Number of bytes in the buffer.
+	size_t m_size = 0;
+};
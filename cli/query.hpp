@@ -26,7 +26,13 @@
 // classtree includes
 #include <ctree/ctree.hpp>
 
+// C++ includes
+#include <cstdint>
+#include <cstddef>
+
 // cpb includes
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
 #include <cpb/query.hpp>
 #include <cpb/attribute_utils.hpp>
 
@@ -205,9 +211,20 @@ black_inspect(const cpb::query_data& q, const int total_so_far) noexcept
 	return Q.query_player_turn ? i == Q.query_player_turn : true;
 }
 
-// identity true
+// square levels
+
+/// The squares of the last levels of the database.
+static cpb::square_levels square_levels;
 
-[[nodiscard]] FORCE_INLINE bool true_func(const char) noexcept
+/// Is the content @e c of the square of the @e i-th square level accepted?
+template <size_t i>
+[[nodiscard]] FORCE_INLINE bool square_func(const char c) noexcept
 {
+	const uint64_t bit = uint64_t{1} << square_levels.squares[i];
+	for (size_t k = 0; k < cpb::NUM_SQUARE_CONTENTS; ++k) {
+		if ((Q.squares.required[k] & bit) != 0) {
+			return c == cpb::SQUARE_CONTENTS[k];
+		}
+	}
 	return true;
 }
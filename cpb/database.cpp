@@ -0,0 +1,105 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// cpb includes
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+
+namespace cpb {
+
+std::optional<square_levels> parse_square_levels(std::string_view s) noexcept
+{
+	square_levels levels;
+	uint64_t used = 0;
+	for (size_t i = 0; i < NUM_SQUARE_LEVELS; ++i) {
+		const size_t comma = s.find(',');
+		const std::optional<size_t> square = parse_square(s.substr(0, comma));
+		if (not square or ((used >> *square) & 1) == 1) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid or repeated square in '" << s << "'\n";
+			return {};
+		}
+		used |= uint64_t{1} << *square;
+		levels.squares[i] = static_cast<uint8_t>(*square);
+
+		const bool last = i + 1 == NUM_SQUARE_LEVELS;
+		if (last != (comma == std::string_view::npos)) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Expected exactly " << NUM_SQUARE_LEVELS
+					  << " squares\n";
+			return {};
+		}
+		if (not last) {
+			s.remove_prefix(comma + 1);
+		}
+	}
+	return levels;
+}
+
+std::string to_string(const square_levels& levels)
+{
+	std::string s;
+	for (const uint8_t square : levels.squares) {
+		if (not s.empty()) {
+			s += ',';
+		}
+		s += static_cast<char>('a' + square % 8);
+		s += static_cast<char>('1' + square / 8);
+	}
+	return s;
+}
+
+/// First word of the header of a memory profile.
+static constexpr std::string_view PROFILE_HEADER = "square-levels";
+
+void write_profile_header(std::ostream& os, const square_levels& levels)
+{
+	os << PROFILE_HEADER << ' ' << to_string(levels) << '\n';
+}
+
+std::optional<square_levels> read_profile_header(std::istream& is)
+{
+	is >> std::ws;
+	if (is.peek() != PROFILE_HEADER[0]) {
+		return square_levels{};
+	}
+
+	std::string header, levels;
+	is >> header >> levels;
+	if (header != PROFILE_HEADER) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Invalid header '" << header << "'\n";
+		return {};
+	}
+	return parse_square_levels(levels);
+}
+
+} // namespace cpb
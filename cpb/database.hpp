@@ -23,6 +23,16 @@
 
 #pragma once
 
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <array>
+
 // classtree includes
 // visit
 //    https://github.com/lluisalemanypuig/classification-tree
@@ -48,11 +58,11 @@ using PuzzleDatabase = classtree::ctree<
 	char, // white queens
 	char, // black queens
 	char, // player turn
-	char, // fake: a8
-	char, // fake: b8
-	char, // fake: c8
-	char, // fake: d8
-	char  // fake: e8
+	char, // content of the 1st square of the square levels
+	char, // content of the 2nd square of the square levels
+	char, // content of the 3rd square of the square levels
+	char, // content of the 4th square of the square levels
+	char  // content of the 5th square of the square levels
 	>;
 
 using PuzzleDatabaseNoWhitePawns = classtree::ctree<
@@ -68,11 +78,87 @@ using PuzzleDatabaseNoWhitePawns = classtree::ctree<
 	char, // white queens
 	char, // black queens
 	char, // player turn
-	char, // fake: a8
-	char, // fake: b8
-	char, // fake: c8
-	char, // fake: d8
-	char  // fake: e8
+	char, // content of the 1st square of the square levels
+	char, // content of the 2nd square of the square levels
+	char, // content of the 3rd square of the square levels
+	char, // content of the 4th square of the square levels
+	char  // content of the 5th square of the square levels
 	>;
 
+/// Level of the number of white pawns in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_WHITE_PAWNS = 0;
+/// Level of the number of black pawns in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_BLACK_PAWNS = 1;
+/// Level of the number of white rooks in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_WHITE_ROOKS = 2;
+/// Level of the number of black rooks in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_BLACK_ROOKS = 3;
+/// Level of the number of white knights in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_WHITE_KNIGHTS = 4;
+/// Level of the number of black knights in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_BLACK_KNIGHTS = 5;
+/// Level of the number of white bishops in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_WHITE_BISHOPS = 6;
+/// Level of the number of black bishops in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_BLACK_BISHOPS = 7;
+/// Level of the number of white queens in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_WHITE_QUEENS = 8;
+/// Level of the number of black queens in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_BLACK_QUEENS = 9;
+/// Level of the player turn in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_TURN = 10;
+/// First level of the content of a square in @ref PuzzleDatabase.
+static constexpr size_t LEVEL_FIRST_SQUARE = 11;
+/// Number of levels of the content of a square in @ref PuzzleDatabase.
+static constexpr size_t NUM_SQUARE_LEVELS = 5;
+/// Number of levels of @ref PuzzleDatabase.
+static constexpr size_t NUM_LEVELS = 16;
+
+/**
+ * @brief The squares whose contents are the last levels of
+ * @ref PuzzleDatabase.
+ *
+ * Level @ref LEVEL_FIRST_SQUARE + i is keyed by the content of the square of
+ * index @ref squares[i] (see @ref parse_square). By default these are the
+ * squares a8, b8, c8, d8 and e8. A database has to be queried with the same
+ * square levels it was loaded with.
+ */
+struct square_levels {
+	/// The square of every level.
+	std::array<uint8_t, NUM_SQUARE_LEVELS> squares = {56, 57, 58, 59, 60};
+
+	[[nodiscard]] bool operator== (const square_levels&) const noexcept =
+		default;
+};
+
+/**
+ * @brief Parses a comma-separated list of @ref NUM_SQUARE_LEVELS different
+ * squares, such as "a8,b8,c8,d8,e8".
+ * @returns The square levels, or nothing if @e s is not valid.
+ */
+[[nodiscard]] std::optional<square_levels>
+parse_square_levels(std::string_view s) noexcept;
+
+/// Returns the square levels as read by @ref parse_square_levels.
+[[nodiscard]] std::string to_string(const square_levels& levels);
+
+/**
+ * @brief Writes the square levels of a database at the beginning of its
+ * memory profile.
+ *
+ * A memory profile describes the shape of the tree, so it can only be used
+ * to load the database with the same square levels.
+ */
+void write_profile_header(std::ostream& os, const square_levels& levels);
+
+/**
+ * @brief Reads the square levels at the beginning of a memory profile.
+ *
+ * Memory profiles without them were written with the default square
+ * levels.
+ * @returns The square levels, or nothing if they are not valid.
+ */
+[[nodiscard]] std::optional<square_levels>
+read_profile_header(std::istream& is);
+
 } // namespace cpb
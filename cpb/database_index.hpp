@@ -0,0 +1,81 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// cpb includes
+#include <cpb/material_ranges.hpp>
+#include <cpb/material_index.hpp>
+#include <cpb/leaf_summaries.hpp>
+#include <cpb/king_index.hpp>
+#include <cpb/pawn_index.hpp>
+#include <cpb/index_layouts.hpp>
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Data about one or more databases, kept next to them, used to
+ * evaluate queries.
+ *
+ * All the databases indexed by the same object have to be loaded with the
+ * same square levels.
+ */
+struct database_index {
+	/// The square levels the databases were loaded with.
+	square_levels levels;
+	/// Summaries of the leaves of the databases. May be incomplete.
+	leaf_summaries summaries;
+	/// Range of the total number of pieces below the nodes of the databases.
+	material_ranges material;
+	/// Leaves of the databases grouped by their material signature.
+	material_index signatures;
+	/// Positions of the databases grouped by their pawn skeleton, if enabled.
+	pawn_index skeletons;
+	/// Positions of the databases grouped by the squares of their kings, if
+	/// enabled.
+	king_index kings;
+	/// Secondary layouts of the databases, if enabled.
+	index_layouts layouts;
+
+	/// Adds the data of @e db, loaded with @ref levels, to this index.
+	void add(const PuzzleDatabase& db)
+	{
+		summaries.add(db);
+		material.add(db);
+		signatures.add(db);
+		skeletons.add(db);
+		kings.add(db);
+		layouts.add(db);
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept
+	{
+		return sizeof(square_levels) + summaries.num_bytes() +
+			   material.num_bytes() + signatures.num_bytes() +
+			   skeletons.num_bytes() + kings.num_bytes() + layouts.num_bytes();
+	}
+};
+
+} // namespace cpb
@@ -29,6 +29,7 @@
 #endif
 
 // cpb includes
+#include <cpb/fen_parser.hpp>
 #include <cpb/profiler.hpp>
 #include <cpb/position.hpp>
 
@@ -283,10 +284,9 @@ parse_fen(const std::string_view s) noexcept
 	return std::make_pair(p, info);
 }
 
-std::string make_fen(const position& p) noexcept
+size_t make_fen(const position& p, char *const buf) noexcept
 {
-	std::string fen;
-	fen.reserve(256);
+	char *out = buf;
 
 	// encode position first
 	for (size_t rank = 8; rank >= 1; --rank) {
@@ -299,61 +299,65 @@ std::string make_fen(const position& p) noexcept
 				++file;
 			}
 			if (empty_squares > 0) {
-				fen.push_back(static_cast<char>(empty_squares + '0'));
+				*out++ = static_cast<char>(empty_squares + '0');
 			}
 			if (file <= 8) {
-				fen += p[file, rank];
+				*out++ = p[file, rank];
 			}
 			++file;
 		}
 
 		if (rank > 1) {
-			fen += "/";
+			*out++ = '/';
 		}
 	}
 
 	// player turn
-	fen += " ";
-	fen += (p.player_turn == TURN_WHITE ? 'w' : 'b');
+	*out++ = ' ';
+	*out++ = (p.player_turn == TURN_WHITE ? 'w' : 'b');
 
 	// castling rights
-	fen += " ";
-	bool some_castling = false;
+	*out++ = ' ';
+	char *const castling = out;
 	if (p.white_king_castle) {
-		fen += "K";
-		some_castling = true;
+		*out++ = 'K';
 	}
 	if (p.white_queen_castle) {
-		fen += "Q";
-		some_castling = true;
+		*out++ = 'Q';
 	}
 	if (p.black_king_castle) {
-		fen += "k";
-		some_castling = true;
+		*out++ = 'k';
 	}
 	if (p.black_queen_castle) {
-		fen += "q";
-		some_castling = true;
+		*out++ = 'q';
 	}
 
-	if (not some_castling) {
-		fen += "-";
+	if (out == castling) {
+		*out++ = '-';
 	}
 
 	// en passant
-	fen += " ";
+	*out++ = ' ';
 	if (p.en_passant[0] != '-') {
-		fen += p.en_passant[0];
-		fen += p.en_passant[1];
+		*out++ = p.en_passant[0];
+		*out++ = p.en_passant[1];
 	}
 	else {
-		fen += "-";
+		*out++ = '-';
 	}
 
 	// moves
-	fen += " 0 0";
+	for (const char c : {' ', '0', ' ', '0'}) {
+		*out++ = c;
+	}
+
+	return static_cast<size_t>(out - buf);
+}
 
-	return fen;
+std::string make_fen(const position& p) noexcept
+{
+	char buf[MAX_FEN_LENGTH];
+	return std::string(buf, make_fen(p, buf));
 }
 
 } // namespace cpb
@@ -26,6 +26,7 @@
 // C++ includes
 #include <string_view>
 #include <optional>
+#include <cstddef>
 #include <string>
 
 // cpb includes
@@ -35,6 +36,20 @@ namespace cpb {
 
 [[nodiscard]] std::optional<std::pair<position, position_info>>
 parse_fen(const std::string_view s) noexcept;
+
+/// Maximum number of characters of a FEN string made by @ref make_fen.
+inline constexpr size_t MAX_FEN_LENGTH = 96;
+
+/**
+ * @brief Writes the FEN string of position @e p into @e buf.
+ *
+ * The string is not null-terminated.
+ * @pre @e buf has room for at least @ref MAX_FEN_LENGTH characters.
+ * @returns The number of characters written.
+ */
+size_t make_fen(const position& p, char *const buf) noexcept;
+
+/// Returns the FEN string of position @e p.
 [[nodiscard]] std::string make_fen(const position& p) noexcept;
 
 } // namespace cpb
@@ -0,0 +1,291 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// cpb includes
+#include <cpb/index_layouts.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+template <size_t level, typename node_t>
+void collect_leaves(
+	const node_t& node, key_path& keys, std::vector<keyed_leaf>& leaves
+)
+{
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		keys[level] = it->first;
+		if constexpr (level + 1 == NUM_LEVELS) {
+			if (it->second.size() == 0) {
+				continue;
+			}
+			leaf_ref ref{.data = it->second.data(), .size = it->second.size()};
+			std::copy_n(
+				keys.begin() + LEVEL_FIRST_SQUARE,
+				NUM_SQUARE_LEVELS,
+				ref.squares.begin()
+			);
+			leaves.push_back({.keys = keys, .ref = ref});
+		}
+		else {
+			collect_leaves<level + 1>(it->second, keys, leaves);
+		}
+	}
+}
+
+/// The key of @e field of a leaf with keys @e keys.
+[[nodiscard]] char
+field_key(const key_path& keys, const layout_field field) noexcept
+{
+	if (field == layout_field::total_pieces) {
+		int total = 0;
+		for (size_t l = 0; l < LEVEL_TURN; ++l) {
+			total += keys[l];
+		}
+		return static_cast<char>(total);
+	}
+	return keys[static_cast<size_t>(field)];
+}
+
+template <size_t N>
+[[nodiscard]] std::array<char, N> layout_keys(
+	const key_path& keys, const std::array<layout_field, N>& fields
+) noexcept
+{
+	std::array<char, N> k;
+	for (size_t l = 0; l < N; ++l) {
+		k[l] = field_key(keys, fields[l]);
+	}
+	return k;
+}
+
+template <size_t N>
+[[nodiscard]] layout_statistics measure_layout(
+	const std::vector<keyed_leaf>& leaves,
+	const std::array<layout_field, N>& fields
+)
+{
+	layout_statistics stats;
+	stats.num_levels = N;
+	stats.num_leaves = leaves.size();
+
+	std::vector<std::array<char, N>> paths;
+	paths.reserve(leaves.size());
+	for (const keyed_leaf& leaf : leaves) {
+		paths.push_back(layout_keys(leaf.keys, fields));
+		for (size_t l = 0; l < N; ++l) {
+			const auto key = static_cast<unsigned char>(paths.back()[l]);
+			stats.positions[l][std::min<size_t>(key, MAX_LAYOUT_KEY - 1)] +=
+				leaf.ref.size;
+		}
+		stats.num_positions += leaf.ref.size;
+	}
+	if (paths.empty()) {
+		return stats;
+	}
+
+	// the nodes at depth d are the different prefixes of length d
+	std::sort(paths.begin(), paths.end());
+	stats.nodes[0] = 1;
+	for (size_t k = 0; k < paths.size(); ++k) {
+		// leaves that differ only in their square keys share their path
+		size_t first_new = 0;
+		if (k > 0) {
+			while (first_new < N and
+				   paths[k - 1][first_new] == paths[k][first_new]) {
+				++first_new;
+			}
+		}
+		for (size_t d = first_new + 1; d <= N; ++d) {
+			++stats.nodes[d];
+		}
+	}
+	return stats;
+}
+
+template <typename layout_t, size_t N>
+void build_layout(
+	const std::vector<keyed_leaf>& leaves,
+	const std::array<layout_field, N>& fields,
+	layout_t& layout
+)
+{
+	for (const keyed_leaf& leaf : leaves) {
+		const std::array<char, N> keys = layout_keys(leaf.keys, fields);
+		[&]<size_t... I>(std::index_sequence<I...>)
+		{
+			layout.add(leaf.ref, keys[I]...);
+		}(std::make_index_sequence<N>{});
+	}
+}
+
+} // namespace
+
+std::vector<keyed_leaf> collect_leaves(const PuzzleDatabase& db)
+{
+	std::vector<keyed_leaf> leaves;
+	key_path keys{};
+	collect_leaves<0>(db, keys, leaves);
+	return leaves;
+}
+
+void index_layouts::enable(const std::vector<index_layout>& layouts) noexcept
+{
+	m_enabled.fill(false);
+	for (const index_layout layout : layouts) {
+		if (layout != index_layout::pieces_first) {
+			m_enabled[static_cast<size_t>(layout)] = true;
+		}
+	}
+}
+
+bool index_layouts::enabled() const noexcept
+{
+	return std::ranges::any_of(m_enabled, [](const bool b) { return b; });
+}
+
+void index_layouts::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	if (not enabled()) {
+		return;
+	}
+
+	const std::vector<keyed_leaf> leaves = collect_leaves(db);
+
+	m_layouts.erase(&db);
+	database_layouts& layouts = m_layouts[&db];
+	layouts.num_positions = db.size();
+
+	const auto built = [&](const index_layout layout, const auto& fields)
+	{
+		const auto i = static_cast<size_t>(layout);
+		layouts.built[i] = true;
+		layouts.statistics[i] = measure_layout(leaves, fields);
+	};
+
+	built(index_layout::pieces_first, PIECES_FIRST_FIELDS);
+	if (m_enabled[static_cast<size_t>(index_layout::queens_first)]) {
+		build_layout(leaves, QUEENS_FIRST_FIELDS, layouts.queens_first);
+		built(index_layout::queens_first, QUEENS_FIRST_FIELDS);
+	}
+	if (m_enabled[static_cast<size_t>(index_layout::material_first)]) {
+		build_layout(leaves, MATERIAL_FIRST_FIELDS, layouts.material_first);
+		built(index_layout::material_first, MATERIAL_FIRST_FIELDS);
+	}
+}
+
+const database_layouts *
+index_layouts::find(const PuzzleDatabase& db) const noexcept
+{
+	const auto it = m_layouts.find(&db);
+	if (it == m_layouts.end() or it->second.num_positions != db.size()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+size_t index_layouts::num_bytes() const noexcept
+{
+	size_t bytes = sizeof(index_layouts);
+	for (const auto& [db, layouts] : m_layouts) {
+		bytes += sizeof(database_layouts);
+		const size_t num_leaves =
+			layouts.statistics[static_cast<size_t>(index_layout::pieces_first)]
+				.num_leaves;
+		for (size_t i = 1; i < NUM_INDEX_LAYOUTS; ++i) {
+			if (layouts.built[i]) {
+				bytes += num_leaves * sizeof(leaf_ref);
+			}
+		}
+	}
+	return bytes;
+}
+
+std::optional<std::vector<index_layout>>
+parse_index_layouts(std::string_view s)
+{
+	std::vector<index_layout> layouts;
+	while (true) {
+		const size_t comma = s.find(',');
+		const std::string_view name = s.substr(0, comma);
+
+		bool found = false;
+		for (size_t i = 0; i < NUM_INDEX_LAYOUTS; ++i) {
+			const auto layout = static_cast<index_layout>(i);
+			if (name == to_string(layout)) {
+				layouts.push_back(layout);
+				found = true;
+			}
+		}
+		if (not found) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Unknown index layout '" << name << "'\n";
+			return {};
+		}
+
+		if (comma == std::string_view::npos) {
+			break;
+		}
+		s.remove_prefix(comma + 1);
+	}
+	return layouts;
+}
+
+std::span<const layout_field> layout_fields(const index_layout layout) noexcept
+{
+	switch (layout) {
+	case index_layout::pieces_first:
+		return PIECES_FIRST_FIELDS;
+	case index_layout::queens_first:
+		return QUEENS_FIRST_FIELDS;
+	case index_layout::material_first:
+		return MATERIAL_FIRST_FIELDS;
+	}
+	return {};
+}
+
+std::string_view to_string(const index_layout layout) noexcept
+{
+	switch (layout) {
+	case index_layout::pieces_first:
+		return "pieces-first";
+	case index_layout::queens_first:
+		return "queens-first";
+	case index_layout::material_first:
+		return "material-first";
+	}
+	return "";
+}
+
+} // namespace cpb
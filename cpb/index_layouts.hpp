@@ -0,0 +1,294 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <span>
+
+// classtree includes
+#include <ctree/ctree.hpp>
+
+// cpb includes
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+
+namespace cpb {
+
+/**
+ * @brief The positions of a leaf of @ref PuzzleDatabase.
+ *
+ * These are the elements of the secondary layouts: all the positions of a
+ * leaf have the same number of pieces of every kind and the same turn, so
+ * the leaves can be classified again by these values in any order.
+ */
+struct leaf_ref {
+	/// First position of the leaf.
+	const position *data = nullptr;
+	/// Number of positions of the leaf.
+	size_t size = 0;
+	/// Keys of the square levels above the leaf.
+	std::array<char, NUM_SQUARE_LEVELS> squares = {};
+
+	[[nodiscard]] bool operator== (const leaf_ref&) const noexcept = default;
+};
+
+/// Keys of the levels of @ref PuzzleDatabase above a leaf.
+using key_path = std::array<char, NUM_LEVELS>;
+
+/// A leaf of @ref PuzzleDatabase with the keys of the levels above it.
+struct keyed_leaf {
+	/// The keys of the levels above the leaf.
+	key_path keys;
+	/// The leaf.
+	leaf_ref ref;
+};
+
+/// The non-empty leaves of @e db, in the order of its range iterators.
+[[nodiscard]] std::vector<keyed_leaf> collect_leaves(const PuzzleDatabase& db);
+
+/// Number of levels of @ref PuzzleDatabase keyed by counts and the turn.
+static constexpr size_t NUM_COUNT_LEVELS = LEVEL_TURN + 1;
+
+/**
+ * @brief The value that keys a level of a layout.
+ *
+ * The first values are the levels of @ref PuzzleDatabase with the same
+ * value.
+ */
+enum class layout_field : uint8_t {
+	white_pawns,
+	black_pawns,
+	white_rooks,
+	black_rooks,
+	white_knights,
+	black_knights,
+	white_bishops,
+	black_bishops,
+	white_queens,
+	black_queens,
+	turn,
+	/// Total number of pieces other than kings.
+	total_pieces
+};
+
+/// The orderings of the levels of the piece counts of a database.
+enum class index_layout : uint8_t {
+	/// Pawns, rooks, knights, bishops, queens and turn: the database itself.
+	pieces_first,
+	/// Queens, rooks, bishops, knights, pawns and turn.
+	queens_first,
+	/// Total number of pieces, then as @ref index_layout::queens_first.
+	material_first
+};
+
+/// Number of values of @ref index_layout.
+static constexpr size_t NUM_INDEX_LAYOUTS = 3;
+
+/// The levels of @ref index_layout::pieces_first.
+static constexpr std::array<layout_field, NUM_COUNT_LEVELS>
+	PIECES_FIRST_FIELDS = {
+		layout_field::white_pawns,
+		layout_field::black_pawns,
+		layout_field::white_rooks,
+		layout_field::black_rooks,
+		layout_field::white_knights,
+		layout_field::black_knights,
+		layout_field::white_bishops,
+		layout_field::black_bishops,
+		layout_field::white_queens,
+		layout_field::black_queens,
+		layout_field::turn
+};
+
+/// The levels of @ref index_layout::queens_first.
+static constexpr std::array<layout_field, NUM_COUNT_LEVELS>
+	QUEENS_FIRST_FIELDS = {
+		layout_field::white_queens,
+		layout_field::black_queens,
+		layout_field::white_rooks,
+		layout_field::black_rooks,
+		layout_field::white_bishops,
+		layout_field::black_bishops,
+		layout_field::white_knights,
+		layout_field::black_knights,
+		layout_field::white_pawns,
+		layout_field::black_pawns,
+		layout_field::turn
+};
+
+/// The levels of @ref index_layout::material_first.
+static constexpr std::array<layout_field, NUM_COUNT_LEVELS + 1>
+	MATERIAL_FIRST_FIELDS = {
+		layout_field::total_pieces,
+		layout_field::white_queens,
+		layout_field::black_queens,
+		layout_field::white_rooks,
+		layout_field::black_rooks,
+		layout_field::white_bishops,
+		layout_field::black_bishops,
+		layout_field::white_knights,
+		layout_field::black_knights,
+		layout_field::white_pawns,
+		layout_field::black_pawns,
+		layout_field::turn
+};
+
+using QueensFirstLayout = classtree::ctree<
+	leaf_ref,
+	void,
+	char, // white queens
+	char, // black queens
+	char, // white rooks
+	char, // black rooks
+	char, // white bishops
+	char, // black bishops
+	char, // white knights
+	char, // black knights
+	char, // white pawns
+	char, // black pawns
+	char  // player turn
+	>;
+
+using MaterialFirstLayout = classtree::ctree<
+	leaf_ref,
+	void,
+	char, // total number of pieces
+	char, // white queens
+	char, // black queens
+	char, // white rooks
+	char, // black rooks
+	char, // white bishops
+	char, // black bishops
+	char, // white knights
+	char, // black knights
+	char, // white pawns
+	char, // black pawns
+	char  // player turn
+	>;
+
+/// Maximum number of levels of a layout.
+static constexpr size_t MAX_LAYOUT_LEVELS = MATERIAL_FIRST_FIELDS.size();
+/// Keys of a layout are counted up to this value, excluded.
+static constexpr size_t MAX_LAYOUT_KEY = 32;
+
+/// Statistics of the levels of a layout, used to plan queries.
+struct layout_statistics {
+	/// Number of levels of the layout.
+	size_t num_levels = 0;
+	/**
+	 * @brief Number of nodes at every depth.
+	 *
+	 * Depth 0 is the root, and depth @ref num_levels are the nodes whose
+	 * children are the leaves of the database.
+	 */
+	std::array<size_t, MAX_LAYOUT_LEVELS + 1> nodes = {};
+	/// Number of positions below every key of every level.
+	std::array<std::array<size_t, MAX_LAYOUT_KEY>, MAX_LAYOUT_LEVELS>
+		positions = {};
+	/// Number of leaves of the database.
+	size_t num_leaves = 0;
+	/// Number of positions of the database.
+	size_t num_positions = 0;
+};
+
+/// The layouts of a single database.
+struct database_layouts {
+	/// Number of positions of the database when the layouts were built.
+	size_t num_positions = 0;
+	/// Is every layout built? @ref index_layout::pieces_first always is.
+	std::array<bool, NUM_INDEX_LAYOUTS> built = {};
+	/// The statistics of every layout.
+	std::array<layout_statistics, NUM_INDEX_LAYOUTS> statistics = {};
+
+	QueensFirstLayout queens_first;
+	MaterialFirstLayout material_first;
+};
+
+/**
+ * @brief Secondary layouts of one or more databases.
+ *
+ * A secondary layout classifies the leaves of a database by the number of
+ * pieces and the turn in an order different from that of
+ * @ref PuzzleDatabase, so that queries on the levels close to the leaves of
+ * the database can be pruned close to the root of the layout instead. The
+ * positions are not copied: the layouts point to the leaves of the database,
+ * so the database must not change while the layouts are used.
+ */
+class index_layouts {
+public:
+
+	/**
+	 * @brief Sets the layouts built for the databases added from now on.
+	 *
+	 * No layout other than the database itself is built by default.
+	 */
+	void enable(const std::vector<index_layout>& layouts) noexcept;
+
+	/// Is any secondary layout built for the databases added?
+	[[nodiscard]] bool enabled() const noexcept;
+
+	/// Builds the enabled layouts of @e db.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief The layouts of @e db.
+	 * @returns Null if there are no layouts of @e db or @e db changed since
+	 * they were built.
+	 */
+	[[nodiscard]] const database_layouts *
+	find(const PuzzleDatabase& db) const noexcept;
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+
+private:
+
+	/// The secondary layouts to build.
+	std::array<bool, NUM_INDEX_LAYOUTS> m_enabled = {};
+	/// The layouts of every database added.
+	std::unordered_map<const PuzzleDatabase *, database_layouts> m_layouts;
+};
+
+/**
+ * @brief Parses a comma-separated list of layouts such as
+ * 'queens-first,material-first'.
+ */
+[[nodiscard]] std::optional<std::vector<index_layout>>
+parse_index_layouts(const std::string_view s);
+
+/// The fields of the levels of a layout, from the root.
+[[nodiscard]] std::span<const layout_field>
+layout_fields(const index_layout layout) noexcept;
+
+/// The name of a layout, as parsed by @ref parse_index_layouts.
+[[nodiscard]] std::string_view to_string(const index_layout layout) noexcept;
+
+} // namespace cpb
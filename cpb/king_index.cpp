@@ -0,0 +1,121 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <bit>
+
+// cpb includes
+#include <cpb/king_index.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Calls @e f with the id of every pair of squares allowed by @e K.
+template <typename function_t>
+void for_each_placement(const king_query& K, function_t&& f)
+{
+	for (uint64_t w = K.white; w != 0; w &= w - 1) {
+		const auto white = static_cast<uint8_t>(std::countr_zero(w));
+		for (uint64_t b = K.black; b != 0; b &= b - 1) {
+			const auto black = static_cast<uint8_t>(std::countr_zero(b));
+			f(king_placement{.white = white, .black = black}.id());
+		}
+	}
+}
+
+} // namespace
+
+size_t database_kings::count(const king_query& K) const noexcept
+{
+	size_t n = 0;
+	for_each_placement(K, [&](const size_t id) { n += sizes[id]; });
+	return n;
+}
+
+std::vector<leaf_run> database_kings::find(const king_query& K) const
+{
+	std::vector<leaf_run> found;
+	for_each_placement(
+		K,
+		[&](const size_t id)
+		{ found.insert(found.end(), runs[id].begin(), runs[id].end()); }
+	);
+	sort_runs(found);
+	return found;
+}
+
+void king_index::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	if (not m_enabled) {
+		return;
+	}
+
+	m_databases.erase(&db);
+	database_kings& kings = m_databases[&db];
+	kings.num_positions = db.size();
+
+	for (const keyed_leaf& leaf : collect_leaves(db)) {
+		const size_t l = kings.leaves.size();
+		material_entry& entry = kings.leaves.emplace_back();
+		entry.leaf = leaf.ref;
+		std::copy_n(leaf.keys.begin(), NUM_COUNT_LEVELS, entry.counts.begin());
+
+		const position *const data = leaf.ref.data;
+		size_t i = 0;
+		while (i < leaf.ref.size) {
+			const king_placement k = make_king_placement(data[i]);
+			const size_t first = i++;
+			while (i < leaf.ref.size and make_king_placement(data[i]) == k) {
+				++i;
+			}
+			if (not k.complete()) {
+				continue;
+			}
+
+			kings.runs[k.id()].push_back(
+				{.data = data + first, .size = i - first, .leaf = l}
+			);
+			kings.sizes[k.id()] += i - first;
+		}
+	}
+}
+
+size_t king_index::num_bytes() const noexcept
+{
+	size_t bytes = sizeof(king_index);
+	for (const auto& [db, kings] : m_databases) {
+		bytes += sizeof(database_kings) +
+				 kings.leaves.capacity() * sizeof(material_entry);
+		for (const std::vector<leaf_run>& runs : kings.runs) {
+			bytes += runs.capacity() * sizeof(leaf_run);
+		}
+	}
+	return bytes;
+}
+
+} // namespace cpb
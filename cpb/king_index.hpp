@@ -0,0 +1,120 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+// cpb includes
+#include <cpb/king_placement.hpp>
+#include <cpb/material_index.hpp>
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/// The positions of a database grouped by the squares of their kings.
+struct database_kings {
+	/// Number of positions of the database when the index was built.
+	size_t num_positions = 0;
+	/// The non-empty leaves, in the order of the range iterators.
+	std::vector<material_entry> leaves;
+	/**
+	 * @brief The runs of the positions of every @ref king_placement, indexed
+	 * by @ref king_placement::id, in the order of the range iterators, with
+	 * their leaves in @ref leaves.
+	 */
+	std::array<std::vector<leaf_run>, NUM_KING_PLACEMENTS> runs;
+	/// The number of positions of every @ref king_placement.
+	std::array<size_t, NUM_KING_PLACEMENTS> sizes = {};
+
+	/// The number of positions that satisfy @e K.
+	[[nodiscard]] size_t count(const king_query& K) const noexcept;
+
+	/**
+	 * @brief The runs of the positions that satisfy @e K, in the order of
+	 * the range iterators.
+	 */
+	[[nodiscard]] std::vector<leaf_run> find(const king_query& K) const;
+};
+
+/**
+ * @brief Table from the 64 x 64 pairs of squares of the kings of the
+ * positions of one or more databases to the runs of positions with them.
+ *
+ * Positions without both kings are not in the table. The table takes about
+ * one run per position, so it is only built when enabled. The databases
+ * must not be modified while this object is in use.
+ */
+class king_index {
+public:
+
+	/**
+	 * @brief Sets whether or not the databases added from now on are indexed.
+	 *
+	 * No database is indexed by default.
+	 */
+	void enable(const bool e) noexcept
+	{
+		m_enabled = e;
+	}
+
+	/// Are the databases added indexed?
+	[[nodiscard]] bool enabled() const noexcept
+	{
+		return m_enabled;
+	}
+
+	/// Adds the positions of @e db, if enabled.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief The positions of @e db grouped by the squares of their kings.
+	 * @returns Null if @e db was not added or changed since it was added.
+	 */
+	[[nodiscard]] const database_kings *
+	find(const PuzzleDatabase& db) const noexcept
+	{
+		const auto it = m_databases.find(&db);
+		if (it == m_databases.end() or
+			it->second.num_positions != db.size()) {
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+
+private:
+
+	/// Are the databases added indexed?
+	bool m_enabled = false;
+	/// The positions of every database added.
+	std::unordered_map<const PuzzleDatabase *, database_kings> m_databases;
+};
+
+} // namespace cpb
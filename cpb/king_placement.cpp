@@ -0,0 +1,163 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <iostream>
+
+// cpb includes
+#include <cpb/king_placement.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// The squares of the file @e f, where 0 is file a.
+[[nodiscard]] constexpr uint64_t file_mask(const size_t f) noexcept
+{
+	return uint64_t{0x0101010101010101} << f;
+}
+
+/// The squares of the rank @e r, where 0 is rank 1.
+[[nodiscard]] constexpr uint64_t rank_mask(const size_t r) noexcept
+{
+	return uint64_t{0xff} << (8 * r);
+}
+
+/// Parses a list of squares, files and ranks such as 'g1,h,8'.
+[[nodiscard]] bool
+parse_region(const std::string_view region, uint64_t& squares) noexcept
+{
+	squares = 0;
+	size_t pos = 0;
+	while (pos <= region.size()) {
+		size_t comma = region.find(',', pos);
+		if (comma == std::string_view::npos) {
+			comma = region.size();
+		}
+
+		const std::string_view name = region.substr(pos, comma - pos);
+		if (name.size() == 1 and name[0] >= 'a' and name[0] <= 'h') {
+			squares |= file_mask(static_cast<size_t>(name[0] - 'a'));
+		}
+		else if (name.size() == 1 and name[0] >= '1' and name[0] <= '8') {
+			squares |= rank_mask(static_cast<size_t>(name[0] - '1'));
+		}
+		else if (const std::optional<size_t> s = parse_square(name); s) {
+			squares |= uint64_t{1} << *s;
+		}
+		else {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid square, file or rank '" << name << "'\n";
+			return false;
+		}
+
+		pos = comma + 1;
+	}
+	return true;
+}
+
+/// Appends the region @e squares, as read by @ref parse_region, to @e s.
+void append_region(uint64_t squares, std::string& s)
+{
+	const uint64_t all = squares;
+	bool first = true;
+	const auto append = [&](const std::string& name)
+	{
+		if (not first) {
+			s += ',';
+		}
+		s += name;
+		first = false;
+	};
+
+	for (size_t r = 0; r < 8; ++r) {
+		if ((all & rank_mask(r)) == rank_mask(r)) {
+			append({static_cast<char>('1' + r)});
+			squares &= ~rank_mask(r);
+		}
+	}
+	for (size_t f = 0; f < 8; ++f) {
+		if ((all & file_mask(f)) == file_mask(f)) {
+			append({static_cast<char>('a' + f)});
+			squares &= ~file_mask(f);
+		}
+	}
+	for (size_t i = 0; i < 64; ++i) {
+		if ((squares >> i) & 1) {
+			append(
+				{static_cast<char>('a' + i % 8), static_cast<char>('1' + i / 8)}
+			);
+		}
+	}
+}
+
+} // namespace
+
+std::optional<king_query> parse_king_query(const std::string_view s) noexcept
+{
+	king_query K;
+
+	size_t pos = 0;
+	size_t i = s.find(';', pos);
+	while (i != std::string_view::npos) {
+		const std::string_view sub = s.substr(pos, i - pos);
+		if (sub.size() < 3 or sub[1] != ':' or
+			(sub[0] != 'w' and sub[0] != 'b')) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Expected 'color:squares' in '" << sub << "'\n";
+			return {};
+		}
+
+		uint64_t& squares = sub[0] == 'w' ? K.white : K.black;
+		if (not parse_region(sub.substr(2), squares)) {
+			return {};
+		}
+
+		pos = i + 1;
+		i = s.find(';', pos);
+	}
+	if (pos != s.size()) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Missing ';' at the end of '" << s << "'\n";
+		return {};
+	}
+	return K;
+}
+
+std::string to_string(const king_query& K)
+{
+	std::string s;
+	if (K.white != ALL_SQUARES) {
+		s += "w:";
+		append_region(K.white, s);
+		s += ';';
+	}
+	if (K.black != ALL_SQUARES) {
+		s += "b:";
+		append_region(K.black, s);
+		s += ';';
+	}
+	return s;
+}
+
+} // namespace cpb
@@ -0,0 +1,130 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// cpb includes
+#include <cpb/attribute_utils.hpp>
+#include <cpb/position.hpp>
+
+namespace cpb {
+
+/// Index of the square of a king that is not on the board.
+static constexpr uint8_t NO_SQUARE = 64;
+/// Number of pairs of squares of the two kings.
+static constexpr size_t NUM_KING_PLACEMENTS = 64 * 64;
+/// All the squares of the board, one bit per square.
+static constexpr uint64_t ALL_SQUARES = ~uint64_t{0};
+
+/// The squares of the two kings of a position.
+struct king_placement {
+	/// Index of the square of the white king (see @ref parse_square).
+	uint8_t white = NO_SQUARE;
+	/// Index of the square of the black king (see @ref parse_square).
+	uint8_t black = NO_SQUARE;
+
+	/// Are both kings on the board?
+	[[nodiscard]] bool complete() const noexcept
+	{
+		return white != NO_SQUARE and black != NO_SQUARE;
+	}
+
+	/// Index of this pair of squares, smaller than @ref NUM_KING_PLACEMENTS.
+	[[nodiscard]] size_t id() const noexcept
+	{
+		return size_t{white} * 64 + size_t{black};
+	}
+
+	[[nodiscard]] bool operator== (const king_placement&) const noexcept =
+		default;
+};
+
+/// The squares of the kings of @e p.
+[[nodiscard]] FORCE_INLINE king_placement
+make_king_placement(const position& p) noexcept
+{
+	king_placement k;
+	for (uint8_t i = 0; i < 64; ++i) {
+		if (p.pieces[i] == WHITE_KING) {
+			k.white = i;
+		}
+		else if (p.pieces[i] == BLACK_KING) {
+			k.black = i;
+		}
+	}
+	return k;
+}
+
+/**
+ * @brief A constraint on the squares of the kings, written as
+ * 'w:g1,h1;b:8;'.
+ *
+ * Every color is followed by the squares its king may stand on, as a list
+ * of squares ('g1'), files ('a') and ranks ('8'). For example, 'w:1;'
+ * selects the positions with the white king on its back rank, and
+ * 'w:g1;b:e,d;' those with the white king on g1 and the black king on the
+ * e or d files. A color not written may stand anywhere. Only positions with
+ * both kings satisfy a constraint.
+ */
+struct king_query {
+	/// The squares the white king may stand on, one bit per square.
+	uint64_t white = ALL_SQUARES;
+	/// The squares the black king may stand on, one bit per square.
+	uint64_t black = ALL_SQUARES;
+
+	/// Does a position with the kings @e k satisfy this constraint?
+	[[nodiscard]] FORCE_INLINE bool
+	matches(const king_placement& k) const noexcept
+	{
+		return k.complete() and ((white >> k.white) & 1) != 0 and
+			   ((black >> k.black) & 1) != 0;
+	}
+
+	[[nodiscard]] bool operator== (const king_query&) const noexcept =
+		default;
+};
+
+/**
+ * @brief Parses a constraint on the squares of the kings such as
+ * 'w:1;b:e,d;'.
+ * @returns The constraint, or nothing if @e s is not valid.
+ */
+[[nodiscard]] std::optional<king_query>
+parse_king_query(const std::string_view s) noexcept;
+
+/**
+ * @brief Writes @e K as parsed by @ref parse_king_query.
+ *
+ * The squares of every color are written as the ranks, then the files,
+ * then the single squares they cover, in increasing order.
+ */
+[[nodiscard]] std::string to_string(const king_query& K);
+
+} // namespace cpb
@@ -0,0 +1,64 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <cstdint>
+
+// cpb includes
+#include <cpb/leaf_summaries.hpp>
+#include <cpb/query_evaluator.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+void leaf_summaries::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	// the square levels do not matter when no square is constrained
+	const querier everything;
+	query_evaluator ev(everything);
+	auto summarize = [this](const position *const data, const size_t n) -> bool
+	{
+		leaf_summary& s = m_summaries[data];
+		s.all.fill(~uint64_t{0});
+
+		for (size_t i = 0; i < n; ++i) {
+			std::array<uint64_t, NUM_SQUARE_CONTENTS> occupancy = {};
+			for (size_t sq = 0; sq < 64; ++sq) {
+				const size_t c = square_content_index(data[i].pieces[sq]);
+				if (c < NUM_SQUARE_CONTENTS) {
+					occupancy[c] |= uint64_t{1} << sq;
+				}
+			}
+			for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+				s.any[c] |= occupancy[c];
+				s.all[c] &= occupancy[c];
+			}
+		}
+		return true;
+	};
+	[[maybe_unused]] const bool _ = for_each_leaf(db, ev, summarize);
+}
+
+} // namespace cpb
@@ -0,0 +1,180 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+// cpb includes
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Occupancy of the squares over all the positions of a leaf.
+ *
+ * Bit @e s of @ref any[c] is set if the square of index @e s contains
+ * @ref SQUARE_CONTENTS[c] in at least one position of the leaf, and bit
+ * @e s of @ref all[c] is set if it does so in all of them.
+ */
+struct leaf_summary {
+	/// Squares with every content in at least one position (bitwise or).
+	std::array<uint64_t, NUM_SQUARE_CONTENTS> any = {};
+	/// Squares with every content in all the positions (bitwise and).
+	std::array<uint64_t, NUM_SQUARE_CONTENTS> all = {};
+
+	/// Can some position of the leaf satisfy @e S?
+	[[nodiscard]] bool may_match(const square_query& S) const noexcept
+	{
+		for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+			if ((S.required[c] & ~any[c]) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Do all the positions of the leaf satisfy @e S?
+	[[nodiscard]] bool all_match(const square_query& S) const noexcept
+	{
+		for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+			if ((S.required[c] & ~all[c]) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Can some position of the leaf satisfy @e P?
+	[[nodiscard]] bool may_match(const pawn_query& P) const noexcept
+	{
+		const auto side = [&](const uint64_t pawns, const size_t c)
+		{
+			// with exactly those pawns, no square can always have a pawn
+			return (pawns & ~any[c]) == 0 and
+				   (P.mode == pawn_match::contains or (all[c] & ~pawns) == 0);
+		};
+		return side(P.pawns.white, WHITE_PAWN_CONTENT) and
+			   side(P.pawns.black, BLACK_PAWN_CONTENT);
+	}
+
+	/// Do all the positions of the leaf satisfy @e P?
+	[[nodiscard]] bool all_match(const pawn_query& P) const noexcept
+	{
+		const auto side = [&](const uint64_t pawns, const size_t c)
+		{
+			return (pawns & ~all[c]) == 0 and
+				   (P.mode == pawn_match::contains or (any[c] & ~pawns) == 0);
+		};
+		return side(P.pawns.white, WHITE_PAWN_CONTENT) and
+			   side(P.pawns.black, BLACK_PAWN_CONTENT);
+	}
+
+	/// Can some position of the leaf satisfy @e K?
+	[[nodiscard]] bool may_match(const king_query& K) const noexcept
+	{
+		return (any[WHITE_KING_CONTENT] & K.white) != 0 and
+			   (any[BLACK_KING_CONTENT] & K.black) != 0;
+	}
+
+	/// Do all the positions of the leaf satisfy @e K?
+	[[nodiscard]] bool all_match(const king_query& K) const noexcept
+	{
+		// a king on the same square in all the positions means that all of
+		// them have that king
+		const auto side = [&](const uint64_t squares, const size_t c)
+		{
+			return all[c] != 0 and (any[c] & ~squares) == 0;
+		};
+		return side(K.white, WHITE_KING_CONTENT) and
+			   side(K.black, BLACK_KING_CONTENT);
+	}
+
+private:
+
+	/// Index of the white pawns in @ref SQUARE_CONTENTS.
+	static constexpr size_t WHITE_PAWN_CONTENT =
+		square_content_index(WHITE_PAWN);
+	/// Index of the black pawns in @ref SQUARE_CONTENTS.
+	static constexpr size_t BLACK_PAWN_CONTENT =
+		square_content_index(BLACK_PAWN);
+	/// Index of the white king in @ref SQUARE_CONTENTS.
+	static constexpr size_t WHITE_KING_CONTENT =
+		square_content_index(WHITE_KING);
+	/// Index of the black king in @ref SQUARE_CONTENTS.
+	static constexpr size_t BLACK_KING_CONTENT =
+		square_content_index(BLACK_KING);
+};
+
+/**
+ * @brief The summaries of the leaves of one or more databases.
+ *
+ * Leaves are identified by the address of their first position, so the
+ * databases must not be modified while this object is in use.
+ */
+class leaf_summaries {
+public:
+
+	/// Adds the summaries of all the non-empty leaves of @e db.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief Returns the summary of the leaf whose first position is
+	 * @e data.
+	 * @returns A null pointer if the leaf is not summarized.
+	 */
+	[[nodiscard]] const leaf_summary *find(const position *const data
+	) const noexcept
+	{
+		const auto it = m_summaries.find(data);
+		return it == m_summaries.end() ? nullptr : &it->second;
+	}
+
+	/// Number of leaves summarized.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_summaries.size();
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept
+	{
+		return sizeof(leaf_summaries) +
+			   m_summaries.size() *
+				   (sizeof(const position *) + sizeof(leaf_summary)) +
+			   m_summaries.bucket_count() * sizeof(void *);
+	}
+
+private:
+
+	/// The summary of every leaf, indexed by its first position.
+	std::unordered_map<const position *, leaf_summary> m_summaries;
+};
+
+} // namespace cpb
@@ -30,6 +30,7 @@
 #if defined DEBUG
 #include <cassert>
 #endif
+#include <algorithm>
 #include <fstream>
 
 // cpb includes
@@ -47,6 +48,76 @@
 namespace cpb {
 namespace lichess {
 
+template <typename database_t>
+void add_position(
+	position&& p,
+	const position_info& info,
+	const square_levels& levels,
+	database_t& db
+)
+{
+	const char n_white_pawns = info.n_white_pawns;
+	const char n_black_pawns = info.n_black_pawns;
+	const char n_white_rooks = info.n_white_rooks;
+	const char n_black_rooks = info.n_black_rooks;
+	const char n_white_knights = info.n_white_knights;
+	const char n_black_knights = info.n_black_knights;
+	const char n_white_bishops = info.n_white_bishops;
+	const char n_black_bishops = info.n_black_bishops;
+	const char n_white_queens = info.n_white_queens;
+	const char n_black_queens = info.n_black_queens;
+	const char turn = p.player_turn;
+
+	const char square_1 = p.pieces[levels.squares[0]];
+	const char square_2 = p.pieces[levels.squares[1]];
+	const char square_3 = p.pieces[levels.squares[2]];
+	const char square_4 = p.pieces[levels.squares[3]];
+	const char square_5 = p.pieces[levels.squares[4]];
+
+	if constexpr (std::is_same_v<database_t, PuzzleDatabaseNoWhitePawns>) {
+		db.add(
+			std::move(p),
+			//n_white_pawns,
+			n_black_pawns,
+			n_white_rooks,
+			n_black_rooks,
+			n_white_knights,
+			n_black_knights,
+			n_white_bishops,
+			n_black_bishops,
+			n_white_queens,
+			n_black_queens,
+			turn,
+			square_1,
+			square_2,
+			square_3,
+			square_4,
+			square_5
+		);
+	}
+	else {
+		db.add(
+			std::move(p),
+			n_white_pawns,
+			n_black_pawns,
+			n_white_rooks,
+			n_black_rooks,
+			n_white_knights,
+			n_black_knights,
+			n_white_bishops,
+			n_black_bishops,
+			n_white_queens,
+			n_black_queens,
+			turn,
+			square_1,
+			square_2,
+			square_3,
+			square_4,
+			square_5
+		);
+	}
+}
+
 #if defined LICHESS_PARALLEL
 
 typedef std::pair<position, position_info> position_plus_info;
@@ -112,72 +183,9 @@ struct queue_wrap {
 };
 
 template <typename database_t>
-void add_position(position&& p, const position_info& info, database_t& db)
-{
-	const char n_white_pawns = info.n_white_pawns;
-	const char n_black_pawns = info.n_black_pawns;
-	const char n_white_rooks = info.n_white_rooks;
-	const char n_black_rooks = info.n_black_rooks;
-	const char n_white_knights = info.n_white_knights;
-	const char n_black_knights = info.n_black_knights;
-	const char n_white_bishops = info.n_white_bishops;
-	const char n_black_bishops = info.n_black_bishops;
-	const char n_white_queens = info.n_white_queens;
-	const char n_black_queens = info.n_black_queens;
-	const char turn = p.player_turn;
-
-	const char a8 = p["a8"];
-	const char b8 = p["b8"];
-	const char c8 = p["c8"];
-	const char d8 = p["d8"];
-	const char e8 = p["e8"];
-
-	if constexpr (std::is_same_v<database_t, PuzzleDatabaseNoWhitePawns>) {
-		db.add(
-			std::move(p),
-			//n_white_pawns,
-			n_black_pawns,
-			n_white_rooks,
-			n_black_rooks,
-			n_white_knights,
-			n_black_knights,
-			n_white_bishops,
-			n_black_bishops,
-			n_white_queens,
-			n_black_queens,
-			turn,
-			a8,
-			b8,
-			c8,
-			d8,
-			e8
-		);
-	}
-	else {
-		db.add(
-			std::move(p),
-			n_white_pawns,
-			n_black_pawns,
-			n_white_rooks,
-			n_black_rooks,
-			n_white_knights,
-			n_black_knights,
-			n_white_bishops,
-			n_black_bishops,
-			n_white_queens,
-			n_black_queens,
-			turn,
-			a8,
-			b8,
-			c8,
-			d8,
-			e8
-		);
-	}
-}
-
-template <typename database_t>
-void worker_add_to_database(queue_wrap& q, database_t db)
+void worker_add_to_database(
+	queue_wrap& q, database_t db, const square_levels& levels
+)
 {
 	queue_command command = q.queue.read<queue_command>();
 	while (command != queue_command::finish) {
@@ -188,10 +196,10 @@ void worker_add_to_database(queue_wrap& q, database_t db)
 #if defined DEBUG
 				assert(db != nullptr);
 #endif
-				add_position(std::move(position), info, *db);
+				add_position(std::move(position), info, levels, *db);
 			}
 			else {
-				add_position(std::move(position), info, db);
+				add_position(std::move(position), info, levels, db);
 			}
 		}
 
@@ -202,8 +210,11 @@ void worker_add_to_database(queue_wrap& q, database_t db)
 	}
 }
 
-std::expected<size_t, load_error>
-load_database(const std::string_view filename, PuzzleDatabase& db)
+std::expected<size_t, load_error> load_database(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels
+)
 {
 	PROFILE_FUNCTION;
 
@@ -224,7 +235,8 @@ load_database(const std::string_view filename, PuzzleDatabase& db)
 		workers.emplace_back(
 			worker_add_to_database<PuzzleDatabase&>,
 			std::ref(qs[i]),
-			std::ref(dbs[i])
+			std::ref(dbs[i]),
+			std::cref(levels)
 		);
 	}
 
@@ -281,8 +293,11 @@ load_database(const std::string_view filename, PuzzleDatabase& db)
 	return total_fen_read;
 }
 
-std::expected<size_t, load_error>
-load_database_initialized(const std::string_view filename, PuzzleDatabase& db)
+std::expected<size_t, load_error> load_database_initialized(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels
+)
 {
 	PROFILE_FUNCTION;
 
@@ -321,7 +336,8 @@ load_database_initialized(const std::string_view filename, PuzzleDatabase& db)
 		workers.emplace_back(
 			worker_add_to_database<PuzzleDatabaseNoWhitePawns *>,
 			std::ref(qs[i]),
-			dbs[i]
+			dbs[i],
+			std::cref(levels)
 		);
 	}
 
@@ -381,8 +397,11 @@ load_database_initialized(const std::string_view filename, PuzzleDatabase& db)
 
 #else
 
-std::expected<size_t, load_error>
-load_database(const std::string_view filename, PuzzleDatabase& db)
+std::expected<size_t, load_error> load_database(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels
+)
 {
 	PROFILE_FUNCTION;
 
@@ -441,11 +460,11 @@ load_database(const std::string_view filename, PuzzleDatabase& db)
 			const char n_black_queens = info.n_black_queens;
 			const char turn = p.player_turn;
 
-			const char a8 = p["a8"];
-			const char b8 = p["b8"];
-			const char c8 = p["c8"];
-			const char d8 = p["d8"];
-			const char e8 = p["e8"];
+			const char square_1 = p.pieces[levels.squares[0]];
+			const char square_2 = p.pieces[levels.squares[1]];
+			const char square_3 = p.pieces[levels.squares[2]];
+			const char square_4 = p.pieces[levels.squares[3]];
+			const char square_5 = p.pieces[levels.squares[4]];
 
 			db.add(
 				std::move(p),
@@ -460,11 +479,11 @@ load_database(const std::string_view filename, PuzzleDatabase& db)
 				n_white_queens,
 				n_black_queens,
 				turn,
-				a8,
-				b8,
-				c8,
-				d8,
-				e8
+				square_1,
+				square_2,
+				square_3,
+				square_4,
+				square_5
 			);
 		}
 
@@ -474,13 +493,88 @@ load_database(const std::string_view filename, PuzzleDatabase& db)
 	return total_fen_read;
 }
 
-std::expected<size_t, load_error>
-load_database_initialized(const std::string_view filename, PuzzleDatabase& db)
+std::expected<size_t, load_error> load_database_initialized(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels
+)
 {
-	return load_database(filename, db);
+	return load_database(filename, db, levels);
 }
 
 #endif
 
+std::expected<size_t, load_error> load_database_chunked(
+	const std::string_view filename,
+	const size_t chunk_size,
+	const chunk_function& on_chunk,
+	const square_levels& levels
+)
+{
+	PROFILE_FUNCTION;
+
+	std::ifstream fin(filename.data());
+	if (not fin.is_open()) {
+		return std::unexpected(load_error::file_error);
+	}
+
+	// read first line
+	std::string line;
+	std::getline(fin, line);
+	size_t bytes_read = line.size() + 1;
+
+	size_t total_fen_read = 0;
+	size_t chunk_fen_read = 0;
+	auto chunk = std::make_unique<PuzzleDatabase>();
+
+	while (std::getline(fin, line)) {
+		bytes_read += line.size() + 1;
+
+		// read until second ','
+		const auto it = std::find(line.begin() + 6, line.end(), ',');
+
+		// read the first move
+		char m1[2];
+		m1[0] = *(it + 1);
+		m1[1] = *(it + 2);
+		char m2[2];
+		m2[0] = *(it + 3);
+		m2[1] = *(it + 4);
+		const char promotion = *(it + 5);
+
+		// use the fen to parse the game
+		const std::string_view fen_view{&line[6]};
+
+		std::optional<std::pair<position, position_info>> data =
+			parse_fen(fen_view);
+
+		if (not data) [[unlikely]] {
+			return std::unexpected(load_error::invalid_position);
+		}
+
+		position& p = data->first;
+		position_info& info = data->second;
+
+		apply_move(m1, m2, promotion, p, info);
+		add_position(std::move(p), info, levels, *chunk);
+
+		++total_fen_read;
+		++chunk_fen_read;
+
+		if (chunk_fen_read == chunk_size) {
+			if (not on_chunk(std::move(chunk), bytes_read)) {
+				return total_fen_read;
+			}
+			chunk = std::make_unique<PuzzleDatabase>();
+			chunk_fen_read = 0;
+		}
+	}
+
+	if (chunk_fen_read > 0) {
+		[[maybe_unused]] const bool _ = on_chunk(std::move(chunk), bytes_read);
+	}
+	return total_fen_read;
+}
+
 } // namespace lichess
 } // namespace cpb
@@ -24,7 +24,9 @@
 #pragma once
 
 // C++
+#include <functional>
 #include <expected>
+#include <memory>
 
 // cpb includes
 #include <cpb/database.hpp>
@@ -37,11 +39,55 @@ enum class load_error {
 	invalid_position
 };
 
-[[nodiscard]] std::expected<size_t, load_error>
-load_database(const std::string_view filename, PuzzleDatabase& db);
+/**
+ * @brief Loads the positions of a lichess database file into @e db.
+ *
+ * The last levels of @e db are keyed by the contents of the squares in
+ * @e levels.
+ * @returns The number of positions read.
+ */
+[[nodiscard]] std::expected<size_t, load_error> load_database(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels = {}
+);
+
+/**
+ * @brief Loads the positions of a lichess database file into @e db, whose
+ * memory was initialized from a memory profile.
+ *
+ * See @ref load_database.
+ */
+[[nodiscard]] std::expected<size_t, load_error> load_database_initialized(
+	const std::string_view filename,
+	PuzzleDatabase& db,
+	const square_levels& levels = {}
+);
 
-[[nodiscard]] std::expected<size_t, load_error>
-load_database_initialized(const std::string_view filename, PuzzleDatabase& db);
+/**
+ * @brief Function called with every chunk of a database.
+ *
+ * It is given the chunk and the number of bytes of the file read so far, and
+ * returns whether or not loading should continue.
+ */
+typedef std::function<bool(std::unique_ptr<PuzzleDatabase>, size_t)>
+	chunk_function;
+
+/**
+ * @brief Loads a database in chunks of @e chunk_size positions.
+ *
+ * Every chunk is a new database that is handed to @e on_chunk as soon as
+ * it is complete, so that it can be used before the whole file is read.
+ * Positions repeated in different chunks are not removed. The last levels of
+ * every chunk are keyed by the contents of the squares in @e levels.
+ * @returns The number of positions read.
+ */
+[[nodiscard]] std::expected<size_t, load_error> load_database_chunked(
+	const std::string_view filename,
+	const size_t chunk_size,
+	const chunk_function& on_chunk,
+	const square_levels& levels = {}
+);
 
 } // namespace lichess
 } // namespace cpb
@@ -0,0 +1,91 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+
+// cpb includes
+#include <cpb/material_index.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+void sort_runs(std::vector<leaf_run>& runs)
+{
+	std::sort(
+		runs.begin(),
+		runs.end(),
+		[](const leaf_run& a, const leaf_run& b) noexcept
+		{
+			return a.leaf != b.leaf ? a.leaf < b.leaf : a.data < b.data;
+		}
+	);
+}
+
+size_t database_materials::count(const endgame_class& E) const
+{
+	size_t n = 0;
+	for (const material_signature s : material_signatures(E)) {
+		const auto it = leaves.find(s);
+		if (it == leaves.end()) {
+			continue;
+		}
+		for (const material_entry& entry : it->second) {
+			n += entry.leaf.size;
+		}
+	}
+	return n;
+}
+
+void material_index::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	m_databases.erase(&db);
+	database_materials& materials = m_databases[&db];
+	materials.num_positions = db.size();
+
+	for (const keyed_leaf& leaf : collect_leaves(db)) {
+		material_entry entry{.leaf = leaf.ref};
+		std::copy_n(leaf.keys.begin(), NUM_COUNT_LEVELS, entry.counts.begin());
+
+		const material_signature s = make_material_signature(leaf.keys);
+		materials.leaves[s].push_back(entry);
+	}
+}
+
+size_t material_index::num_bytes() const noexcept
+{
+	size_t bytes = sizeof(material_index);
+	for (const auto& [db, materials] : m_databases) {
+		bytes += sizeof(database_materials) +
+				 materials.leaves.bucket_count() * sizeof(void *);
+		for (const auto& [s, entries] : materials.leaves) {
+			bytes += sizeof(material_signature) +
+					 entries.capacity() * sizeof(material_entry);
+		}
+	}
+	return bytes;
+}
+
+} // namespace cpb
@@ -0,0 +1,115 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+// cpb includes
+#include <cpb/material_signature.hpp>
+#include <cpb/index_layouts.hpp>
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/// A leaf of @ref PuzzleDatabase in a @ref material_index.
+struct material_entry {
+	/// The leaf.
+	leaf_ref leaf;
+	/// Keys of the levels of the number of pieces and the turn.
+	std::array<char, NUM_COUNT_LEVELS> counts = {};
+};
+
+/// Consecutive positions of a leaf of a side index.
+struct leaf_run {
+	/// First position of the run.
+	const position *data = nullptr;
+	/// Number of positions of the run.
+	size_t size = 0;
+	/// Index of the leaf of the run in the leaves of the side index.
+	size_t leaf = 0;
+};
+
+/**
+ * @brief Sorts @e runs in the order of the range iterators.
+ *
+ * The runs must come from leaves listed in that order, and the runs of a
+ * leaf must be disjoint.
+ */
+void sort_runs(std::vector<leaf_run>& runs);
+
+/// The leaves of a database grouped by their material signature.
+struct database_materials {
+	/// Number of positions of the database when the index was built.
+	size_t num_positions = 0;
+	/// The leaves of every signature, in the order of the range iterators.
+	std::unordered_map<material_signature, std::vector<material_entry>>
+		leaves;
+
+	/// The number of positions of the class @e E.
+	[[nodiscard]] size_t count(const endgame_class& E) const;
+};
+
+/**
+ * @brief Hash from the material signatures of the positions of one or more
+ * databases to their leaves.
+ *
+ * All the positions of a leaf have the same number of pieces, hence the same
+ * signature. The databases must not be modified while this object is in
+ * use.
+ */
+class material_index {
+public:
+
+	/// Adds the leaves of @e db.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief The leaves of @e db grouped by signature.
+	 * @returns Null if @e db was not added or changed since it was added.
+	 */
+	[[nodiscard]] const database_materials *
+	find(const PuzzleDatabase& db) const noexcept
+	{
+		const auto it = m_databases.find(&db);
+		if (it == m_databases.end() or
+			it->second.num_positions != db.size()) {
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+
+private:
+
+	/// The leaves of every database added.
+	std::unordered_map<const PuzzleDatabase *, database_materials> m_databases;
+};
+
+} // namespace cpb
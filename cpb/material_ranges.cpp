@@ -0,0 +1,74 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+
+// cpb includes
+#include <cpb/material_ranges.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/**
+ * @brief Annotates the children of @e node, of level @e level, whose
+ * positions have @e total pieces in the levels above.
+ * @returns The range of @e node.
+ */
+template <size_t level, typename node_t>
+material_range annotate(
+	const node_t& node,
+	const int total,
+	std::unordered_map<const void *, material_range>& ranges
+)
+{
+	material_range range{.min = UINT8_MAX, .max = 0};
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		const int child_total = total + it->first;
+
+		material_range child;
+		if constexpr (level == LEVEL_BLACK_QUEENS) {
+			child.min = child.max = static_cast<uint8_t>(child_total);
+		}
+		else {
+			child = annotate<level + 1>(it->second, child_total, ranges);
+			ranges[&it->second] = child;
+		}
+		range.min = std::min(range.min, child.min);
+		range.max = std::max(range.max, child.max);
+	}
+	return range;
+}
+
+} // namespace
+
+void material_ranges::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	[[maybe_unused]] const material_range _ = annotate<0>(db, 0, m_ranges);
+}
+
+} // namespace cpb
@@ -0,0 +1,97 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// cpb includes
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/// Smallest and largest total number of pieces below a node.
+struct material_range {
+	/// Smallest total number of pieces, kings excluded.
+	uint8_t min = 0;
+	/// Largest total number of pieces, kings excluded.
+	uint8_t max = 0;
+
+	/// Can some position below the node have between @e lb and @e ub pieces?
+	[[nodiscard]] bool intersects(const int lb, const int ub) const noexcept
+	{
+		return min <= ub and lb <= max;
+	}
+};
+
+/**
+ * @brief The range of the total number of pieces below the nodes of one or
+ * more databases.
+ *
+ * Only the nodes above the level of the black queens are annotated: below
+ * it the total number of pieces of the positions is already known. Nodes
+ * are identified by their address, so the databases must not be modified
+ * while this object is in use.
+ */
+class material_ranges {
+public:
+
+	/// Adds the ranges of the nodes of @e db.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief Returns the range of the node at address @e node.
+	 * @returns A null pointer if the node is not annotated.
+	 */
+	[[nodiscard]] const material_range *find(const void *const node
+	) const noexcept
+	{
+		const auto it = m_ranges.find(node);
+		return it == m_ranges.end() ? nullptr : &it->second;
+	}
+
+	/// Number of nodes annotated.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_ranges.size();
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept
+	{
+		return sizeof(material_ranges) +
+			   m_ranges.size() *
+				   (sizeof(const void *) + sizeof(material_range)) +
+			   m_ranges.bucket_count() * sizeof(void *);
+	}
+
+private:
+
+	/// The range of every node, indexed by its address.
+	std::unordered_map<const void *, material_range> m_ranges;
+};
+
+} // namespace cpb
@@ -0,0 +1,168 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <iostream>
+
+// cpb includes
+#include <cpb/material_signature.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Bits of the number of pieces of every level in a signature.
+constexpr std::array<uint32_t, NUM_PIECE_LEVELS> SIGNATURE_BITS = {
+	4, 4, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+/// Largest number of pieces of a kind other than pawns of a class.
+constexpr uint8_t MAX_PIECES = 10;
+
+/// The letter of every level in an endgame class, for White.
+constexpr std::array<char, NUM_PIECE_LEVELS / 2> LETTERS = {
+	'P', 'R', 'N', 'B', 'Q'
+};
+
+/// Parses one side of an endgame class into @e E.
+[[nodiscard]] bool parse_side(
+	std::string_view side,
+	const size_t color,
+	endgame_class& E,
+	bool& more_pawns
+) noexcept
+{
+	if (side.empty() or side[0] != 'K') {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Every side must start with its king: '" << side
+				  << "'\n";
+		return false;
+	}
+	side.remove_prefix(1);
+
+	more_pawns = side.ends_with('*');
+	if (more_pawns) {
+		side.remove_suffix(1);
+	}
+
+	for (const char c : side) {
+		const auto* const letter =
+			std::find(LETTERS.begin(), LETTERS.end(), c);
+		if (letter == LETTERS.end()) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid piece '" << c << "'\n";
+			return false;
+		}
+		const auto level =
+			static_cast<size_t>(letter - LETTERS.begin()) * 2 + color;
+		const uint8_t max = c == 'P' ? MAX_PAWNS : MAX_PIECES;
+		if (E.counts[level] == max) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Too many pieces '" << c << "'\n";
+			return false;
+		}
+		++E.counts[level];
+	}
+	return true;
+}
+
+} // namespace
+
+material_signature
+make_material_signature(const std::span<const char> counts) noexcept
+{
+	material_signature s = 0;
+	for (size_t l = 0; l < NUM_PIECE_LEVELS; ++l) {
+		const uint32_t max = (uint32_t{1} << SIGNATURE_BITS[l]) - 1;
+		const auto c = static_cast<uint32_t>(counts[l]);
+		s = (s << SIGNATURE_BITS[l]) | std::min(c, max);
+	}
+	return s;
+}
+
+std::optional<endgame_class>
+parse_endgame_class(const std::string_view s) noexcept
+{
+	const size_t v = s.find('v');
+	if (v == std::string_view::npos or s.find('v', v + 1) != s.npos) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Expected two sides separated by 'v': '" << s << "'\n";
+		return {};
+	}
+
+	endgame_class E;
+	if (not parse_side(s.substr(0, v), 0, E, E.more_white_pawns) or
+		not parse_side(s.substr(v + 1), 1, E, E.more_black_pawns)) {
+		return {};
+	}
+	return E;
+}
+
+std::string to_string(const endgame_class& E)
+{
+	const auto append_side = [&](std::string& s, const size_t color)
+	{
+		s += 'K';
+		s.append(E.counts[LEVEL_WHITE_QUEENS + color], 'Q');
+		s.append(E.counts[LEVEL_WHITE_ROOKS + color], 'R');
+		s.append(E.counts[LEVEL_WHITE_BISHOPS + color], 'B');
+		s.append(E.counts[LEVEL_WHITE_KNIGHTS + color], 'N');
+		s.append(E.counts[LEVEL_WHITE_PAWNS + color], 'P');
+		if (color == 0 ? E.more_white_pawns : E.more_black_pawns) {
+			s += '*';
+		}
+	};
+
+	std::string s;
+	append_side(s, 0);
+	s += 'v';
+	append_side(s, 1);
+	return s;
+}
+
+std::vector<material_signature> material_signatures(const endgame_class& E)
+{
+	const uint8_t white_max =
+		E.more_white_pawns ? MAX_PAWNS : E.counts[LEVEL_WHITE_PAWNS];
+	const uint8_t black_max =
+		E.more_black_pawns ? MAX_PAWNS : E.counts[LEVEL_BLACK_PAWNS];
+
+	std::array<char, NUM_PIECE_LEVELS> counts;
+	for (size_t l = 0; l < NUM_PIECE_LEVELS; ++l) {
+		counts[l] = static_cast<char>(E.counts[l]);
+	}
+
+	// the pawns are the first levels of the database
+	std::vector<material_signature> signatures;
+	for (uint8_t w = E.counts[LEVEL_WHITE_PAWNS]; w <= white_max; ++w) {
+		for (uint8_t b = E.counts[LEVEL_BLACK_PAWNS]; b <= black_max; ++b) {
+			counts[LEVEL_WHITE_PAWNS] = static_cast<char>(w);
+			counts[LEVEL_BLACK_PAWNS] = static_cast<char>(b);
+			signatures.push_back(make_material_signature(counts));
+		}
+	}
+	return signatures;
+}
+
+} // namespace cpb
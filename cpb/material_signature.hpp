@@ -0,0 +1,104 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <array>
+#include <span>
+
+// cpb includes
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/// Number of levels of @ref PuzzleDatabase with the number of pieces.
+static constexpr size_t NUM_PIECE_LEVELS = LEVEL_BLACK_QUEENS + 1;
+/// Maximum number of pawns of a color.
+static constexpr uint8_t MAX_PAWNS = 8;
+
+/**
+ * @brief The number of pieces of every kind and color, packed in 32 bits.
+ *
+ * The number of pawns of every color takes 4 bits, and the number of rooks,
+ * knights, bishops and queens of every color takes 3 bits, saturated at 7.
+ * Positions with the same number of pieces have the same signature; only
+ * very unusual positions, with 8 or more pieces of a kind other than pawns,
+ * share their signature with others.
+ */
+using material_signature = uint32_t;
+
+/**
+ * @brief The signature of the number of pieces @e counts.
+ * @param counts The keys of the first @ref NUM_PIECE_LEVELS levels of
+ * @ref PuzzleDatabase.
+ */
+[[nodiscard]] material_signature
+make_material_signature(const std::span<const char> counts) noexcept;
+
+/**
+ * @brief A class of endgames, written as 'KRPvKR'.
+ *
+ * Every side is a king followed by its other pieces, written 'Q', 'R', 'B',
+ * 'N' and 'P', White first. A side that ends with '*' has at least the
+ * pawns written, and exactly them otherwise: 'KR*vKR' is a rook against a
+ * rook with any number of white pawns, and 'KRP*vKR' with at least one.
+ */
+struct endgame_class {
+	/// Number of pieces of every level of @ref PuzzleDatabase.
+	std::array<uint8_t, NUM_PIECE_LEVELS> counts = {};
+	/// Is the number of white pawns a lower bound?
+	bool more_white_pawns = false;
+	/// Is the number of black pawns a lower bound?
+	bool more_black_pawns = false;
+
+	[[nodiscard]] bool operator== (const endgame_class&) const noexcept =
+		default;
+};
+
+/**
+ * @brief Parses an endgame class such as 'KRPvKR' or 'KQ*vKQ*'.
+ * @returns The class, or nothing if @e s is not valid.
+ */
+[[nodiscard]] std::optional<endgame_class>
+parse_endgame_class(const std::string_view s) noexcept;
+
+/// Writes @e E as parsed by @ref parse_endgame_class.
+[[nodiscard]] std::string to_string(const endgame_class& E);
+
+/**
+ * @brief The signatures of the positions of the class @e E.
+ *
+ * The signatures are given in the order in which the range iterators of
+ * @ref PuzzleDatabase visit their positions.
+ */
+[[nodiscard]] std::vector<material_signature>
+material_signatures(const endgame_class& E);
+
+} // namespace cpb
@@ -0,0 +1,127 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+
+// cpb includes
+#include <cpb/pawn_index.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+std::vector<leaf_run> database_pawns::find(const pawn_query& P) const
+{
+	if (P.mode == pawn_match::exact) {
+		const auto it = ids.find(P.pawns);
+		return it == ids.end() ? std::vector<leaf_run>{} : runs[it->second];
+	}
+
+	std::vector<leaf_run> found;
+	for (size_t id = 0; id < skeletons.size(); ++id) {
+		if (P.pawns.subset_of(skeletons[id])) {
+			found.insert(found.end(), runs[id].begin(), runs[id].end());
+		}
+	}
+
+	sort_runs(found);
+	return found;
+}
+
+size_t database_pawns::count(const pawn_query& P) const noexcept
+{
+	if (P.mode == pawn_match::exact) {
+		const auto it = ids.find(P.pawns);
+		return it == ids.end() ? 0 : sizes[it->second];
+	}
+
+	size_t n = 0;
+	for (size_t id = 0; id < skeletons.size(); ++id) {
+		if (P.pawns.subset_of(skeletons[id])) {
+			n += sizes[id];
+		}
+	}
+	return n;
+}
+
+void pawn_index::add(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	if (not m_enabled) {
+		return;
+	}
+
+	m_databases.erase(&db);
+	database_pawns& pawns = m_databases[&db];
+	pawns.num_positions = db.size();
+
+	for (const keyed_leaf& leaf : collect_leaves(db)) {
+		const size_t l = pawns.leaves.size();
+		material_entry& entry = pawns.leaves.emplace_back();
+		entry.leaf = leaf.ref;
+		std::copy_n(leaf.keys.begin(), NUM_COUNT_LEVELS, entry.counts.begin());
+
+		const position *const data = leaf.ref.data;
+		size_t i = 0;
+		while (i < leaf.ref.size) {
+			const pawn_skeleton s = make_pawn_skeleton(data[i]);
+			const size_t first = i++;
+			while (i < leaf.ref.size and make_pawn_skeleton(data[i]) == s) {
+				++i;
+			}
+
+			const auto [it, inserted] =
+				pawns.ids.emplace(s, pawns.skeletons.size());
+			if (inserted) {
+				pawns.skeletons.push_back(s);
+				pawns.runs.emplace_back();
+				pawns.sizes.push_back(0);
+			}
+			pawns.runs[it->second].push_back(
+				{.data = data + first, .size = i - first, .leaf = l}
+			);
+			pawns.sizes[it->second] += i - first;
+		}
+	}
+}
+
+size_t pawn_index::num_bytes() const noexcept
+{
+	size_t bytes = sizeof(pawn_index);
+	for (const auto& [db, pawns] : m_databases) {
+		bytes += sizeof(database_pawns) +
+				 pawns.leaves.capacity() * sizeof(material_entry) +
+				 pawns.skeletons.capacity() * sizeof(pawn_skeleton) +
+				 pawns.runs.capacity() * sizeof(std::vector<leaf_run>) +
+				 pawns.sizes.capacity() * sizeof(size_t) +
+				 pawns.ids.size() * (sizeof(pawn_skeleton) + sizeof(size_t)) +
+				 pawns.ids.bucket_count() * sizeof(void *);
+		for (const std::vector<leaf_run>& runs : pawns.runs) {
+			bytes += runs.capacity() * sizeof(leaf_run);
+		}
+	}
+	return bytes;
+}
+
+} // namespace cpb
@@ -0,0 +1,124 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <cstddef>
+#include <vector>
+
+// cpb includes
+#include <cpb/pawn_structure.hpp>
+#include <cpb/material_index.hpp>
+#include <cpb/database.hpp>
+
+namespace cpb {
+
+/// The positions of a database grouped by their pawn skeleton.
+struct database_pawns {
+	/// Number of positions of the database when the index was built.
+	size_t num_positions = 0;
+	/// The non-empty leaves, in the order of the range iterators.
+	std::vector<material_entry> leaves;
+	/// The different skeletons of the positions.
+	std::vector<pawn_skeleton> skeletons;
+	/**
+	 * @brief The runs of the positions of every skeleton, in the order of
+	 * the range iterators, with their leaves in @ref leaves.
+	 */
+	std::vector<std::vector<leaf_run>> runs;
+	/// The number of positions of every skeleton.
+	std::vector<size_t> sizes;
+	/// The index of every skeleton in @ref skeletons.
+	std::unordered_map<pawn_skeleton, size_t, pawn_skeleton_hash> ids;
+
+	/// The number of positions that satisfy @e P.
+	[[nodiscard]] size_t count(const pawn_query& P) const noexcept;
+
+	/**
+	 * @brief The runs of the positions that satisfy @e P, in the order of
+	 * the range iterators.
+	 *
+	 * An exact skeleton is looked up in the hash table. Otherwise, every
+	 * skeleton is tested against @e P with two mask operations.
+	 */
+	[[nodiscard]] std::vector<leaf_run> find(const pawn_query& P) const;
+};
+
+/**
+ * @brief Hash from the pawn skeletons of the positions of one or more
+ * databases to the runs of positions with them.
+ *
+ * The index takes about one run per position, so it is only built when
+ * enabled. The databases must not be modified while this object is in use.
+ */
+class pawn_index {
+public:
+
+	/**
+	 * @brief Sets whether or not the databases added from now on are indexed.
+	 *
+	 * No database is indexed by default.
+	 */
+	void enable(const bool e) noexcept
+	{
+		m_enabled = e;
+	}
+
+	/// Are the databases added indexed?
+	[[nodiscard]] bool enabled() const noexcept
+	{
+		return m_enabled;
+	}
+
+	/// Adds the positions of @e db, if enabled.
+	void add(const PuzzleDatabase& db);
+
+	/**
+	 * @brief The positions of @e db grouped by pawn skeleton.
+	 * @returns Null if @e db was not added or changed since it was added.
+	 */
+	[[nodiscard]] const database_pawns *
+	find(const PuzzleDatabase& db) const noexcept
+	{
+		const auto it = m_databases.find(&db);
+		if (it == m_databases.end() or
+			it->second.num_positions != db.size()) {
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+	/// Number of bytes used by this object, approximately.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+
+private:
+
+	/// Are the databases added indexed?
+	bool m_enabled = false;
+	/// The positions of every database added.
+	std::unordered_map<const PuzzleDatabase *, database_pawns> m_databases;
+};
+
+} // namespace cpb
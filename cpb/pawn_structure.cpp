@@ -0,0 +1,111 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <iostream>
+
+// cpb includes
+#include <cpb/pawn_structure.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Parses the squares of the pawns of one side, such as 'd4,e3'.
+[[nodiscard]] bool
+parse_side(const std::string_view side, uint64_t& pawns) noexcept
+{
+	size_t pos = 0;
+	while (pos < side.size()) {
+		size_t comma = side.find(',', pos);
+		if (comma == std::string_view::npos) {
+			comma = side.size();
+		}
+
+		const std::string_view name = side.substr(pos, comma - pos);
+		const std::optional<size_t> square = parse_square(name);
+		if (not square or name[1] == '1' or name[1] == '8') {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid square for a pawn '" << name << "'\n";
+			return false;
+		}
+		pawns |= uint64_t{1} << *square;
+
+		pos = comma + 1;
+	}
+	return true;
+}
+
+/// Appends the names of the squares of @e pawns to @e s.
+void append_side(const uint64_t pawns, std::string& s)
+{
+	bool first = true;
+	for (size_t i = 0; i < 64; ++i) {
+		if (((pawns >> i) & 1) == 0) {
+			continue;
+		}
+		if (not first) {
+			s += ',';
+		}
+		s += static_cast<char>('a' + i % 8);
+		s += static_cast<char>('1' + i / 8);
+		first = false;
+	}
+}
+
+} // namespace
+
+std::optional<pawn_query> parse_pawn_query(const std::string_view s) noexcept
+{
+	const size_t slash = s.find('/');
+	if (s.size() < 2 or s[1] != ':' or (s[0] != 'e' and s[0] != 'c') or
+		slash == std::string_view::npos or s.find('/', slash + 1) != s.npos) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Expected 'mode:white/black' in '" << s << "'\n";
+		return {};
+	}
+
+	pawn_query P;
+	P.mode = s[0] == 'e' ? pawn_match::exact : pawn_match::contains;
+	if (not parse_side(s.substr(2, slash - 2), P.pawns.white) or
+		not parse_side(s.substr(slash + 1), P.pawns.black)) {
+		return {};
+	}
+	if ((P.pawns.white & P.pawns.black) != 0) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Two pawns on the same square in '" << s << "'\n";
+		return {};
+	}
+	return P;
+}
+
+std::string to_string(const pawn_query& P)
+{
+	std::string s = P.mode == pawn_match::exact ? "e:" : "c:";
+	append_side(P.pawns.white, s);
+	s += '/';
+	append_side(P.pawns.black, s);
+	return s;
+}
+
+} // namespace cpb
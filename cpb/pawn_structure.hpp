@@ -0,0 +1,136 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// cpb includes
+#include <cpb/attribute_utils.hpp>
+#include <cpb/position.hpp>
+
+namespace cpb {
+
+/**
+ * @brief The squares of the pawns of a position.
+ *
+ * Bit @e s of @ref white (@ref black) is set when the square of index @e s
+ * (see @ref parse_square) holds a white (black) pawn.
+ */
+struct pawn_skeleton {
+	/// Squares of the white pawns.
+	uint64_t white = 0;
+	/// Squares of the black pawns.
+	uint64_t black = 0;
+
+	/// Are all the pawns of this skeleton also pawns of @e s?
+	[[nodiscard]] bool subset_of(const pawn_skeleton& s) const noexcept
+	{
+		return (white & ~s.white) == 0 and (black & ~s.black) == 0;
+	}
+
+	[[nodiscard]] bool operator== (const pawn_skeleton&) const noexcept =
+		default;
+};
+
+/// Hash of a @ref pawn_skeleton.
+struct pawn_skeleton_hash {
+	[[nodiscard]] size_t operator() (const pawn_skeleton& s) const noexcept
+	{
+		// the multiplier spreads the pawns of both sides over all the bits
+		return static_cast<size_t>(
+			(s.white * 0x9e3779b97f4a7c15ULL) ^ s.black
+		);
+	}
+};
+
+/// The pawn skeleton of @e p.
+[[nodiscard]] FORCE_INLINE pawn_skeleton
+make_pawn_skeleton(const position& p) noexcept
+{
+	pawn_skeleton s;
+	for (size_t i = 0; i < 64; ++i) {
+		const uint64_t bit = uint64_t{1} << i;
+		s.white |= p.pieces[i] == WHITE_PAWN ? bit : 0;
+		s.black |= p.pieces[i] == BLACK_PAWN ? bit : 0;
+	}
+	return s;
+}
+
+/// How the pawns of a position are compared to those of a query.
+enum class pawn_match : char {
+	/// The position has exactly the pawns of the query.
+	exact,
+	/// The position has at least the pawns of the query.
+	contains,
+};
+
+/**
+ * @brief A constraint on the pawns of a position, written as
+ * 'e:d4,e3/d5,e6'.
+ *
+ * The mode, 'e' (@ref pawn_match::exact) or 'c' (@ref pawn_match::contains),
+ * is followed by the squares of the white pawns and then those of the black
+ * pawns, separated by '/'. For example, 'c:d4/' selects the positions with
+ * a white pawn on d4, and 'e:d4/' those whose only pawn is a white pawn on
+ * d4.
+ */
+struct pawn_query {
+	/// The pawns of the query.
+	pawn_skeleton pawns;
+	/// How they are compared to those of a position.
+	pawn_match mode = pawn_match::exact;
+
+	/// Does a position with the skeleton @e s satisfy this constraint?
+	[[nodiscard]] FORCE_INLINE bool
+	matches(const pawn_skeleton& s) const noexcept
+	{
+		return mode == pawn_match::exact ? s == pawns : pawns.subset_of(s);
+	}
+
+	[[nodiscard]] bool operator== (const pawn_query&) const noexcept =
+		default;
+};
+
+/**
+ * @brief Parses a constraint on the pawns such as 'c:d4/d5'.
+ *
+ * Pawns cannot stand on the first or the last rank.
+ * @returns The constraint, or nothing if @e s is not valid.
+ */
+[[nodiscard]] std::optional<pawn_query>
+parse_pawn_query(const std::string_view s) noexcept;
+
+/**
+ * @brief Writes @e P as parsed by @ref parse_pawn_query.
+ *
+ * The squares of every side are written from a1 to h8.
+ */
+[[nodiscard]] std::string to_string(const pawn_query& P);
+
+} // namespace cpb
@@ -27,6 +27,8 @@
 #if defined DEBUG
 #include <cassert>
 #endif
+#include <string_view>
+#include <optional>
 #include <ostream>
 #include <cstddef>
 #include <string>
@@ -70,6 +72,45 @@ static constexpr char WHITE_KING = 'K';
 /// Black king
 static constexpr char BLACK_KING = 'k';
 
+/// Number of different contents of a square: the twelve pieces and empty.
+static constexpr size_t NUM_SQUARE_CONTENTS = 13;
+/// The contents of a square, in the order given by @ref square_content_index.
+static constexpr char SQUARE_CONTENTS[NUM_SQUARE_CONTENTS + 1] =
+	"PpRrNnBbQqKk.";
+
+/**
+ * @brief Index of the content @e c of a square in @ref SQUARE_CONTENTS.
+ * @returns @ref NUM_SQUARE_CONTENTS if @e c is not a valid content.
+ */
+[[nodiscard]] constexpr size_t square_content_index(const char c) noexcept
+{
+	for (size_t i = 0; i < NUM_SQUARE_CONTENTS; ++i) {
+		if (SQUARE_CONTENTS[i] == c) {
+			return i;
+		}
+	}
+	return NUM_SQUARE_CONTENTS;
+}
+
+/**
+ * @brief Index of the square named @e s, such as "e4".
+ *
+ * Square a1 has index 0, square h1 has index 7 and square h8 has index 63,
+ * which is also the index of the square in @ref position::pieces.
+ * @returns The index, or nothing if @e s is not the name of a square.
+ */
+[[nodiscard]] constexpr std::optional<size_t>
+parse_square(const std::string_view s) noexcept
+{
+	if (s.size() != 2 or s[0] < 'a' or s[0] > 'h' or s[1] < '1' or
+		s[1] > '8') {
+		return {};
+	}
+	const auto file = static_cast<size_t>(s[0] - 'a');
+	const auto rank = static_cast<size_t>(s[1] - '1');
+	return rank * 8 + file;
+}
+
 class position {
 public:
 
@@ -24,13 +24,22 @@
 #pragma once
 
 // C++ includes
+#include <algorithm>
 #include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <bit>
 
 // classtree includes
 #include <ctree/ctree.hpp>
 
 // cpb includes
+#include <cpb/material_signature.hpp>
+#include <cpb/king_placement.hpp>
+#include <cpb/pawn_structure.hpp>
 #include <cpb/attribute_utils.hpp>
+#include <cpb/position.hpp>
 
 namespace cpb {
 
@@ -63,6 +72,59 @@ struct query_data {
 	}
 };
 
+/**
+ * @brief Constraints on the contents of single squares.
+ *
+ * Bit @e s of @ref required[c] is set when the square of index @e s (see
+ * @ref parse_square) must contain @ref SQUARE_CONTENTS[c].
+ */
+struct square_query {
+	/// The squares that must contain every content.
+	std::array<uint64_t, NUM_SQUARE_CONTENTS> required = {};
+
+	/// Requires the square of index @e s to contain @ref SQUARE_CONTENTS[c].
+	FORCE_INLINE void set(const size_t s, const size_t c) noexcept
+	{
+		const uint64_t bit = uint64_t{1} << s;
+		for (uint64_t& r : required) {
+			r &= ~bit;
+		}
+		required[c] |= bit;
+	}
+
+	/// Is there no constraint at all?
+	[[nodiscard]] FORCE_INLINE bool empty() const noexcept
+	{
+		for (const uint64_t r : required) {
+			if (r != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Does @e p satisfy all the constraints?
+	[[nodiscard]] FORCE_INLINE bool matches(const position& p) const noexcept
+	{
+		for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+			uint64_t word = required[c];
+			while (word != 0) {
+				const auto s = static_cast<size_t>(std::countr_zero(word));
+				word &= word - 1;
+				if (p.pieces[s] != SQUARE_CONTENTS[c]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	FORCE_INLINE void reset() noexcept
+	{
+		required = {};
+	}
+};
+
 /* query variables */
 
 struct querier {
@@ -73,6 +135,81 @@ struct querier {
 	query_data queens;
 	std::optional<pair> query_total_pieces;
 	std::optional<unsigned> query_player_turn;
+	square_query squares;
+	std::optional<endgame_class> endgame;
+	std::optional<pawn_query> pawn_structure;
+	std::optional<king_query> kings;
 };
 
+/// Intersects @e bounds, if any, with the interval [@e lb, @e ub].
+inline void restrict_bounds(
+	std::optional<pair>& bounds, const int lb, const int ub
+) noexcept
+{
+	if (not bounds) {
+		bounds = pair{.lb = lb, .ub = ub};
+	}
+	else {
+		bounds->lb = std::max(bounds->lb, lb);
+		bounds->ub = std::min(bounds->ub, ub);
+	}
+}
+
+/**
+ * @brief Intersects the bounds of @e Q on the number of pieces with its
+ * endgame class, if any.
+ *
+ * The bounds may become empty, in which case no position matches @e Q.
+ */
+inline void restrict_to_endgame(querier& Q) noexcept
+{
+	if (not Q.endgame) {
+		return;
+	}
+	const endgame_class& E = *Q.endgame;
+
+	const auto restrict = [](std::optional<pair>& bounds,
+							 const int n,
+							 const bool at_least) noexcept
+	{
+		restrict_bounds(bounds, n, at_least ? MAX_PAWNS : n);
+	};
+
+	restrict(
+		Q.pawns.query_white, E.counts[LEVEL_WHITE_PAWNS], E.more_white_pawns
+	);
+	restrict(
+		Q.pawns.query_black, E.counts[LEVEL_BLACK_PAWNS], E.more_black_pawns
+	);
+	restrict(Q.rooks.query_white, E.counts[LEVEL_WHITE_ROOKS], false);
+	restrict(Q.rooks.query_black, E.counts[LEVEL_BLACK_ROOKS], false);
+	restrict(Q.knights.query_white, E.counts[LEVEL_WHITE_KNIGHTS], false);
+	restrict(Q.knights.query_black, E.counts[LEVEL_BLACK_KNIGHTS], false);
+	restrict(Q.bishops.query_white, E.counts[LEVEL_WHITE_BISHOPS], false);
+	restrict(Q.bishops.query_black, E.counts[LEVEL_BLACK_BISHOPS], false);
+	restrict(Q.queens.query_white, E.counts[LEVEL_WHITE_QUEENS], false);
+	restrict(Q.queens.query_black, E.counts[LEVEL_BLACK_QUEENS], false);
+}
+
+/**
+ * @brief Intersects the bounds of @e Q on the number of pawns with its
+ * constraint on the pawns, if any.
+ *
+ * An exact skeleton fixes the number of pawns of every color, and a
+ * skeleton that must be contained bounds it from below.
+ */
+inline void restrict_to_pawns(querier& Q) noexcept
+{
+	if (not Q.pawn_structure) {
+		return;
+	}
+	const pawn_query& P = *Q.pawn_structure;
+	const bool exact = P.mode == pawn_match::exact;
+
+	const int white = std::popcount(P.pawns.white);
+	const int black = std::popcount(P.pawns.black);
+	restrict_bounds(Q.pawns.query_white, white, exact ? white : MAX_PAWNS);
+	restrict_bounds(Q.pawns.query_black, black, exact ? black : MAX_PAWNS);
+}
+
 } // namespace cpb
@@ -0,0 +1,189 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <cstdint>
+#include <array>
+#include <bit>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/query_batch.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Traversal of a database on behalf of several queries.
+class batch_traversal {
+public:
+
+	batch_traversal(
+		const std::span<const querier> queries,
+		const std::span<query_result> results,
+		const std::stop_token& stop,
+		const database_index *const index
+	)
+		: m_results(results),
+		  m_stop(stop)
+	{
+		m_evaluators.reserve(queries.size());
+		for (const querier& Q : queries) {
+			m_evaluators.emplace_back(Q, index);
+		}
+
+		const size_t num_words = (queries.size() + 63) / 64;
+		for (std::vector<uint64_t>& live : m_live) {
+			live.assign(num_words, 0);
+		}
+		// all queries are alive at the root
+		for (size_t q = 0; q < queries.size(); ++q) {
+			m_live[0][q / 64] |= uint64_t{1} << (q % 64);
+		}
+	}
+
+	/**
+	 * @brief Visits the children of @e node of level @e level.
+	 *
+	 * The queries alive at @e node are those in the bitset of @e level.
+	 * @returns Whether or not the traversal was completed.
+	 */
+	template <size_t level, typename node_t> bool visit(const node_t& node)
+	{
+		const std::vector<uint64_t>& live = m_live[level];
+		std::vector<uint64_t>& child_live = m_live[level + 1];
+
+		for (auto it = node.begin(); it != node.end(); ++it) {
+			if (m_stop.stop_requested()) {
+				return false;
+			}
+
+			bool any = false;
+			for (size_t w = 0; w < live.size(); ++w) {
+				uint64_t word = live[w];
+				uint64_t accepted = 0;
+				while (word != 0) {
+					const int b = std::countr_zero(word);
+					word &= word - 1;
+					const size_t q = w * 64 + static_cast<size_t>(b);
+					if (m_evaluators[q].template accept_child<level>(
+							it->first, it->second
+						)) {
+						accepted |= uint64_t{1} << b;
+					}
+				}
+				child_live[w] = accepted;
+				any = any or accepted != 0;
+			}
+			if (not any) {
+				continue;
+			}
+
+			if constexpr (level + 1 == NUM_LEVELS) {
+				add_leaf(it->second, child_live);
+			}
+			else {
+				if (not visit<level + 1>(it->second)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+
+	/// Adds the matching positions of @e leaf to the results of the queries
+	/// in @e live.
+	template <typename leaf_t>
+	void add_leaf(const leaf_t& leaf, const std::vector<uint64_t>& live)
+	{
+		if (leaf.size() == 0) {
+			return;
+		}
+		for (size_t w = 0; w < live.size(); ++w) {
+			uint64_t word = live[w];
+			while (word != 0) {
+				const int b = std::countr_zero(word);
+				word &= word - 1;
+				const size_t q = w * 64 + static_cast<size_t>(b);
+
+				query_result& result = m_results[q];
+				auto push = [&result](const position *data, const size_t n)
+				{
+					result.push_leaf(data, n);
+					return true;
+				};
+				[[maybe_unused]] const bool _ =
+					m_evaluators[q].visit_leaf(leaf, push);
+			}
+		}
+	}
+
+private:
+
+	/// One evaluator per query.
+	std::vector<query_evaluator> m_evaluators;
+	/// The results of the queries.
+	std::span<query_result> m_results;
+	/// Used to cancel the traversal.
+	const std::stop_token& m_stop;
+	/// Bitsets of the queries alive at the node being visited of every level.
+	std::array<std::vector<uint64_t>, NUM_LEVELS + 1> m_live;
+};
+
+} // namespace
+
+query_batch::query_batch(const std::span<const querier> queries)
+	: m_queries(queries.begin(), queries.end()),
+	  m_results(queries.size())
+{ }
+
+bool query_batch::evaluate(
+	const PuzzleDatabase& db,
+	const std::stop_token& stop,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	for (query_result& r : m_results) {
+		r.clear();
+	}
+	if (m_queries.empty()) {
+		return true;
+	}
+
+	batch_traversal t(m_queries, m_results, stop, index);
+	if (not t.visit<0>(db)) {
+		for (query_result& r : m_results) {
+			r.clear();
+		}
+		return false;
+	}
+	return true;
+}
+
+} // namespace cpb
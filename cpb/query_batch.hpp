@@ -0,0 +1,98 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <stop_token>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Evaluates many queries with a single traversal of a database.
+ *
+ * At every node of the tree, the set of queries that may still match the
+ * positions below it is kept in a bitset. A child is visited if at least one
+ * query in the set accepts it, and only the queries that accept it are
+ * inspected further down. The cost is close to that of a single traversal
+ * when the queries share most of the tree, instead of one traversal per
+ * query.
+ */
+class query_batch {
+public:
+
+	/// Constructor with the queries to evaluate.
+	explicit query_batch(const std::span<const querier> queries);
+
+	/**
+	 * @brief Evaluates all the queries on @e db.
+	 *
+	 * The traversal is abandoned as soon as a stop is requested through
+	 * @e stop, in which case all the results are left empty.
+	 * @param db The database.
+	 * @param stop Used to cancel the traversal.
+	 * @param index If not null, the index of @e db.
+	 * @returns Whether or not the traversal was completed.
+	 */
+	bool evaluate(
+		const PuzzleDatabase& db,
+		const std::stop_token& stop = {},
+		const database_index *const index = nullptr
+	);
+
+	/// Number of queries.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_queries.size();
+	}
+
+	/// The positions that match the @e i-th query.
+	[[nodiscard]] const query_result& result(const size_t i) const noexcept
+	{
+		return m_results[i];
+	}
+
+	/// Number of positions that match the @e i-th query.
+	[[nodiscard]] size_t count(const size_t i) const noexcept
+	{
+		return m_results[i].size();
+	}
+
+private:
+
+	/// The queries.
+	std::vector<querier> m_queries;
+	/// The result of every query.
+	std::vector<query_result> m_results;
+};
+
+} // namespace cpb
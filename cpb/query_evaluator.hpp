@@ -0,0 +1,422 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <array>
+
+// cpb includes
+#include <cpb/attribute_utils.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Evaluates a @ref querier one level of @ref PuzzleDatabase at a time.
+ *
+ * The tree has to be traversed from the root to the leaves: the number of
+ * pieces seen at every level is accumulated in the copy of the querier
+ * so that the constraints on the totals can be checked as early as possible.
+ * When the index is given, the range of the total number of pieces below
+ * every node is checked against the bounds on the total as soon as the node
+ * is reached. The constraints on the squares of the square levels are
+ * checked at those levels. The constraints on the other squares are checked
+ * at the leaves, using the summaries of the leaves, when given, to skip the
+ * positions of the leaves that cannot match, or that match as a whole. So are
+ * the constraints on the pawns and the kings, with the pawn skeletons and the
+ * squares of the kings of the positions.
+ */
+class query_evaluator {
+public:
+
+	/**
+	 * @brief Constructor with a query and, optionally, the index of the
+	 * database.
+	 *
+	 * Without an index, the database is assumed to be loaded with the
+	 * default @ref square_levels.
+	 */
+	explicit query_evaluator(
+		const querier& Q, const database_index *const index = nullptr
+	) noexcept
+		: m_Q(Q),
+		  m_summaries(index != nullptr ? &index->summaries : nullptr),
+		  m_material(index != nullptr ? &index->material : nullptr)
+	{
+		restrict_to_endgame(m_Q);
+		restrict_to_pawns(m_Q);
+
+		const square_levels levels =
+			index != nullptr ? index->levels : square_levels{};
+
+		// the squares of the square levels are not checked at the leaves
+		m_level_contents.fill(0);
+		for (size_t i = 0; i < NUM_SQUARE_LEVELS; ++i) {
+			const uint64_t bit = uint64_t{1} << levels.squares[i];
+			for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+				if ((m_Q.squares.required[c] & bit) != 0) {
+					m_level_contents[i] = SQUARE_CONTENTS[c];
+					m_Q.squares.required[c] &= ~bit;
+				}
+			}
+		}
+		m_has_squares = not m_Q.squares.empty();
+		m_has_pawns = m_Q.pawn_structure.has_value();
+		m_has_kings = m_Q.kings.has_value();
+	}
+
+	/// Is the key @e c of level @e level accepted by the query?
+	template <size_t level>
+	[[nodiscard]] FORCE_INLINE bool accept(const char c) noexcept
+	{
+		if constexpr (level == LEVEL_WHITE_PAWNS) {
+			m_Q.pawns.num_white = c;
+			return white_inspect(m_Q.pawns, m_Q.pawns.num_white);
+		}
+		else if constexpr (level == LEVEL_BLACK_PAWNS) {
+			m_Q.pawns.num_black = c;
+			return black_inspect(m_Q.pawns, m_Q.pawns.total());
+		}
+		else if constexpr (level == LEVEL_WHITE_ROOKS) {
+			m_Q.rooks.num_white = c;
+			return white_inspect(
+				m_Q.rooks, m_Q.pawns.total() + m_Q.rooks.num_white
+			);
+		}
+		else if constexpr (level == LEVEL_BLACK_ROOKS) {
+			m_Q.rooks.num_black = c;
+			return black_inspect(
+				m_Q.rooks, m_Q.pawns.total() + m_Q.rooks.total()
+			);
+		}
+		else if constexpr (level == LEVEL_WHITE_KNIGHTS) {
+			m_Q.knights.num_white = c;
+			return white_inspect(
+				m_Q.knights,
+				m_Q.pawns.total() + m_Q.rooks.total() + m_Q.knights.num_white
+			);
+		}
+		else if constexpr (level == LEVEL_BLACK_KNIGHTS) {
+			m_Q.knights.num_black = c;
+			return black_inspect(
+				m_Q.knights,
+				m_Q.pawns.total() + m_Q.rooks.total() + m_Q.knights.total()
+			);
+		}
+		else if constexpr (level == LEVEL_WHITE_BISHOPS) {
+			m_Q.bishops.num_white = c;
+			return white_inspect(
+				m_Q.bishops,
+				m_Q.pawns.total() + m_Q.rooks.total() + m_Q.knights.total() +
+					m_Q.bishops.num_white
+			);
+		}
+		else if constexpr (level == LEVEL_BLACK_BISHOPS) {
+			m_Q.bishops.num_black = c;
+			return black_inspect(
+				m_Q.bishops,
+				m_Q.pawns.total() + m_Q.rooks.total() + m_Q.knights.total() +
+					m_Q.bishops.total()
+			);
+		}
+		else if constexpr (level == LEVEL_WHITE_QUEENS) {
+			m_Q.queens.num_white = c;
+			return white_inspect(
+				m_Q.queens,
+				m_Q.pawns.total() + m_Q.rooks.total() + m_Q.knights.total() +
+					m_Q.bishops.total() + m_Q.queens.num_white
+			);
+		}
+		else if constexpr (level == LEVEL_BLACK_QUEENS) {
+			m_Q.queens.num_black = c;
+			const int total_so_far = m_Q.pawns.total() + m_Q.rooks.total() +
+									 m_Q.knights.total() +
+									 m_Q.bishops.total() + m_Q.queens.total();
+
+			if (m_Q.query_total_pieces) {
+				const bool cond = in_interval(
+					m_Q.query_total_pieces->lb,
+					total_so_far,
+					m_Q.query_total_pieces->ub
+				);
+				if (not cond) {
+					return false;
+				}
+			}
+			return black_inspect(m_Q.queens, total_so_far);
+		}
+		else if constexpr (level == LEVEL_TURN) {
+			return m_Q.query_player_turn
+					   ? static_cast<unsigned>(c) == *m_Q.query_player_turn
+					   : true;
+		}
+		else {
+			const char content = m_level_contents[level - LEVEL_FIRST_SQUARE];
+			return content == 0 or content == c;
+		}
+	}
+
+	/**
+	 * @brief Is the child @e node of a node of level @e level, with key @e c,
+	 * accepted by the query?
+	 *
+	 * Besides the key, the range of the total number of pieces below
+	 * @e node, when known, is checked against the bounds on the total.
+	 */
+	template <size_t level, typename node_t>
+	[[nodiscard]] FORCE_INLINE bool
+	accept_child(const char c, const node_t& node) noexcept
+	{
+		if (not accept<level>(c)) {
+			return false;
+		}
+		if constexpr (level < LEVEL_BLACK_QUEENS) {
+			if (m_material != nullptr and m_Q.query_total_pieces) {
+				const material_range *const r = m_material->find(&node);
+				return r == nullptr or
+					   r->intersects(
+						   m_Q.query_total_pieces->lb,
+						   m_Q.query_total_pieces->ub
+					   );
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Are the keys of the levels of the piece counts and the turn,
+	 * from the root, accepted by the query?
+	 */
+	[[nodiscard]] bool
+	accept_counts(const std::array<char, LEVEL_TURN + 1>& keys) noexcept
+	{
+		return [&]<size_t... level>(std::index_sequence<level...>)
+		{
+			return (accept<level>(keys[level]) and ...);
+		}(std::make_index_sequence<LEVEL_TURN + 1>{});
+	}
+
+	/// Are the keys of the square levels accepted by the query?
+	[[nodiscard]] bool
+	accept_squares(const std::array<char, NUM_SQUARE_LEVELS>& keys) noexcept
+	{
+		return [&]<size_t... i>(std::index_sequence<i...>)
+		{
+			return (accept<LEVEL_FIRST_SQUARE + i>(keys[i]) and ...);
+		}(std::make_index_sequence<NUM_SQUARE_LEVELS>{});
+	}
+
+	/**
+	 * @brief Calls @e f on the runs of consecutive positions of @e leaf that
+	 * match the constraints on the squares, the pawns and the kings.
+	 *
+	 * Function @e f receives a pointer to the first position of a run and
+	 * the length of the run, and must return whether or not the traversal
+	 * should continue. The whole leaf is a single run if the query does not
+	 * constrain any square, the pawns nor the kings.
+	 * @returns Whether or not the traversal should continue.
+	 */
+	template <typename leaf_t, typename function_t>
+	[[nodiscard]] bool visit_leaf(const leaf_t& leaf, function_t& f)
+	{
+		const size_t n = leaf.size();
+		if (n == 0) {
+			return true;
+		}
+		const position *const data = leaf.data();
+		if (not m_has_squares and not m_has_pawns and not m_has_kings) {
+			return f(data, n);
+		}
+
+		if (m_summaries != nullptr) {
+			const leaf_summary *const s = m_summaries->find(data);
+			if (s != nullptr) {
+				const bool may_match =
+					s->may_match(m_Q.squares) and
+					(not m_has_pawns or s->may_match(*m_Q.pawn_structure)) and
+					(not m_has_kings or s->may_match(*m_Q.kings));
+				if (not may_match) {
+					return true;
+				}
+				const bool all_match =
+					s->all_match(m_Q.squares) and
+					(not m_has_pawns or s->all_match(*m_Q.pawn_structure)) and
+					(not m_has_kings or s->all_match(*m_Q.kings));
+				if (all_match) {
+					return f(data, n);
+				}
+			}
+		}
+
+		size_t i = 0;
+		while (i < n) {
+			while (i < n and not matches(data[i])) {
+				++i;
+			}
+			const size_t first = i;
+			while (i < n and matches(data[i])) {
+				++i;
+			}
+			if (first < i and not f(data + first, i - first)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+
+	/// Does @e p satisfy the constraints checked at the leaves?
+	[[nodiscard]] FORCE_INLINE bool matches(const position& p) const noexcept
+	{
+		return (not m_has_squares or m_Q.squares.matches(p)) and
+			   (not m_has_pawns or
+				m_Q.pawn_structure->matches(make_pawn_skeleton(p))) and
+			   (not m_has_kings or m_Q.kings->matches(make_king_placement(p)));
+	}
+
+	[[nodiscard]] static FORCE_INLINE bool
+	in_interval(const int lb, const int v, const int ub) noexcept
+	{
+		return lb <= v and v <= ub;
+	}
+
+	[[nodiscard]] bool
+	white_inspect(const query_data& q, const int total_so_far) const noexcept
+	{
+		if (q.query_white) {
+			const bool cond =
+				in_interval(q.query_white->lb, q.num_white, q.query_white->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		const int both = q.num_white;
+		if (q.query_both) {
+			const bool cond = in_interval(0, both, q.query_both->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		if (m_Q.query_total_pieces) {
+			const bool cond =
+				in_interval(0, total_so_far, m_Q.query_total_pieces->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] bool
+	black_inspect(const query_data& q, const int total_so_far) const noexcept
+	{
+		if (q.query_black) {
+			const bool cond =
+				in_interval(q.query_black->lb, q.num_black, q.query_black->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		const int both = q.total();
+		if (q.query_both) {
+			const bool cond =
+				in_interval(q.query_both->lb, both, q.query_both->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		if (m_Q.query_total_pieces) {
+			const bool cond =
+				in_interval(0, total_so_far, m_Q.query_total_pieces->ub);
+			if (not cond) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+
+	/// Copy of the query, also used to accumulate the number of pieces.
+	querier m_Q;
+	/// Summaries of the leaves. Can be null.
+	const leaf_summaries *m_summaries;
+	/// Ranges of the total number of pieces below the nodes. Can be null.
+	const material_ranges *m_material;
+	/// Content required at every square level, or 0 if any content is valid.
+	std::array<char, NUM_SQUARE_LEVELS> m_level_contents;
+	/// Does the query constrain any square that is not a square level?
+	bool m_has_squares;
+	/// Does the query constrain the pawns?
+	bool m_has_pawns;
+	/// Does the query constrain the squares of the kings?
+	bool m_has_kings;
+};
+
+/**
+ * @brief Calls @e f on the matching positions of every leaf of @e node
+ * accepted by @e ev.
+ *
+ * The children of every node are visited in the same order as the range
+ * iterators of classtree do. Function @e f is called with every run of
+ * consecutive matching positions as in @ref query_evaluator::visit_leaf,
+ * and must return whether or not the traversal should continue.
+ * @returns Whether or not the traversal was completed.
+ */
+template <size_t level = 0, typename node_t, typename function_t>
+bool for_each_leaf(const node_t& node, query_evaluator& ev, function_t& f)
+{
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		if (not ev.accept_child<level>(it->first, it->second)) {
+			continue;
+		}
+
+		if constexpr (level + 1 == NUM_LEVELS) {
+			if (not ev.visit_leaf(it->second, f)) {
+				return false;
+			}
+		}
+		else {
+			if (not for_each_leaf<level + 1>(it->second, ev, f)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace cpb
@@ -0,0 +1,442 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <condition_variable>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <map>
+
+// cpb includes
+#include <cpb/query_planner.hpp>
+#include <cpb/query_export.hpp>
+#include <cpb/fen_parser.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Approximate number of bytes of an exported position, used to size the
+/// batches of leaves.
+constexpr size_t BYTES_PER_POSITION = 64;
+
+void append_board(std::string& out, const position& p)
+{
+	for (size_t rank = 8; rank >= 1; --rank) {
+		for (size_t file = 1; file <= 8; ++file) {
+			out += p[file, rank];
+		}
+	}
+}
+
+void append_position(
+	std::string& out, const position& p, const export_format format
+)
+{
+	char fen[MAX_FEN_LENGTH];
+	const size_t fen_length = make_fen(p, fen);
+	const char turn = p.player_turn == TURN_WHITE ? 'w' : 'b';
+
+	switch (format) {
+	case export_format::fen:
+		out.append(fen, fen_length);
+		break;
+
+	case export_format::csv:
+		out.append(fen, fen_length);
+		out += ',';
+		append_board(out, p);
+		out += ',';
+		out += turn;
+		break;
+
+	case export_format::ndjson:
+		out += "{\"fen\":\"";
+		out.append(fen, fen_length);
+		out += "\",\"board\":\"";
+		append_board(out, p);
+		out += "\",\"turn\":\"";
+		out += turn;
+		out += "\"}";
+		break;
+	}
+	out += '\n';
+}
+
+/// Exports the positions in the calling thread only.
+[[nodiscard]] std::optional<size_t> export_sequential(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const database_index *const index,
+	const export_format format,
+	const export_sink& sink,
+	const size_t chunk_size,
+	const std::stop_token& stop
+)
+{
+	std::string chunk;
+	chunk.reserve(chunk_size + MAX_FEN_LENGTH * 2);
+
+	size_t count = 0;
+	bool stopped = false;
+	auto export_leaf = [&](const position *const data, const size_t n) -> bool
+	{
+		if (stop.stop_requested()) {
+			stopped = true;
+			return false;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			append_position(chunk, data[i], format);
+			if (chunk.size() >= chunk_size) {
+				if (not sink(chunk)) {
+					stopped = true;
+					return false;
+				}
+				chunk.clear();
+			}
+		}
+		count += n;
+		return true;
+	};
+
+	for (const PuzzleDatabase *db : dbs) {
+		if (not for_each_planned_leaf(*db, Q, index, export_leaf)) {
+			break;
+		}
+	}
+	if (not stopped and not chunk.empty()) {
+		stopped = not sink(chunk);
+	}
+	return stopped ? std::optional<size_t>{} : count;
+}
+
+/// State shared by the threads of a parallel export.
+struct export_state {
+	/// Consecutive matching leaves, formatted into one chunk.
+	struct batch {
+		/// Position of the chunk in the output.
+		size_t index;
+		/// The leaves.
+		std::vector<std::span<const position>> leaves;
+	};
+
+	/// Maximum number of batches found but not yet written.
+	size_t max_in_flight;
+
+	/// Batches waiting to be formatted.
+	std::deque<batch> pending;
+	/// Chunks formatted but not yet written, by index.
+	std::map<size_t, std::string> formatted;
+	/// Number of batches found so far.
+	size_t num_batches = 0;
+	/// Index of the next chunk to be written.
+	size_t next_to_write = 0;
+	/// Number of positions found so far.
+	size_t count = 0;
+	/// Has the traversal finished?
+	bool traversal_finished = false;
+	/// Was the export stopped?
+	bool stopped = false;
+
+	/// Mutex to protect all the members above.
+	std::mutex mutex;
+	/// Used to wake up the threads when the state changes.
+	std::condition_variable cv;
+
+	/// Stops the export and wakes up all the threads.
+	void stop() noexcept
+	{
+		{
+			std::lock_guard lock(mutex);
+			stopped = true;
+		}
+		cv.notify_all();
+	}
+};
+
+/// Finds the matching leaves and splits them into batches.
+void find_batches(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const database_index *const index,
+	const size_t positions_per_batch,
+	const std::stop_token& stop,
+	export_state& state
+)
+{
+	export_state::batch current;
+	size_t current_positions = 0;
+
+	// returns false if the export was stopped
+	const auto push_batch = [&]() -> bool
+	{
+		std::unique_lock lock(state.mutex);
+		state.cv.wait(
+			lock,
+			[&]
+			{
+				const size_t in_flight =
+					state.num_batches - state.next_to_write;
+				return state.stopped or in_flight < state.max_in_flight;
+			}
+		);
+		if (state.stopped) {
+			return false;
+		}
+		current.index = state.num_batches++;
+		state.count += current_positions;
+		state.pending.push_back(std::move(current));
+		lock.unlock();
+		state.cv.notify_all();
+
+		current.leaves.clear();
+		current_positions = 0;
+		return true;
+	};
+
+	auto add_leaf = [&](const position *const data, const size_t n) -> bool
+	{
+		if (stop.stop_requested()) {
+			state.stop();
+			return false;
+		}
+		// runs larger than a batch are split so that every chunk stays
+		// within its size
+		size_t i = 0;
+		while (i < n) {
+			const size_t m =
+				std::min(n - i, positions_per_batch - current_positions);
+			current.leaves.emplace_back(data + i, m);
+			current_positions += m;
+			i += m;
+			if (current_positions == positions_per_batch and
+				not push_batch()) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	for (const PuzzleDatabase *db : dbs) {
+		if (not for_each_planned_leaf(*db, Q, index, add_leaf)) {
+			return;
+		}
+	}
+	if (current_positions > 0 and not push_batch()) {
+		return;
+	}
+
+	{
+		std::lock_guard lock(state.mutex);
+		state.traversal_finished = true;
+	}
+	state.cv.notify_all();
+}
+
+/// Formats the batches found until there are no more.
+void format_batches(
+	const export_format format, const size_t chunk_size, export_state& state
+)
+{
+	while (true) {
+		export_state::batch b;
+		{
+			std::unique_lock lock(state.mutex);
+			state.cv.wait(
+				lock,
+				[&]
+				{
+					return state.stopped or not state.pending.empty() or
+						   state.traversal_finished;
+				}
+			);
+			if (state.stopped or state.pending.empty()) {
+				return;
+			}
+			b = std::move(state.pending.front());
+			state.pending.pop_front();
+		}
+
+		std::string chunk;
+		chunk.reserve(chunk_size + MAX_FEN_LENGTH * 2);
+		for (const std::span<const position> leaf : b.leaves) {
+			for (const position& p : leaf) {
+				append_position(chunk, p, format);
+			}
+		}
+
+		{
+			std::lock_guard lock(state.mutex);
+			state.formatted.emplace(b.index, std::move(chunk));
+		}
+		state.cv.notify_all();
+	}
+}
+
+/// Exports the positions with several threads.
+[[nodiscard]] std::optional<size_t> export_parallel(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const database_index *const index,
+	const export_format format,
+	const export_sink& sink,
+	const size_t num_threads,
+	const size_t chunk_size,
+	const std::stop_token& stop
+)
+{
+	export_state state;
+	state.max_in_flight = 2 * num_threads;
+
+	const size_t positions_per_batch =
+		std::max<size_t>(1, chunk_size / BYTES_PER_POSITION);
+
+	std::vector<std::jthread> threads;
+	threads.reserve(num_threads + 1);
+	threads.emplace_back(
+		[&]
+		{
+			find_batches(dbs, Q, index, positions_per_batch, stop, state);
+		}
+	);
+	for (size_t t = 0; t < num_threads; ++t) {
+		threads.emplace_back(
+			[&]
+			{
+				format_batches(format, chunk_size, state);
+			}
+		);
+	}
+
+	// write the chunks in order
+	while (true) {
+		std::string chunk;
+		{
+			std::unique_lock lock(state.mutex);
+			state.cv.wait(
+				lock,
+				[&]
+				{
+					return state.stopped or
+						   state.formatted.contains(state.next_to_write) or
+						   (state.traversal_finished and
+							state.next_to_write == state.num_batches);
+				}
+			);
+			if (state.stopped) {
+				break;
+			}
+			const auto it = state.formatted.find(state.next_to_write);
+			if (it == state.formatted.end()) {
+				// all the chunks were written
+				break;
+			}
+			chunk = std::move(it->second);
+			state.formatted.erase(it);
+		}
+
+		if (stop.stop_requested() or not sink(chunk)) {
+			state.stop();
+			break;
+		}
+
+		{
+			std::lock_guard lock(state.mutex);
+			++state.next_to_write;
+		}
+		state.cv.notify_all();
+	}
+
+	threads.clear();
+	return state.stopped ? std::optional<size_t>{} : state.count;
+}
+
+} // namespace
+
+std::optional<export_format>
+parse_export_format(const std::string_view name) noexcept
+{
+	if (name == "fen") {
+		return export_format::fen;
+	}
+	if (name == "csv") {
+		return export_format::csv;
+	}
+	if (name == "ndjson") {
+		return export_format::ndjson;
+	}
+	return {};
+}
+
+std::optional<size_t> export_query(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const export_format format,
+	const export_sink& sink,
+	const export_options& options,
+	const std::stop_token& stop
+)
+{
+	PROFILE_FUNCTION;
+
+	if (format == export_format::csv and not sink("fen,board,turn\n")) {
+		return {};
+	}
+
+	const size_t chunk_size = std::max<size_t>(1, options.chunk_size);
+	if (options.num_threads <= 1) {
+		return export_sequential(
+			dbs, Q, options.index, format, sink, chunk_size, stop
+		);
+	}
+	return export_parallel(
+		dbs,
+		Q,
+		options.index,
+		format,
+		sink,
+		options.num_threads,
+		chunk_size,
+		stop
+	);
+}
+
+std::optional<size_t> export_query(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const export_format format,
+	const export_sink& sink,
+	const export_options& options,
+	const std::stop_token& stop
+)
+{
+	const PuzzleDatabase *const dbs[1] = {&db};
+	return export_query(dbs, Q, format, sink, options, stop);
+}
+
+} // namespace cpb
@@ -0,0 +1,118 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <stop_token>
+#include <functional>
+#include <optional>
+#include <cstddef>
+#include <span>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/// Formats in which the results of a query can be exported.
+enum class export_format {
+	/// One FEN string per line.
+	fen,
+	/// A header line, and then one line per position with columns 'fen',
+	/// 'board' (the 64 squares from a8 to h1) and 'turn' ('w' or 'b').
+	csv,
+	/// One JSON object per line with fields 'fen', 'board' and 'turn'.
+	ndjson
+};
+
+/// Returns the format named @e name ("fen", "csv" or "ndjson"), if any.
+[[nodiscard]] std::optional<export_format>
+parse_export_format(const std::string_view name) noexcept;
+
+/**
+ * @brief Function that receives the exported text, one chunk at a time.
+ *
+ * Chunks are given in order. The function returns whether or not the export
+ * should continue.
+ */
+typedef std::function<bool(std::string_view)> export_sink;
+
+/// Options of an export.
+struct export_options {
+	/// Number of threads formatting positions. With more than one, the
+	/// calling thread only hands the chunks to the sink.
+	size_t num_threads = 1;
+	/// Approximate size, in bytes, of every chunk given to the sink.
+	size_t chunk_size = 1 << 20;
+	/// The index of the databases, if any.
+	const database_index *index = nullptr;
+};
+
+/**
+ * @brief Writes all the positions of the databases in @e dbs that match
+ * @e Q into @e sink.
+ *
+ * Positions are exported in the order a range iterator would visit them,
+ * or in that of the layout chosen by @ref plan_query.
+ * The tree is traversed only once: the matching leaves are split into
+ * batches of consecutive leaves as they are found, and every batch is
+ * formatted by one of the threads into its own chunk. At most two chunks per
+ * thread are in memory at any time, so the memory used does not depend on
+ * the number of positions exported.
+ * @param dbs The databases.
+ * @param Q The query.
+ * @param format The format of the positions.
+ * @param sink Receives the exported text.
+ * @param options Number of threads and size of the chunks.
+ * @param stop Used to cancel the export.
+ * @returns The number of positions exported, or nothing if the export was
+ * stopped through @e stop or by @e sink.
+ */
+[[nodiscard]] std::optional<size_t> export_query(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const export_format format,
+	const export_sink& sink,
+	const export_options& options = {},
+	const std::stop_token& stop = {}
+);
+
+/**
+ * @brief Writes all the positions of @e db that match @e Q into @e sink.
+ *
+ * See the overload for several databases.
+ */
+[[nodiscard]] std::optional<size_t> export_query(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const export_format format,
+	const export_sink& sink,
+	const export_options& options = {},
+	const std::stop_token& stop = {}
+);
+
+} // namespace cpb
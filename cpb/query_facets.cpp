@@ -0,0 +1,330 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <array>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/index_layouts.hpp>
+#include <cpb/query_facets.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Number of levels that can be used as a facet.
+constexpr size_t NUM_FACET_LEVELS = LEVEL_TURN + 1;
+
+/// Counts of the matching positions, accumulated by one thread.
+struct facet_accumulator {
+	/// Number of positions of every key of every level.
+	std::array<std::array<size_t, 256>, NUM_FACET_LEVELS> levels{};
+	/// Number of positions of every material, packed as in @ref pack.
+	std::unordered_map<uint64_t, size_t> material;
+	/// Should the material be counted?
+	bool count_material = false;
+
+	/// Packs the number of pieces of every level in 4 bits each.
+	[[nodiscard]] static uint64_t pack(const key_path& path) noexcept
+	{
+		uint64_t key = 0;
+		for (size_t l = 0; l < NUM_PIECE_LEVELS; ++l) {
+			const auto c = static_cast<uint64_t>(path[l]) & 0xf;
+			key |= c << (4 * l);
+		}
+		return key;
+	}
+
+	/// Adds @e n positions with the keys in @e path.
+	void add(const key_path& path, const size_t n)
+	{
+		for (size_t l = 0; l < NUM_FACET_LEVELS; ++l) {
+			levels[l][static_cast<unsigned char>(path[l])] += n;
+		}
+		if (count_material) {
+			material[pack(path)] += n;
+		}
+	}
+
+	/// Adds the counts of @e a to this one.
+	void merge(const facet_accumulator& a)
+	{
+		for (size_t l = 0; l < NUM_FACET_LEVELS; ++l) {
+			for (size_t k = 0; k < 256; ++k) {
+				levels[l][k] += a.levels[l][k];
+			}
+		}
+		for (const auto& [key, n] : a.material) {
+			material[key] += n;
+		}
+	}
+};
+
+/// Returns the material packed in @e key, as in 'KRPPvKR'.
+[[nodiscard]] std::string material_string(const uint64_t key)
+{
+	const auto count = [key](const size_t level) -> size_t
+	{
+		return (key >> (4 * level)) & 0xf;
+	};
+	const auto append_side = [&](std::string& s, const size_t color)
+	{
+		s += 'K';
+		s.append(count(LEVEL_WHITE_QUEENS + color), 'Q');
+		s.append(count(LEVEL_WHITE_ROOKS + color), 'R');
+		s.append(count(LEVEL_WHITE_BISHOPS + color), 'B');
+		s.append(count(LEVEL_WHITE_KNIGHTS + color), 'N');
+		s.append(count(LEVEL_WHITE_PAWNS + color), 'P');
+	};
+
+	std::string s;
+	append_side(s, 0);
+	s += 'v';
+	append_side(s, 1);
+	return s;
+}
+
+/// Accumulates the matching positions below @e node of level @e level.
+template <size_t level, typename node_t>
+bool accumulate(
+	const node_t& node,
+	query_evaluator& ev,
+	key_path& path,
+	facet_accumulator& acc,
+	const std::stop_token& stop
+)
+{
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		if (stop.stop_requested()) {
+			return false;
+		}
+		if (not ev.accept_child<level>(it->first, it->second)) {
+			continue;
+		}
+		path[level] = it->first;
+
+		if constexpr (level + 1 == NUM_LEVELS) {
+			size_t n = 0;
+			auto count = [&n](const position *, const size_t run)
+			{
+				n += run;
+				return true;
+			};
+			[[maybe_unused]] const bool _ = ev.visit_leaf(it->second, count);
+			if (n > 0) {
+				acc.add(path, n);
+			}
+		}
+		else {
+			if (not accumulate<level + 1>(it->second, ev, path, acc, stop)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// Makes the facet of @e field out of the counts in @e acc.
+[[nodiscard]] facet
+make_facet(const facet_field field, const facet_accumulator& acc)
+{
+	facet f{.field = field, .buckets = {}};
+
+	if (field == facet_field::material) {
+		f.buckets.reserve(acc.material.size());
+		for (const auto& [key, n] : acc.material) {
+			f.buckets.push_back({.key = material_string(key), .count = n});
+		}
+		std::sort(
+			f.buckets.begin(),
+			f.buckets.end(),
+			[](const facet::bucket& a, const facet::bucket& b)
+			{
+				return a.count > b.count or
+					   (a.count == b.count and a.key < b.key);
+			}
+		);
+		return f;
+	}
+
+	const auto& counts = acc.levels[static_cast<size_t>(field)];
+	for (size_t k = 0; k < counts.size(); ++k) {
+		if (counts[k] == 0) {
+			continue;
+		}
+		const auto c = static_cast<char>(k);
+		std::string key;
+		if (field == facet_field::turn) {
+			key = (static_cast<unsigned>(c) == TURN_WHITE ? "w" : "b");
+		}
+		else {
+			key = std::to_string(static_cast<int>(c));
+		}
+		f.buckets.push_back({.key = std::move(key), .count = counts[k]});
+	}
+	return f;
+}
+
+} // namespace
+
+std::optional<facet_field>
+parse_facet_field(const std::string_view name) noexcept
+{
+	for (uint8_t i = 0; i <= static_cast<uint8_t>(facet_field::material); ++i) {
+		const auto field = static_cast<facet_field>(i);
+		if (name_of(field) == name) {
+			return field;
+		}
+	}
+	return {};
+}
+
+std::string_view name_of(const facet_field field) noexcept
+{
+	switch (field) {
+	case facet_field::white_pawns:
+		return "white_pawns";
+	case facet_field::black_pawns:
+		return "black_pawns";
+	case facet_field::white_rooks:
+		return "white_rooks";
+	case facet_field::black_rooks:
+		return "black_rooks";
+	case facet_field::white_knights:
+		return "white_knights";
+	case facet_field::black_knights:
+		return "black_knights";
+	case facet_field::white_bishops:
+		return "white_bishops";
+	case facet_field::black_bishops:
+		return "black_bishops";
+	case facet_field::white_queens:
+		return "white_queens";
+	case facet_field::black_queens:
+		return "black_queens";
+	case facet_field::turn:
+		return "turn";
+	case facet_field::material:
+		return "material";
+	}
+	return "";
+}
+
+std::optional<std::vector<facet>> compute_facets(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const std::span<const facet_field> fields,
+	const size_t num_threads,
+	const std::stop_token& stop,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	// the subtrees of the children of the roots are shared among the threads
+	typedef std::remove_cvref_t<decltype(dbs[0]->begin()->second)> child_t;
+	struct subtree {
+		char key;
+		const child_t *node;
+	};
+	std::vector<subtree> subtrees;
+	for (const PuzzleDatabase *db : dbs) {
+		for (auto it = db->begin(); it != db->end(); ++it) {
+			subtrees.push_back({.key = it->first, .node = &it->second});
+		}
+	}
+
+	const bool count_material =
+		std::find(fields.begin(), fields.end(), facet_field::material) !=
+		fields.end();
+
+	const size_t n =
+		std::max<size_t>(1, std::min(num_threads, subtrees.size()));
+	std::vector<facet_accumulator> accumulators(n);
+	std::atomic<size_t> next = 0;
+	std::atomic<bool> stopped = false;
+
+	const auto work = [&](facet_accumulator& acc)
+	{
+		acc.count_material = count_material;
+		key_path path{};
+
+		size_t i = next.fetch_add(1, std::memory_order_relaxed);
+		while (i < subtrees.size()) {
+			query_evaluator ev(Q, index);
+			if (ev.accept_child<0>(subtrees[i].key, *subtrees[i].node)) {
+				path[0] = subtrees[i].key;
+				if (not accumulate<1>(*subtrees[i].node, ev, path, acc, stop)) {
+					stopped.store(true, std::memory_order_relaxed);
+					return;
+				}
+			}
+			i = next.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	{
+		std::vector<std::jthread> threads;
+		threads.reserve(n);
+		for (size_t t = 1; t < n; ++t) {
+			threads.emplace_back(work, std::ref(accumulators[t]));
+		}
+		work(accumulators[0]);
+	}
+	if (stopped.load(std::memory_order_relaxed) or stop.stop_requested()) {
+		return {};
+	}
+
+	for (size_t t = 1; t < accumulators.size(); ++t) {
+		accumulators[0].merge(accumulators[t]);
+	}
+
+	std::vector<facet> facets;
+	facets.reserve(fields.size());
+	for (const facet_field field : fields) {
+		facets.push_back(make_facet(field, accumulators[0]));
+	}
+	return facets;
+}
+
+std::optional<std::vector<facet>> compute_facets(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::span<const facet_field> fields,
+	const size_t num_threads,
+	const std::stop_token& stop,
+	const database_index *const index
+)
+{
+	const PuzzleDatabase *const dbs[1] = {&db};
+	return compute_facets(dbs, Q, fields, num_threads, stop, index);
+}
+
+} // namespace cpb
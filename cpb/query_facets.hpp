@@ -0,0 +1,124 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <stop_token>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <span>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief What the matching positions of a query can be grouped by.
+ *
+ * The first fields are the levels of @ref PuzzleDatabase, in the same order.
+ */
+enum class facet_field : uint8_t {
+	white_pawns = LEVEL_WHITE_PAWNS,
+	black_pawns = LEVEL_BLACK_PAWNS,
+	white_rooks = LEVEL_WHITE_ROOKS,
+	black_rooks = LEVEL_BLACK_ROOKS,
+	white_knights = LEVEL_WHITE_KNIGHTS,
+	black_knights = LEVEL_BLACK_KNIGHTS,
+	white_bishops = LEVEL_WHITE_BISHOPS,
+	black_bishops = LEVEL_BLACK_BISHOPS,
+	white_queens = LEVEL_WHITE_QUEENS,
+	black_queens = LEVEL_BLACK_QUEENS,
+	turn = LEVEL_TURN,
+	/// The pieces of both players, as in 'KRPPvKR'.
+	material,
+};
+
+/// Returns the field named @e name (as in @ref name_of), if any.
+[[nodiscard]] std::optional<facet_field>
+parse_facet_field(const std::string_view name) noexcept;
+
+/// Returns the name of @e field, such as "white_pawns" or "material".
+[[nodiscard]] std::string_view name_of(const facet_field field) noexcept;
+
+/// Number of matching positions of every value of a field.
+struct facet {
+	/// A value of the field and its number of matching positions.
+	struct bucket {
+		/// The value, such as "2" for a number of pieces, "w" for the player
+		/// to move, or "KRPvKR" for the material.
+		std::string key;
+		/// Number of matching positions with this value.
+		size_t count;
+	};
+
+	/// The field.
+	facet_field field;
+	/// Values with at least one matching position. Sorted by value, except
+	/// for the material, which is sorted by decreasing count.
+	std::vector<bucket> buckets;
+};
+
+/**
+ * @brief Groups the positions of the databases in @e dbs that match @e Q by
+ * every field in @e fields.
+ *
+ * All the facets are computed in a single traversal of the matching
+ * subtrees. The subtrees below the root are shared among @e num_threads
+ * threads, each of which accumulates its own counts; the counts are added
+ * up at the end. If not null, @e index is the index of the databases.
+ * @returns One facet per field, in the same order as @e fields, or nothing
+ * if a stop was requested through @e stop.
+ */
+[[nodiscard]] std::optional<std::vector<facet>> compute_facets(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const std::span<const facet_field> fields,
+	const size_t num_threads = 1,
+	const std::stop_token& stop = {},
+	const database_index *const index = nullptr
+);
+
+/**
+ * @brief Groups the positions of @e db that match @e Q by every field in
+ * @e fields.
+ *
+ * See the overload for several databases.
+ */
+[[nodiscard]] std::optional<std::vector<facet>> compute_facets(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::span<const facet_field> fields,
+	const size_t num_threads = 1,
+	const std::stop_token& stop = {},
+	const database_index *const index = nullptr
+);
+
+} // namespace cpb
@@ -0,0 +1,360 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+#include <iostream>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <tuple>
+
+// cpb includes
+#include <cpb/material_signature.hpp>
+#include <cpb/pawn_structure.hpp>
+#include <cpb/king_placement.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/position.hpp>
+
+namespace cpb {
+
+static constexpr auto end = std::string::npos;
+
+[[nodiscard]] static std::optional<int>
+to_int(const std::string_view s) noexcept
+{
+	int v;
+	const auto [ptr, ec] = std::from_chars(s.begin(), s.end(), v);
+	return ec == std::errc{} ? v : std::optional<int>{};
+}
+
+[[nodiscard]] static std::tuple<char, int, int>
+process_subfield(const std::string_view sub)
+{
+	const size_t colon = sub.find(':');
+	if (colon == end) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Could not find ':' in '" << sub << "'\n";
+		return {};
+	}
+	const size_t comma = sub.find(',', colon);
+	if (comma == end) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Could not find ';' in '" << sub << "'\n";
+		return {};
+	}
+
+	const std::string_view color{&sub[0], &sub[colon]};
+	const std::string_view lb{&sub[colon + 1], &sub[comma]};
+	const std::string_view ub{&sub[comma + 1], sub.end()};
+
+	const std::optional<int> lb_int = to_int(lb);
+	const std::optional<int> ub_int = to_int(ub);
+	if (not lb_int or not ub_int) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Missing valid numeric value in '" << sub << "'\n";
+		std::cerr << "    lb_int: ";
+		if (lb_int) {
+			std::cerr << *lb_int << '\n';
+		}
+		else {
+			std::cerr << "{}" << '\n';
+		}
+		std::cerr << "    ub_int: ";
+		if (ub_int) {
+			std::cerr << *ub_int << '\n';
+		}
+		else {
+			std::cerr << "{}" << '\n';
+		}
+		return {};
+	}
+
+	return {color[0], *lb_int, *ub_int};
+}
+
+[[nodiscard]] static bool
+process_square_field(const std::string_view content, square_query& S)
+{
+	size_t pos = 0;
+	size_t i = content.find(';', pos);
+
+	while (i != end) {
+		const std::string_view sub{&content[pos], &content[i]};
+		const size_t colon = sub.find(':');
+		if (colon == end or colon + 2 != sub.size()) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid square constraint '" << sub << "'\n";
+			return false;
+		}
+
+		const std::optional<size_t> square = parse_square(sub.substr(0, colon));
+		const size_t c = square_content_index(sub[colon + 1]);
+		if (not square or c == NUM_SQUARE_CONTENTS) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid square constraint '" << sub << "'\n";
+			return false;
+		}
+		S.set(*square, c);
+
+		pos = i + 1;
+		i = content.find(';', pos);
+	}
+	if (pos != content.size()) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Missing ';' after '" << content.substr(pos) << "'\n";
+		return false;
+	}
+	return true;
+}
+
+[[nodiscard]] static bool
+process_piece_field(const std::string_view content, query_data& q)
+{
+	size_t pos = 0;
+	size_t i = content.find(';', pos);
+
+	while (i != end) {
+		const std::string_view sub{&content[pos], &content[i]};
+		const auto [color, lb_int, ub_int] = process_subfield(sub);
+		if (color == '\0') {
+			return false;
+		}
+		if (color == 'w') {
+			q.query_white = {.lb = lb_int, .ub = ub_int};
+		}
+		else if (color == 'b') {
+			q.query_black = {.lb = lb_int, .ub = ub_int};
+		}
+		else if (color == 't') {
+			q.query_both = {.lb = lb_int, .ub = ub_int};
+		}
+		else {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid color '" << color << "' in '" << sub
+					  << "'\n";
+			return false;
+		}
+
+		pos = i + 1;
+		i = content.find(';', pos);
+	}
+	if (pos != content.size()) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Missing ';' after '" << content.substr(pos) << "'\n";
+		return false;
+	}
+	return true;
+}
+
+bool parse_query(const std::string_view s, querier& Q) noexcept
+{
+	Q.pawns.reset();
+	Q.rooks.reset();
+	Q.knights.reset();
+	Q.bishops.reset();
+	Q.queens.reset();
+	Q.query_total_pieces = {};
+	Q.query_player_turn = {};
+	Q.squares.reset();
+	Q.endgame = {};
+	Q.pawn_structure = {};
+	Q.kings = {};
+
+	const size_t n_fields =
+		static_cast<size_t>(std::count(s.begin(), s.end(), '['));
+
+	size_t p = 0;
+	for (size_t i = 0; i < n_fields; ++i) {
+		const auto first = s.find('[', p);
+		const auto second = s.find(']', p);
+		if (first == end or second == end) {
+			std::cerr << "Delimiter '[' or ']' could not be found.\n";
+			std::cerr << "    Found [? " << (first == end ? "no\n" : "yes\n");
+			std::cerr << "    Found ]? " << (second == end ? "no\n" : "yes\n");
+			return false;
+		}
+
+		const std::string_view name{&s[p], &s[first]};
+		const std::string_view content{&s[first + 1], &s[second]};
+
+		if (name == "p") {
+			if (not process_piece_field(content, Q.pawns)) {
+				return false;
+			}
+		}
+		else if (name == "r") {
+			if (not process_piece_field(content, Q.rooks)) {
+				return false;
+			}
+		}
+		else if (name == "k") {
+			if (not process_piece_field(content, Q.knights)) {
+				return false;
+			}
+		}
+		else if (name == "b") {
+			if (not process_piece_field(content, Q.bishops)) {
+				return false;
+			}
+		}
+		else if (name == "q") {
+			if (not process_piece_field(content, Q.queens)) {
+				return false;
+			}
+		}
+		else if (name == "T") {
+			const auto [id, lb_int, ub_int] = process_subfield(content);
+			if (id != 'T') {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Invalid identifier for total pieces: '" << id
+						  << "'\n";
+				return false;
+			}
+			Q.query_total_pieces = {lb_int, ub_int};
+		}
+		else if (name == "M") {
+			if (content != "w" and content != "b") {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Invalid turn indicator '" << content << "'\n";
+				return false;
+			}
+			Q.query_player_turn =
+				content == "w" ? TURN_WHITE : TURN_BLACK;
+		}
+		else if (name == "S") {
+			if (not process_square_field(content, Q.squares)) {
+				return false;
+			}
+		}
+		else if (name == "E") {
+			Q.endgame = parse_endgame_class(content);
+			if (not Q.endgame) {
+				return false;
+			}
+		}
+		else if (name == "P") {
+			Q.pawn_structure = parse_pawn_query(content);
+			if (not Q.pawn_structure) {
+				return false;
+			}
+		}
+		else if (name == "K") {
+			Q.kings = parse_king_query(content);
+			if (not Q.kings) {
+				return false;
+			}
+		}
+		else {
+			std::cerr << "Invalid field indicator '" << name << "'.\n";
+			return false;
+		}
+
+		p = second + 1;
+	}
+	return true;
+}
+
+static void append_bounds(
+	const char color, const std::optional<pair>& bounds, std::string& s
+)
+{
+	if (bounds) {
+		s += color;
+		s += ':';
+		s += std::to_string(bounds->lb);
+		s += ',';
+		s += std::to_string(bounds->ub);
+		s += ';';
+	}
+}
+
+static void append_piece_field(
+	const char name, const query_data& q, std::string& s
+)
+{
+	if (not q.query_white and not q.query_black and not q.query_both) {
+		return;
+	}
+	s += name;
+	s += '[';
+	append_bounds('w', q.query_white, s);
+	append_bounds('b', q.query_black, s);
+	append_bounds('t', q.query_both, s);
+	s += ']';
+}
+
+std::string make_query_key(const querier& Q)
+{
+	std::string key;
+	append_piece_field('p', Q.pawns, key);
+	append_piece_field('r', Q.rooks, key);
+	append_piece_field('k', Q.knights, key);
+	append_piece_field('b', Q.bishops, key);
+	append_piece_field('q', Q.queens, key);
+	if (Q.query_total_pieces) {
+		key += "T[";
+		append_bounds('T', Q.query_total_pieces, key);
+		key.pop_back();
+		key += ']';
+	}
+	if (Q.query_player_turn) {
+		key += "M[";
+		key += (*Q.query_player_turn == TURN_WHITE ? 'w' : 'b');
+		key += ']';
+	}
+	if (not Q.squares.empty()) {
+		key += "S[";
+		for (size_t s = 0; s < 64; ++s) {
+			for (size_t c = 0; c < NUM_SQUARE_CONTENTS; ++c) {
+				if ((Q.squares.required[c] >> s) & 1) {
+					key += static_cast<char>('a' + s % 8);
+					key += static_cast<char>('1' + s / 8);
+					key += ':';
+					key += SQUARE_CONTENTS[c];
+					key += ';';
+				}
+			}
+		}
+		key += ']';
+	}
+	if (Q.endgame) {
+		key += "E[";
+		key += to_string(*Q.endgame);
+		key += ']';
+	}
+	if (Q.pawn_structure) {
+		key += "P[";
+		key += to_string(*Q.pawn_structure);
+		key += ']';
+	}
+	if (Q.kings) {
+		key += "K[";
+		key += to_string(*Q.kings);
+		key += ']';
+	}
+	return key;
+}
+
+} // namespace cpb
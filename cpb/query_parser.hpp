@@ -0,0 +1,67 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <string>
+
+// cpb includes
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Parses a query written in its compact text form.
+ *
+ * The query is a sequence of fields 'name[content]'. Fields 'p', 'r', 'k',
+ * 'b' and 'q' bound the number of pawns, rooks, knights, bishops and queens,
+ * and their content is a sequence of 'color:lb,ub;' where color is 'w'
+ * (White), 'b' (Black) or 't' (both). Field 'T' bounds the total number of
+ * pieces with content 'T:lb,ub', and field 'M' sets the player to move with
+ * content 'w' or 'b'. Field 'S' sets the contents of single squares, and its
+ * content is a sequence of 'square:content;' where content is a piece in
+ * FEN notation or '.' for an empty square. Field 'E' restricts the
+ * positions to an endgame class such as 'KRP*vKR' (see
+ * @ref parse_endgame_class), and field 'P' to the positions with exactly,
+ * or at least, some pawns, such as 'c:d4/d5' (see @ref parse_pawn_query).
+ * Field 'K' sets the squares the kings may stand on, such as 'w:1;b:g8,h;'
+ * (see @ref parse_king_query). For example,
+ * 'p[w:1,3;b:0,4;]M[b]S[g1:K;e4:.;]'.
+ *
+ * Fields not present in @e s are left unset in @e Q.
+ * @returns Whether or not @e s is a valid query.
+ */
+bool parse_query(const std::string_view s, querier& Q) noexcept;
+
+/**
+ * @brief Returns the normalized form of a query.
+ *
+ * The normalized form has the same syntax as the one read by
+ * @ref parse_query, with the fields in a fixed order. Two queries that select
+ * the same positions in the same way have the same normalized form.
+ */
+[[nodiscard]] std::string make_query_key(const querier& Q);
+
+} // namespace cpb
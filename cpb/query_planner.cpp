@@ -0,0 +1,156 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <optional>
+
+// cpb includes
+#include <cpb/query_planner.hpp>
+
+namespace cpb {
+
+namespace {
+
+[[nodiscard]] bool
+in_bounds(const std::optional<pair>& bounds, const int v) noexcept
+{
+	return not bounds or (bounds->lb <= v and v <= bounds->ub);
+}
+
+[[nodiscard]] bool
+below_bound(const std::optional<pair>& bounds, const int v) noexcept
+{
+	return not bounds or v <= bounds->ub;
+}
+
+/// Can @e key pieces of one color, bounded by @e own, lead to a match?
+[[nodiscard]] bool may_accept_count(
+	const querier& Q,
+	const query_data& q,
+	const std::optional<pair>& own,
+	const int key
+) noexcept
+{
+	return in_bounds(own, key) and below_bound(q.query_both, key) and
+		   below_bound(Q.query_total_pieces, key);
+}
+
+} // namespace
+
+bool may_accept(
+	const querier& Q, const layout_field field, const int key
+) noexcept
+{
+	switch (field) {
+	case layout_field::white_pawns:
+		return may_accept_count(Q, Q.pawns, Q.pawns.query_white, key);
+	case layout_field::black_pawns:
+		return may_accept_count(Q, Q.pawns, Q.pawns.query_black, key);
+	case layout_field::white_rooks:
+		return may_accept_count(Q, Q.rooks, Q.rooks.query_white, key);
+	case layout_field::black_rooks:
+		return may_accept_count(Q, Q.rooks, Q.rooks.query_black, key);
+	case layout_field::white_knights:
+		return may_accept_count(Q, Q.knights, Q.knights.query_white, key);
+	case layout_field::black_knights:
+		return may_accept_count(Q, Q.knights, Q.knights.query_black, key);
+	case layout_field::white_bishops:
+		return may_accept_count(Q, Q.bishops, Q.bishops.query_white, key);
+	case layout_field::black_bishops:
+		return may_accept_count(Q, Q.bishops, Q.bishops.query_black, key);
+	case layout_field::white_queens:
+		return may_accept_count(Q, Q.queens, Q.queens.query_white, key);
+	case layout_field::black_queens:
+		return may_accept_count(Q, Q.queens, Q.queens.query_black, key);
+	case layout_field::turn:
+		return not Q.query_player_turn or
+			   static_cast<unsigned>(key) == *Q.query_player_turn;
+	case layout_field::total_pieces:
+		return in_bounds(Q.query_total_pieces, key);
+	}
+	return true;
+}
+
+double estimate_cost(
+	const querier& Q,
+	const layout_statistics& stats,
+	const std::span<const layout_field> fields
+) noexcept
+{
+	if (stats.num_positions == 0) {
+		return 0;
+	}
+
+	const auto num_positions = static_cast<double>(stats.num_positions);
+
+	// fraction of the nodes of the current level that are visited
+	double visited = 1;
+	double cost = 0;
+	for (size_t l = 0; l < stats.num_levels; ++l) {
+		cost += static_cast<double>(stats.nodes[l + 1]) * visited;
+
+		size_t accepted = 0;
+		for (size_t key = 0; key < MAX_LAYOUT_KEY; ++key) {
+			if (may_accept(Q, fields[l], static_cast<int>(key))) {
+				accepted += stats.positions[l][key];
+			}
+		}
+		visited *= static_cast<double>(accepted) / num_positions;
+	}
+	return cost + static_cast<double>(stats.num_leaves) * visited;
+}
+
+query_plan
+plan_query(const querier& Q, const database_layouts *const layouts) noexcept
+{
+	query_plan plan;
+	if (layouts == nullptr) {
+		return plan;
+	}
+
+	const auto cost = [&](const index_layout layout)
+	{
+		return estimate_cost(
+			Q,
+			layouts->statistics[static_cast<size_t>(layout)],
+			layout_fields(layout)
+		);
+	};
+
+	plan.cost = cost(index_layout::pieces_first);
+	const double threshold = plan.cost * PLAN_MARGIN;
+	for (size_t i = 1; i < NUM_INDEX_LAYOUTS; ++i) {
+		if (not layouts->built[i]) {
+			continue;
+		}
+		const auto layout = static_cast<index_layout>(i);
+		const double c = cost(layout);
+		if (c < threshold and c < plan.cost) {
+			plan.layout = layout;
+			plan.cost = c;
+		}
+	}
+	return plan;
+}
+
+} // namespace cpb
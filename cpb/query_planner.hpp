@@ -0,0 +1,338 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <cstddef>
+#include <vector>
+#include <limits>
+#include <array>
+#include <span>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/index_layouts.hpp>
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief Another layout is only used when its estimated cost is below this
+ * fraction of that of the database itself.
+ *
+ * The estimates are rough, and the results of a query come in the order of
+ * the layout used to evaluate it.
+ */
+static constexpr double PLAN_MARGIN = 0.5;
+
+/**
+ * @brief The runs of a side index are only visited when they hold at most
+ * this fraction of the positions of the database.
+ *
+ * The runs found are copied and sorted before they are visited, which costs
+ * more than traversing the tree when they are many.
+ */
+static constexpr double SIDE_INDEX_FRACTION = 0.1;
+
+/// The layout chosen to evaluate a query.
+struct query_plan {
+	/// The layout.
+	index_layout layout = index_layout::pieces_first;
+	/// Estimated cost of evaluating the query with @ref layout.
+	double cost = 0;
+};
+
+/**
+ * @brief Can the key @e key of a level keyed by @e field lead to a position
+ * that matches @e Q?
+ *
+ * Only the constraints of @e Q that depend on @e field alone are checked.
+ */
+[[nodiscard]] bool
+may_accept(const querier& Q, const layout_field field, const int key) noexcept;
+
+/**
+ * @brief Estimates the cost of evaluating @e Q on a layout with levels
+ * @e fields and statistics @e stats.
+ *
+ * The cost is the number of nodes visited plus the number of leaves reached.
+ * The constraints on different levels are assumed to be independent: the
+ * fraction of the nodes of a level that are visited is the product of the
+ * fractions of the positions accepted by every level above it.
+ */
+[[nodiscard]] double estimate_cost(
+	const querier& Q,
+	const layout_statistics& stats,
+	const std::span<const layout_field> fields
+) noexcept;
+
+/**
+ * @brief Chooses the layout of @e layouts with which to evaluate @e Q.
+ *
+ * The database itself is chosen when @e layouts is null.
+ */
+[[nodiscard]] query_plan
+plan_query(const querier& Q, const database_layouts *const layouts) noexcept;
+
+/**
+ * @brief Calls @e f on the matching positions of every leaf of the layout
+ * @e node, with levels @e fields, accepted by @e Q.
+ *
+ * The constraints of @e Q on every level alone, and the upper bound on the
+ * total number of pieces, are checked as the layout is descended; the whole
+ * query is checked by @e ev when all the counts are known. Function @e f is
+ * called as in @ref for_each_leaf.
+ * @returns Whether or not the traversal was completed.
+ */
+template <size_t level = 0, size_t N, typename node_t, typename function_t>
+bool for_each_layout_leaf(
+	const node_t& node,
+	const std::array<layout_field, N>& fields,
+	const querier& Q,
+	query_evaluator& ev,
+	std::array<char, NUM_COUNT_LEVELS>& counts,
+	const int pieces_so_far,
+	function_t& f
+)
+{
+	const layout_field field = fields[level];
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		const char key = it->first;
+		if (not may_accept(Q, field, key)) {
+			continue;
+		}
+
+		int pieces = pieces_so_far;
+		if (field != layout_field::total_pieces) {
+			counts[static_cast<size_t>(field)] = key;
+			pieces += field != layout_field::turn ? key : 0;
+		}
+		if (Q.query_total_pieces and pieces > Q.query_total_pieces->ub) {
+			continue;
+		}
+
+		if constexpr (level + 1 == N) {
+			if (not ev.accept_counts(counts)) {
+				continue;
+			}
+			for (const leaf_ref& ref : it->second) {
+				if (not ev.accept_squares(ref.squares)) {
+					continue;
+				}
+				const std::span<const position> leaf(ref.data, ref.size);
+				if (not ev.visit_leaf(leaf, f)) {
+					return false;
+				}
+			}
+		}
+		else {
+			const bool completed = for_each_layout_leaf<level + 1>(
+				it->second, fields, Q, ev, counts, pieces, f
+			);
+			if (not completed) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Calls @e f on the matching positions of the leaves in
+ * @e materials of the endgame class @e E that are accepted by @e ev.
+ *
+ * Only the leaves of the signatures of @e E are looked at. Function @e f is
+ * called as in @ref for_each_leaf, and the leaves are visited in the same
+ * order as in @ref for_each_leaf.
+ * @returns Whether or not the traversal was completed.
+ */
+template <typename function_t>
+bool for_each_endgame_leaf(
+	const database_materials& materials,
+	const endgame_class& E,
+	query_evaluator& ev,
+	function_t& f
+)
+{
+	for (const material_signature s : material_signatures(E)) {
+		const auto it = materials.leaves.find(s);
+		if (it == materials.leaves.end()) {
+			continue;
+		}
+		for (const material_entry& entry : it->second) {
+			if (not ev.accept_counts(entry.counts) or
+				not ev.accept_squares(entry.leaf.squares)) {
+				continue;
+			}
+			const std::span<const position> leaf(
+				entry.leaf.data, entry.leaf.size
+			);
+			if (not ev.visit_leaf(leaf, f)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Calls @e f on the matching positions of the runs @e runs of a side
+ * index, with leaves @e leaves, that are accepted by @e ev.
+ *
+ * The runs must be in the order of the range iterators, and so are the
+ * positions visited. Function @e f is called as in @ref for_each_leaf.
+ * @returns Whether or not the traversal was completed.
+ */
+template <typename function_t>
+bool for_each_run(
+	const std::vector<material_entry>& leaves,
+	const std::vector<leaf_run>& runs,
+	query_evaluator& ev,
+	function_t& f
+)
+{
+	size_t leaf = leaves.size();
+	bool accepted = false;
+	for (const leaf_run& run : runs) {
+		// the runs of the same leaf are consecutive
+		if (run.leaf != leaf) {
+			leaf = run.leaf;
+			const material_entry& entry = leaves[leaf];
+			accepted = ev.accept_counts(entry.counts) and
+					   ev.accept_squares(entry.leaf.squares);
+		}
+		if (not accepted) {
+			continue;
+		}
+		const std::span<const position> positions(run.data, run.size);
+		if (not ev.visit_leaf(positions, f)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Calls @e f on the matching positions of every leaf of @e db
+ * accepted by @e Q, using the layout chosen by @ref plan_query.
+ *
+ * Queries that constrain the pawns or the kings, or with an endgame class,
+ * are answered with the pawn skeletons, the squares of the kings or the
+ * material signatures of the index, if any: when several apply, the
+ * candidates of the smallest are visited, and the other constraints are
+ * checked on them. The pawn skeletons and the squares of the kings are only
+ * used when their candidates are at most @ref SIDE_INDEX_FRACTION of the
+ * database.
+ * Function @e f is called as in @ref for_each_leaf. The leaves are visited
+ * in the order of the layout chosen.
+ * @param db The database.
+ * @param Q The query.
+ * @param index If not null, the index of @e db. Otherwise, @e db must be
+ * loaded with the default square levels.
+ * @param f The function.
+ * @returns Whether or not the traversal was completed.
+ */
+template <typename function_t>
+bool for_each_planned_leaf(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const database_index *const index,
+	function_t& f
+)
+{
+	if (index != nullptr) {
+		const database_pawns *const pawns =
+			Q.pawn_structure ? index->skeletons.find(db) : nullptr;
+		const database_kings *const kings =
+			Q.kings ? index->kings.find(db) : nullptr;
+		const database_materials *const materials =
+			Q.endgame ? index->signatures.find(db) : nullptr;
+
+		// the number of candidates of every side index that applies
+		constexpr size_t none = std::numeric_limits<size_t>::max();
+		const size_t num_pawns =
+			pawns != nullptr ? pawns->count(*Q.pawn_structure) : none;
+		const size_t num_kings =
+			kings != nullptr ? kings->count(*Q.kings) : none;
+		const size_t num_materials =
+			materials != nullptr ? materials->count(*Q.endgame) : none;
+
+		// the runs of the pawn and king indexes are only worth copying and
+		// sorting when they are few
+		const auto few = [&](const size_t n)
+		{
+			return n != none and
+				   static_cast<double>(n) <=
+					   SIDE_INDEX_FRACTION * static_cast<double>(db.size());
+		};
+		if (few(num_pawns) and num_pawns <= num_kings and
+			num_pawns <= num_materials) {
+			// the pawns of the runs are those of the query
+			querier R = Q;
+			restrict_to_pawns(R);
+			R.pawn_structure = {};
+			query_evaluator ev(R, index);
+			return for_each_run(
+				pawns->leaves, pawns->find(*Q.pawn_structure), ev, f
+			);
+		}
+
+		if (few(num_kings) and num_kings <= num_materials) {
+			// the kings of the runs are where the query wants them
+			querier R = Q;
+			R.kings = {};
+			query_evaluator ev(R, index);
+			return for_each_run(kings->leaves, kings->find(*Q.kings), ev, f);
+		}
+		if (materials != nullptr) {
+			query_evaluator ev(Q, index);
+			return for_each_endgame_leaf(*materials, *Q.endgame, ev, f);
+		}
+	}
+
+	query_evaluator ev(Q, index);
+
+	const database_layouts *const layouts =
+		index != nullptr ? index->layouts.find(db) : nullptr;
+	std::array<char, NUM_COUNT_LEVELS> counts{};
+
+	switch (plan_query(Q, layouts).layout) {
+	case index_layout::queens_first:
+		return for_each_layout_leaf(
+			layouts->queens_first, QUEENS_FIRST_FIELDS, Q, ev, counts, 0, f
+		);
+	case index_layout::material_first:
+		return for_each_layout_leaf(
+			layouts->material_first, MATERIAL_FIRST_FIELDS, Q, ev, counts, 0, f
+		);
+	case index_layout::pieces_first:
+		break;
+	}
+	return for_each_leaf(db, ev, f);
+}
+
+} // namespace cpb
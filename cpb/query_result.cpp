@@ -0,0 +1,206 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#if defined DEBUG
+#include <cassert>
+#endif
+#include <unordered_set>
+#include <algorithm>
+#include <numeric>
+
+// cpb includes
+#include <cpb/profiler.hpp>
+#include <cpb/query_planner.hpp>
+#include <cpb/query_result.hpp>
+
+namespace cpb {
+
+bool query_result::build(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::stop_token& stop,
+	std::atomic<size_t> *const num_found,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	clear();
+	if (not append(db, Q, stop, num_found, index)) {
+		clear();
+		return false;
+	}
+	return true;
+}
+
+bool query_result::build(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const std::stop_token& stop,
+	std::atomic<size_t> *const num_found,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	clear();
+	for (const PuzzleDatabase *db : dbs) {
+		if (not append(*db, Q, stop, num_found, index)) {
+			clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool query_result::append(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::stop_token& stop,
+	std::atomic<size_t> *const num_found,
+	const database_index *const index
+)
+{
+	auto add_leaf = [this, &stop, num_found](
+						const position *const data, const size_t n
+					) -> bool
+	{
+		if (stop.stop_requested()) {
+			return false;
+		}
+		push_leaf(data, n);
+		if (num_found != nullptr) {
+			num_found->store(m_size, std::memory_order_relaxed);
+		}
+		return true;
+	};
+	return for_each_planned_leaf(db, Q, index, add_leaf);
+}
+
+const position *find_first(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::stop_token& stop,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	const position *first = nullptr;
+
+	auto find_leaf = [&first, &stop](const position *const data, size_t) -> bool
+	{
+		if (stop.stop_requested()) {
+			return false;
+		}
+		first = data;
+		return false;
+	};
+	[[maybe_unused]] const bool _ = for_each_planned_leaf(db, Q, index, find_leaf);
+	return first;
+}
+
+const position *find_first(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const std::stop_token& stop,
+	const database_index *const index
+)
+{
+	PROFILE_FUNCTION;
+
+	for (const PuzzleDatabase *db : dbs) {
+		const position *first = find_first(*db, Q, stop, index);
+		if (first != nullptr) {
+			return first;
+		}
+		if (stop.stop_requested()) {
+			break;
+		}
+	}
+	return nullptr;
+}
+
+const position& query_result::seek(const size_t k) const noexcept
+{
+#if defined DEBUG
+	assert(k < m_size);
+#endif
+
+	// first leaf whose first position comes after 'k'
+	const auto it = std::upper_bound(
+		m_leaves.begin(),
+		m_leaves.end(),
+		k,
+		[](const size_t v, const leaf_range& l)
+		{
+			return v < l.first;
+		}
+	);
+	const leaf_range& l = *(it - 1);
+	return l.data[k - l.first];
+}
+
+size_t query_result::random_index(std::mt19937_64& gen) const noexcept
+{
+#if defined DEBUG
+	assert(m_size > 0);
+#endif
+
+	std::uniform_int_distribution<size_t> dist(0, m_size - 1);
+	return dist(gen);
+}
+
+std::vector<size_t> query_result::random_indices(
+	const size_t k, std::mt19937_64& gen, const std::stop_token& stop
+) const
+{
+	std::vector<size_t> indices;
+
+	if (k >= m_size) {
+		indices.resize(m_size);
+		std::iota(indices.begin(), indices.end(), 0);
+		return indices;
+	}
+
+	// Robert Floyd's algorithm: exactly k draws, each of them uniform
+	std::unordered_set<size_t> chosen;
+	chosen.reserve(k);
+	for (size_t j = m_size - k; j < m_size; ++j) {
+		if ((j & 0xfff) == 0 and stop.stop_requested()) {
+			return indices;
+		}
+		std::uniform_int_distribution<size_t> dist(0, j);
+		const size_t t = dist(gen);
+		if (not chosen.insert(t).second) {
+			chosen.insert(j);
+		}
+	}
+
+	indices.assign(chosen.begin(), chosen.end());
+	std::sort(indices.begin(), indices.end());
+	return indices;
+}
+
+} // namespace cpb
@@ -0,0 +1,236 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <stop_token>
+#include <cstddef>
+#include <atomic>
+#include <random>
+#include <span>
+#include <vector>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+#include <cpb/position.hpp>
+#include <cpb/query.hpp>
+
+namespace cpb {
+
+/**
+ * @brief The positions of a database that match a query.
+ *
+ * Only the leaves of the database that match the query are stored, together
+ * with the number of matching positions that precede each of them. This
+ * makes it possible to access the k-th position in logarithmic time in the
+ * number of matching leaves, without stepping a range iterator k times.
+ *
+ * The database must not be modified while this object is in use.
+ */
+class query_result {
+public:
+
+	/**
+	 * @brief Fills this object with the positions of @e db that match @e Q.
+	 *
+	 * The traversal is abandoned as soon as a stop is requested through
+	 * @e stop, in which case this object is left empty.
+	 * @param db The database.
+	 * @param Q The query.
+	 * @param stop Used to cancel the traversal.
+	 * @param num_found If not null, it is updated with the number of matching
+	 * positions found so far while the traversal goes on.
+	 * @param index If not null, the index of @e db. Otherwise, @e db must be
+	 * loaded with the default square levels.
+	 * @returns Whether or not the traversal was completed.
+	 */
+	bool build(
+		const PuzzleDatabase& db,
+		const querier& Q,
+		const std::stop_token& stop = {},
+		std::atomic<size_t> *const num_found = nullptr,
+		const database_index *const index = nullptr
+	);
+
+	/**
+	 * @brief Fills this object with the positions of all the databases in
+	 * @e dbs that match @e Q.
+	 *
+	 * The positions of every database come after those of the previous
+	 * ones. Positions that appear in several databases appear several times.
+	 * @param dbs The databases.
+	 * @param Q The query.
+	 * @param stop Used to cancel the traversal.
+	 * @param num_found If not null, it is updated with the number of matching
+	 * positions found so far while the traversal goes on.
+	 * @param index If not null, the index of the databases. Otherwise, they
+	 * must be loaded with the default square levels.
+	 * @returns Whether or not the traversal was completed.
+	 */
+	bool build(
+		const std::span<const PuzzleDatabase *const> dbs,
+		const querier& Q,
+		const std::stop_token& stop = {},
+		std::atomic<size_t> *const num_found = nullptr,
+		const database_index *const index = nullptr
+	);
+
+	/**
+	 * @brief Adds @e size consecutive positions of a leaf after the current
+	 * ones.
+	 *
+	 * Used to fill this object from other traversals of the database, such
+	 * as that of @ref query_batch.
+	 */
+	void push_leaf(const position *const data, const size_t size)
+	{
+		m_leaves.push_back({.first = m_size, .data = data});
+		m_size += size;
+	}
+
+	/// Removes all positions from this object.
+	void clear() noexcept
+	{
+		m_leaves.clear();
+		m_size = 0;
+	}
+
+	/// Number of positions that match the query.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_size;
+	}
+	/// Is the result empty?
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+
+	/**
+	 * @brief Returns the @e k-th matching position.
+	 *
+	 * Positions are numbered in the same order a range iterator would visit
+	 * them, unless the query is evaluated with a secondary layout of the
+	 * index (see @ref plan_query), in which case they follow that layout.
+	 * @pre @e k < @ref size().
+	 */
+	[[nodiscard]] const position& seek(const size_t k) const noexcept;
+
+	/**
+	 * @brief Returns the index of a uniformly random matching position.
+	 *
+	 * Choosing an index uniformly at random and then locating its leaf is
+	 * equivalent to descending the tree choosing every child with
+	 * probability proportional to its number of matching positions.
+	 * @pre The result is not empty.
+	 */
+	[[nodiscard]] size_t random_index(std::mt19937_64& gen) const noexcept;
+
+	/**
+	 * @brief Returns the indices of @e k matching positions chosen uniformly
+	 * at random without replacement.
+	 *
+	 * If @e k is larger than @ref size() then all indices are returned.
+	 * @param k Number of indices.
+	 * @param gen Random number generator.
+	 * @param stop Stops the sampling when requested.
+	 * @returns The indices sorted in increasing order, or none if @e stop
+	 * was requested.
+	 */
+	[[nodiscard]] std::vector<size_t> random_indices(
+		const size_t k,
+		std::mt19937_64& gen,
+		const std::stop_token& stop = {}
+	) const;
+
+	/// Number of bytes used by this object.
+	[[nodiscard]] size_t num_bytes() const noexcept
+	{
+		return sizeof(query_result) + m_leaves.capacity() * sizeof(leaf_range);
+	}
+
+private:
+
+	/**
+	 * @brief Adds the leaves of @e db that match @e Q after the current ones.
+	 * @returns Whether or not the traversal was completed.
+	 */
+	bool append(
+		const PuzzleDatabase& db,
+		const querier& Q,
+		const std::stop_token& stop,
+		std::atomic<size_t> *const num_found,
+		const database_index *const index
+	);
+
+private:
+
+	/// Consecutive positions of a leaf of the database that match the query.
+	struct leaf_range {
+		/// Number of matching positions in all previous ranges.
+		size_t first;
+		/// The positions in this range.
+		const position *data;
+	};
+
+	/// The ranges that match the query, in the order of the traversal.
+	std::vector<leaf_range> m_leaves;
+	/// Total number of positions that match the query.
+	size_t m_size = 0;
+};
+
+/**
+ * @brief Returns the first position of @e db that matches @e Q.
+ *
+ * This is the position a range iterator would visit first, found without
+ * traversing the rest of the database.
+ * @param index If not null, the index of @e db.
+ * @returns The position, or a null pointer if no position matches @e Q or
+ * a stop was requested through @e stop.
+ */
+[[nodiscard]] const position *find_first(
+	const PuzzleDatabase& db,
+	const querier& Q,
+	const std::stop_token& stop = {},
+	const database_index *const index = nullptr
+);
+
+/**
+ * @brief Returns the first position of the databases in @e dbs that matches
+ * @e Q.
+ *
+ * The databases are inspected in order.
+ * @param index If not null, the index of the databases.
+ * @returns The position, or a null pointer if no position matches @e Q or
+ * a stop was requested through @e stop.
+ */
+[[nodiscard]] const position *find_first(
+	const std::span<const PuzzleDatabase *const> dbs,
+	const querier& Q,
+	const std::stop_token& stop = {},
+	const database_index *const index = nullptr
+);
+
+} // namespace cpb
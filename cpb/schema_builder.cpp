@@ -0,0 +1,302 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cmath>
+
+// cpb includes
+#include <cpb/schema_builder.hpp>
+#include <cpb/position.hpp>
+#include <cpb/profiler.hpp>
+
+namespace cpb {
+
+namespace {
+
+/// Per-level accumulators of @ref measure_levels.
+struct level_counts {
+	/// Number of positions below every key of every level.
+	std::array<std::array<size_t, 256>, NUM_LEVELS> positions = {};
+	/// Number of nodes of every level.
+	std::array<size_t, NUM_LEVELS> nodes = {};
+	/// Number of children of the nodes of every level.
+	std::array<size_t, NUM_LEVELS> children = {};
+	/// Sum of the squares of the sizes of the leaves.
+	double sum_squares = 0;
+	/// Number of non-empty leaves.
+	size_t num_leaves = 0;
+};
+
+template <size_t level, typename node_t>
+void count_level(const node_t& node, level_counts& counts)
+{
+	++counts.nodes[level];
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		++counts.children[level];
+
+		const auto key = static_cast<unsigned char>(it->first);
+		if constexpr (level + 1 == NUM_LEVELS) {
+			const size_t n = it->second.size();
+			counts.positions[level][key] += n;
+			if (n > 0) {
+				++counts.num_leaves;
+				const auto size = static_cast<double>(n);
+				counts.sum_squares += size * size;
+			}
+		}
+		else {
+			counts.positions[level][key] += it->second.size();
+			count_level<level + 1>(it->second, counts);
+		}
+	}
+}
+
+/// Entropy, in bits, of a distribution given by its counts.
+template <typename range_t>
+[[nodiscard]] double entropy(const range_t& counts) noexcept
+{
+	double total = 0;
+	for (const size_t c : counts) {
+		total += static_cast<double>(c);
+	}
+	if (total == 0) {
+		return 0;
+	}
+	double h = 0;
+	for (const size_t c : counts) {
+		if (c > 0) {
+			const double p = static_cast<double>(c) / total;
+			h -= p * std::log2(p);
+		}
+	}
+	return h;
+}
+
+/// Collects the positions below @e node into @e group.
+template <size_t level, typename node_t>
+void collect(const node_t& node, std::vector<const position *>& group)
+{
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		if constexpr (level + 1 == NUM_LEVELS) {
+			for (const position& p : it->second) {
+				group.push_back(&p);
+			}
+		}
+		else {
+			collect<level + 1>(it->second, group);
+		}
+	}
+}
+
+/// Groups the positions of @e node by the keys of the levels before the
+/// square levels.
+template <size_t level, typename node_t>
+void group_positions(
+	const node_t& node, std::vector<std::vector<const position *>>& groups
+)
+{
+	for (auto it = node.begin(); it != node.end(); ++it) {
+		if constexpr (level + 1 == LEVEL_FIRST_SQUARE) {
+			groups.emplace_back();
+			collect<level + 1>(it->second, groups.back());
+		}
+		else {
+			group_positions<level + 1>(it->second, groups);
+		}
+	}
+}
+
+/**
+ * @brief Sum of the squares of the sizes of the leaves into which @e groups
+ * are split by the square levels @e squares.
+ */
+[[nodiscard]] double leaf_cost(
+	const std::vector<std::vector<const position *>>& groups,
+	const std::array<uint8_t, NUM_SQUARE_LEVELS>& squares
+)
+{
+	double cost = 0;
+	std::vector<uint64_t> keys;
+	for (const std::vector<const position *>& group : groups) {
+		keys.clear();
+		for (const position *p : group) {
+			uint64_t key = 0;
+			for (const uint8_t s : squares) {
+				key = (key << 8) | static_cast<unsigned char>(p->pieces[s]);
+			}
+			keys.push_back(key);
+		}
+		std::sort(keys.begin(), keys.end());
+
+		size_t i = 0;
+		while (i < keys.size()) {
+			size_t j = i + 1;
+			while (j < keys.size() and keys[j] == keys[i]) {
+				++j;
+			}
+			const auto size = static_cast<double>(j - i);
+			cost += size * size;
+			i = j;
+		}
+	}
+	return cost;
+}
+
+} // namespace
+
+level_statistics measure_levels(const PuzzleDatabase& db)
+{
+	PROFILE_FUNCTION;
+
+	const auto counts = std::make_unique<level_counts>();
+	count_level<0>(db, *counts);
+
+	level_statistics stats;
+	for (size_t l = 0; l < NUM_LEVELS; ++l) {
+		stats.entropy[l] = entropy(counts->positions[l]);
+		stats.fan_out[l] =
+			counts->nodes[l] == 0
+				? 0
+				: static_cast<double>(counts->children[l]) /
+					  static_cast<double>(counts->nodes[l]);
+	}
+	stats.num_leaves = counts->num_leaves;
+	stats.expected_leaf_size =
+		db.size() == 0 ? 0
+					   : counts->sum_squares / static_cast<double>(db.size());
+	return stats;
+}
+
+square_levels choose_square_levels(const PuzzleDatabase& sample)
+{
+	PROFILE_FUNCTION;
+
+	std::vector<std::vector<const position *>> groups;
+	group_positions<0>(sample, groups);
+	if (sample.size() < 2) {
+		return {};
+	}
+
+	const std::vector<std::vector<const position *>> initial = groups;
+
+	std::array<bool, 64> chosen = {};
+	std::array<uint8_t, NUM_SQUARE_LEVELS> squares = {};
+	std::array<double, 64> square_entropy = {};
+
+	for (size_t i = 0; i < NUM_SQUARE_LEVELS; ++i) {
+		// the sum of the squares of the sizes of the groups after splitting
+		// them by the content of every square
+		std::array<double, 64> cost = {};
+		for (const std::vector<const position *>& group : groups) {
+			for (size_t s = 0; s < 64; ++s) {
+				if (chosen[s]) {
+					continue;
+				}
+				std::array<size_t, NUM_SQUARE_CONTENTS + 1> n = {};
+				for (const position *p : group) {
+					++n[square_content_index(p->pieces[s])];
+				}
+				for (const size_t c : n) {
+					cost[s] += static_cast<double>(c) * static_cast<double>(c);
+				}
+			}
+		}
+
+		size_t best = 64;
+		for (size_t s = 0; s < 64; ++s) {
+			if (not chosen[s] and (best == 64 or cost[s] < cost[best])) {
+				best = s;
+			}
+		}
+		chosen[best] = true;
+		squares[i] = static_cast<uint8_t>(best);
+
+		// split the groups by the content of the square chosen
+		std::vector<std::vector<const position *>> next;
+		std::array<size_t, NUM_SQUARE_CONTENTS + 1> total = {};
+		for (const std::vector<const position *>& group : groups) {
+			std::array<std::vector<const position *>, NUM_SQUARE_CONTENTS + 1>
+				parts;
+			for (const position *p : group) {
+				const size_t c = square_content_index(p->pieces[best]);
+				parts[c].push_back(p);
+				++total[c];
+			}
+			for (std::vector<const position *>& part : parts) {
+				if (part.size() > 1) {
+					next.push_back(std::move(part));
+				}
+			}
+		}
+		groups = std::move(next);
+		square_entropy[best] = entropy(total);
+	}
+
+	// fewer nodes close to the root
+	std::stable_sort(
+		squares.begin(),
+		squares.end(),
+		[&](const uint8_t a, const uint8_t b)
+		{
+			return square_entropy[a] < square_entropy[b];
+		}
+	);
+
+	// the greedy choice is not optimal: keep the default levels when they
+	// split the sample better
+	square_levels levels;
+	if (leaf_cost(initial, squares) < leaf_cost(initial, levels.squares)) {
+		levels.squares = squares;
+	}
+	return levels;
+}
+
+std::expected<square_levels, lichess::load_error> choose_square_levels(
+	const std::string_view lichess_file, const size_t sample_size
+)
+{
+	PROFILE_FUNCTION;
+
+	std::unique_ptr<PuzzleDatabase> sample;
+	const auto res = lichess::load_database_chunked(
+		lichess_file,
+		std::max<size_t>(1, sample_size),
+		[&sample](std::unique_ptr<PuzzleDatabase> chunk, size_t)
+		{
+			sample = std::move(chunk);
+			return false;
+		}
+	);
+	if (not res.has_value()) {
+		return std::unexpected(res.error());
+	}
+	if (sample == nullptr) {
+		return square_levels{};
+	}
+	return choose_square_levels(*sample);
+}
+
+} // namespace cpb
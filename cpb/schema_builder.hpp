@@ -0,0 +1,85 @@
+/**
+ * Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <expected>
+#include <cstddef>
+#include <array>
+
+// cpb includes
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+namespace cpb {
+
+/// Statistics of the shape of a @ref PuzzleDatabase.
+struct level_statistics {
+	/**
+	 * @brief Entropy, in bits, of the keys of every level.
+	 *
+	 * The key of a level is weighted by the number of positions below it,
+	 * so a level with a high entropy splits the positions evenly.
+	 */
+	std::array<double, NUM_LEVELS> entropy = {};
+	/// Average number of children of the nodes of every level.
+	std::array<double, NUM_LEVELS> fan_out = {};
+	/// Number of non-empty leaves.
+	size_t num_leaves = 0;
+	/// Size of the leaf of a position chosen uniformly at random.
+	double expected_leaf_size = 0;
+};
+
+/// Measures the statistics of the levels of @e db.
+[[nodiscard]] level_statistics measure_levels(const PuzzleDatabase& db);
+
+/**
+ * @brief Chooses the square levels that split the positions of @e sample
+ * into the smallest leaves.
+ *
+ * The squares are chosen greedily: every square added is the one that
+ * minimizes the expected size of the leaf of a position, given the levels
+ * of the number of pieces, the turn and the squares chosen before. The
+ * squares are then ordered by increasing entropy of their contents among
+ * the positions not yet told apart when they were chosen, so that the
+ * levels closer to the root tend to have fewer nodes. The default levels
+ * are returned when they split the sample at least as well.
+ *
+ * The order of the other levels is fixed by the type of the database.
+ */
+[[nodiscard]] square_levels choose_square_levels(const PuzzleDatabase& sample);
+
+/**
+ * @brief Chooses the square levels for a lichess database file from its
+ * first @e sample_size positions.
+ *
+ * See @ref choose_square_levels.
+ */
+[[nodiscard]] std::expected<square_levels, lichess::load_error>
+choose_square_levels(
+	const std::string_view lichess_file, const size_t sample_size
+);
+
+} // namespace cpb
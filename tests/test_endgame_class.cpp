@@ -0,0 +1,273 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <string>
+#include <array>
+
+// cpb includes
+#include <cpb/material_signature.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// Number of pieces of every piece of @e p, in FEN notation.
+[[nodiscard]] std::array<int, 256> count_pieces(const cpb::position& p)
+{
+	std::array<int, 256> n{};
+	for (const char c : p.pieces) {
+		++n[static_cast<unsigned char>(c)];
+	}
+	return n;
+}
+
+/// The endgame class of @e p.
+[[nodiscard]] std::string endgame_of(const cpb::position& p)
+{
+	const std::array<int, 256> n = count_pieces(p);
+	std::string s = "K";
+	for (const char c : std::string_view{"QRBNP"}) {
+		s.append(static_cast<size_t>(n[static_cast<unsigned char>(c)]), c);
+	}
+	s += "vK";
+	for (const char c : std::string_view{"qrbnp"}) {
+		s.append(
+			static_cast<size_t>(n[static_cast<unsigned char>(c)]),
+			static_cast<char>(c - 'a' + 'A')
+		);
+	}
+	return s;
+}
+
+/// Does @e p belong to the class @e E?
+[[nodiscard]] bool belongs(const cpb::position& p, const cpb::endgame_class& E)
+{
+	const std::array<int, 256> n = count_pieces(p);
+	const auto count = [&](const char c)
+	{
+		return n[static_cast<unsigned char>(c)];
+	};
+	const auto pawns = [](const int have, const int want, const bool more)
+	{
+		return more ? have >= want : have == want;
+	};
+	return pawns(
+			   count('P'),
+			   E.counts[cpb::LEVEL_WHITE_PAWNS],
+			   E.more_white_pawns
+		   ) and
+		   pawns(
+			   count('p'),
+			   E.counts[cpb::LEVEL_BLACK_PAWNS],
+			   E.more_black_pawns
+		   ) and
+		   count('R') == E.counts[cpb::LEVEL_WHITE_ROOKS] and
+		   count('r') == E.counts[cpb::LEVEL_BLACK_ROOKS] and
+		   count('N') == E.counts[cpb::LEVEL_WHITE_KNIGHTS] and
+		   count('n') == E.counts[cpb::LEVEL_BLACK_KNIGHTS] and
+		   count('B') == E.counts[cpb::LEVEL_WHITE_BISHOPS] and
+		   count('b') == E.counts[cpb::LEVEL_BLACK_BISHOPS] and
+		   count('Q') == E.counts[cpb::LEVEL_WHITE_QUEENS] and
+		   count('q') == E.counts[cpb::LEVEL_BLACK_QUEENS];
+}
+
+/// Number of positions of @e db in the class @e E, with a full scan.
+[[nodiscard]] size_t
+count_class(const cpb::PuzzleDatabase& db, const cpb::endgame_class& E)
+{
+	cpb::query_result all;
+	all.build(db, cpb::querier{});
+	size_t n = 0;
+	for (size_t k = 0; k < all.size(); ++k) {
+		n += belongs(all.seek(k), E);
+	}
+	return n;
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+	REQUIRE(Q.endgame.has_value());
+
+	cpb::query_result without;
+	without.build(db, Q);
+	cpb::query_result with;
+	with.build(db, Q, {}, nullptr, &index);
+
+	// without other constraints, all the positions of the class match
+	if (query.starts_with("E[") and query.ends_with("]") and
+		query.find('[', 1) == std::string_view::npos) {
+		CHECK_EQ(without.size(), count_class(db, *Q.endgame));
+	}
+
+	REQUIRE(with.size() == without.size());
+	for (size_t k = 0; k < with.size(); ++k) {
+		CHECK(with.seek(k) == without.seek(k));
+		CHECK(belongs(with.seek(k), *Q.endgame));
+	}
+}
+
+TEST_CASE("endgame classes")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	SUBCASE("parse")
+	{
+		const auto E = cpb::parse_endgame_class("KRPvKR");
+		REQUIRE(E.has_value());
+		CHECK_EQ(E->counts[cpb::LEVEL_WHITE_ROOKS], 1);
+		CHECK_EQ(E->counts[cpb::LEVEL_WHITE_PAWNS], 1);
+		CHECK_EQ(E->counts[cpb::LEVEL_BLACK_ROOKS], 1);
+		CHECK_EQ(E->counts[cpb::LEVEL_BLACK_PAWNS], 0);
+		CHECK_FALSE(E->more_white_pawns);
+		CHECK_FALSE(E->more_black_pawns);
+		CHECK_EQ(cpb::to_string(*E), "KRPvKR");
+
+		// pieces are written in a fixed order
+		CHECK_EQ(cpb::to_string(*cpb::parse_endgame_class("KPRvKR")), "KRPvKR");
+		CHECK_EQ(
+			cpb::to_string(*cpb::parse_endgame_class("KNPBRQvKQ*")),
+			"KQRBNPvKQ*"
+		);
+		CHECK_EQ(cpb::to_string(*cpb::parse_endgame_class("KvK")), "KvK");
+
+		const auto W = cpb::parse_endgame_class("KRP*vKR*");
+		REQUIRE(W.has_value());
+		CHECK(W->more_white_pawns);
+		CHECK(W->more_black_pawns);
+		CHECK_EQ(W->counts[cpb::LEVEL_WHITE_PAWNS], 1);
+		CHECK_EQ(W->counts[cpb::LEVEL_BLACK_PAWNS], 0);
+
+		CHECK_FALSE(cpb::parse_endgame_class("KRPKR").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("RvK").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("KXvK").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("KvKvK").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("KP*PvK").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("KPPPPPPPPPvK").has_value());
+		CHECK_FALSE(cpb::parse_endgame_class("vK").has_value());
+
+		cpb::querier Q;
+		CHECK(cpb::parse_query("M[w]E[KPRvKR*]", Q));
+		CHECK_EQ(cpb::make_query_key(Q), "M[w]E[KRPvKR*]");
+		CHECK_FALSE(cpb::parse_query("E[KRvR]", Q));
+		CHECK(cpb::parse_query("M[w]", Q));
+		CHECK_FALSE(Q.endgame.has_value());
+	}
+
+	SUBCASE("signatures")
+	{
+		std::array<char, cpb::NUM_PIECE_LEVELS> a{};
+		std::array<char, cpb::NUM_PIECE_LEVELS> b{};
+		CHECK_EQ(
+			cpb::make_material_signature(a), cpb::make_material_signature(b)
+		);
+		for (size_t l = 0; l < cpb::NUM_PIECE_LEVELS; ++l) {
+			b = a;
+			b[l] = 1;
+			CHECK(
+				cpb::make_material_signature(a) !=
+				cpb::make_material_signature(b)
+			);
+		}
+
+		// pawns are not saturated
+		a[cpb::LEVEL_WHITE_PAWNS] = 7;
+		b = a;
+		b[cpb::LEVEL_WHITE_PAWNS] = 8;
+		CHECK(
+			cpb::make_material_signature(a) != cpb::make_material_signature(b)
+		);
+
+		CHECK_EQ(
+			cpb::material_signatures(*cpb::parse_endgame_class("KRvKR")).size(),
+			1
+		);
+		CHECK_EQ(
+			cpb::material_signatures(*cpb::parse_endgame_class("KR*vKR"))
+				.size(),
+			9
+		);
+		CHECK_EQ(
+			cpb::material_signatures(*cpb::parse_endgame_class("KRP*vKRP*"))
+				.size(),
+			64
+		);
+	}
+
+	SUBCASE("queries")
+	{
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db);
+		REQUIRE(loaded.has_value());
+
+		cpb::database_index index;
+		index.add(db);
+		REQUIRE(index.signatures.find(db) != nullptr);
+
+		// the classes of some positions of the database
+		cpb::query_result all;
+		all.build(db, cpb::querier{});
+		REQUIRE(all.size() > 0);
+		for (size_t k = 0; k < all.size(); k += 7) {
+			const std::string E = endgame_of(all.seek(k));
+			check_query(db, index, "E[" + E + "]");
+			check_query(db, index, "E[" + E + "]M[b]");
+		}
+
+		check_query(db, index, "E[K*vK*]");
+		check_query(db, index, "E[KR*vKR*]");
+		check_query(db, index, "E[KQ*vK*]");
+		check_query(db, index, "E[KRP*vKR*]");
+		check_query(db, index, "E[KQRRBNPPPPPP*vKQRRBNPPPPP*]");
+		check_query(db, index, "E[K*vK*]T[T:0,6]");
+		check_query(db, index, "E[KQ*vKQ*]q[w:0,0;]");
+		check_query(db, index, "E[KR*vKR*]S[g1:K;]");
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
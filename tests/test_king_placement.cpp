@@ -0,0 +1,226 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+// cpb includes
+#include <cpb/king_placement.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// The name of the square of index @e s.
+[[nodiscard]] std::string square_name(const size_t s)
+{
+	return {static_cast<char>('a' + s % 8), static_cast<char>('1' + s / 8)};
+}
+
+/// Does @e p have its kings where @e K wants them, checked square by square?
+[[nodiscard]] bool belongs(const cpb::position& p, const cpb::king_query& K)
+{
+	bool white = false;
+	bool black = false;
+	for (size_t i = 0; i < 64; ++i) {
+		if (p.pieces[i] == cpb::WHITE_KING) {
+			white = ((K.white >> i) & 1) != 0;
+		}
+		if (p.pieces[i] == cpb::BLACK_KING) {
+			black = ((K.black >> i) & 1) != 0;
+		}
+	}
+	return white and black;
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const cpb::database_index& summaries,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+	REQUIRE(Q.kings.has_value());
+
+	cpb::query_result without;
+	without.build(db, Q);
+	cpb::query_result with;
+	with.build(db, Q, {}, nullptr, &index);
+	cpb::query_result summarized;
+	summarized.build(db, Q, {}, nullptr, &summaries);
+
+	// without other constraints, all the positions with the kings match
+	if (query.starts_with("K[") and query.find('[', 1) == query.npos) {
+		cpb::query_result all;
+		all.build(db, cpb::querier{});
+		size_t n = 0;
+		for (size_t k = 0; k < all.size(); ++k) {
+			n += belongs(all.seek(k), *Q.kings);
+		}
+		CHECK_EQ(without.size(), n);
+		CHECK_EQ(index.kings.find(db)->count(*Q.kings), n);
+	}
+
+	REQUIRE(with.size() == without.size());
+	REQUIRE(summarized.size() == without.size());
+	for (size_t k = 0; k < with.size(); ++k) {
+		CHECK(with.seek(k) == without.seek(k));
+		CHECK(summarized.seek(k) == without.seek(k));
+		CHECK(belongs(with.seek(k), *Q.kings));
+	}
+}
+
+TEST_CASE("king placements")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	SUBCASE("parse")
+	{
+		const auto K = cpb::parse_king_query("w:g1,h1;b:8;");
+		REQUIRE(K.has_value());
+		CHECK_EQ(K->white, (uint64_t{1} << 6) | (uint64_t{1} << 7));
+		CHECK_EQ(K->black, uint64_t{0xff} << 56);
+		CHECK_EQ(cpb::to_string(*K), "w:g1,h1;b:8;");
+
+		// ranks first, then files, then squares
+		CHECK_EQ(cpb::to_string(*cpb::parse_king_query("w:h,1;")), "w:1,h;");
+		CHECK_EQ(
+			cpb::to_string(
+				*cpb::parse_king_query("w:a1,b1,c1,d1,e1,f1,g1,h1;")
+			),
+			"w:1;"
+		);
+		CHECK_EQ(cpb::to_string(*cpb::parse_king_query("b:e4,e;")), "b:e;");
+		CHECK_EQ(
+			cpb::to_string(*cpb::parse_king_query("w:1,2,3,4,5,6,7,8;")), ""
+		);
+		CHECK_EQ(cpb::to_string(*cpb::parse_king_query("")), "");
+
+		CHECK_FALSE(cpb::parse_king_query("w:g1").has_value());
+		CHECK_FALSE(cpb::parse_king_query("x:g1;").has_value());
+		CHECK_FALSE(cpb::parse_king_query("w:i1;").has_value());
+		CHECK_FALSE(cpb::parse_king_query("w:9;").has_value());
+		CHECK_FALSE(cpb::parse_king_query("w:;").has_value());
+		CHECK_FALSE(cpb::parse_king_query("w:g1,;").has_value());
+
+		cpb::querier Q;
+		CHECK(cpb::parse_query("K[b:h,8;w:g1;]M[w]", Q));
+		CHECK_EQ(cpb::make_query_key(Q), "M[w]K[w:g1;b:8,h;]");
+		CHECK(cpb::parse_query("M[w]", Q));
+		CHECK_FALSE(Q.kings.has_value());
+		CHECK_FALSE(cpb::parse_query("K[w:g1]", Q));
+	}
+
+	SUBCASE("placements")
+	{
+		cpb::position p;
+		std::fill(std::begin(p.pieces), std::end(p.pieces), cpb::EMPTY);
+		p["g1"] = cpb::WHITE_KING;
+
+		CHECK_FALSE(cpb::make_king_placement(p).complete());
+		CHECK_FALSE(cpb::king_query{}.matches(cpb::make_king_placement(p)));
+
+		p["e8"] = cpb::BLACK_KING;
+		const cpb::king_placement k = cpb::make_king_placement(p);
+		REQUIRE(k.complete());
+		CHECK_EQ(k.white, 6);
+		CHECK_EQ(k.black, 60);
+		CHECK_EQ(k.id(), 6 * 64 + 60);
+
+		CHECK(cpb::king_query{}.matches(k));
+		CHECK(cpb::parse_king_query("w:1;b:e;")->matches(k));
+		CHECK_FALSE(cpb::parse_king_query("w:2;")->matches(k));
+		CHECK_FALSE(cpb::parse_king_query("b:d8,f8;")->matches(k));
+	}
+
+	SUBCASE("queries")
+	{
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db);
+		REQUIRE(loaded.has_value());
+
+		// the table is only built when enabled
+		cpb::database_index index;
+		index.add(db);
+		CHECK(index.kings.find(db) == nullptr);
+		index.kings.enable(true);
+		index.add(db);
+		REQUIRE(index.kings.find(db) != nullptr);
+
+		// the leaves are skipped with their summaries only
+		cpb::database_index summaries;
+		summaries.summaries.add(db);
+
+		// the kings of some positions of the database
+		cpb::query_result all;
+		all.build(db, cpb::querier{});
+		REQUIRE(all.size() > 0);
+		for (size_t k = 0; k < all.size(); k += 7) {
+			const cpb::king_placement K = cpb::make_king_placement(all.seek(k));
+			REQUIRE(K.complete());
+			const std::string white = square_name(K.white);
+			const std::string black = square_name(K.black);
+			check_query(
+				db, index, summaries, "K[w:" + white + ";b:" + black + ";]"
+			);
+			check_query(db, index, summaries, "K[w:" + white + ";]M[b]");
+			check_query(db, index, summaries, "K[b:" + black + ";]E[KR*vKR*]");
+		}
+
+		check_query(db, index, summaries, "K[]");
+		check_query(db, index, summaries, "K[w:1;]");
+		check_query(db, index, summaries, "K[b:8;]");
+		check_query(db, index, summaries, "K[w:e,d;b:1,2;]");
+		check_query(db, index, summaries, "K[w:1;]E[KR*vKR*]");
+		check_query(db, index, summaries, "K[w:1,2,3,4;]E[KRPvKR]");
+		check_query(db, index, summaries, "K[b:h8;]E[KQ*vKQ*]");
+		check_query(db, index, summaries, "K[w:1;]P[c:/h7]");
+		check_query(db, index, summaries, "K[w:g1;]S[g1:K;]");
+		check_query(db, index, summaries, "K[w:g1;]S[h1:K;]");
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
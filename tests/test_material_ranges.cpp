@@ -0,0 +1,153 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/material_ranges.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// Number of pieces of @e p other than the kings.
+[[nodiscard]] int total_pieces(const cpb::position& p)
+{
+	int total = 0;
+	for (const char c : p.pieces) {
+		total += c != '.' and c != 'K' and c != 'k';
+	}
+	return total;
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+
+	cpb::query_result without;
+	without.build(db, Q);
+	cpb::query_result with;
+	with.build(db, Q, {}, nullptr, &index);
+
+	REQUIRE(with.size() == without.size());
+	for (size_t k = 0; k < with.size(); ++k) {
+		CHECK(with.seek(k) == without.seek(k));
+		if (Q.query_total_pieces) {
+			const int total = total_pieces(with.seek(k));
+			CHECK(Q.query_total_pieces->lb <= total);
+			CHECK(total <= Q.query_total_pieces->ub);
+		}
+	}
+}
+
+TEST_CASE("material ranges")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	REQUIRE(loaded.has_value());
+
+	cpb::database_index index;
+	index.add(db);
+	CHECK(index.material.size() > 0);
+
+	SUBCASE("ranges of the first level")
+	{
+		const cpb::querier everything;
+		for (auto it = db.begin(); it != db.end(); ++it) {
+			const cpb::material_range *const r =
+				index.material.find(&it->second);
+			REQUIRE(r != nullptr);
+
+			int min = 100;
+			int max = 0;
+			cpb::query_evaluator ev(everything);
+			CHECK(ev.accept<0>(it->first));
+			auto f = [&](const cpb::position *const data, const size_t n)
+			{
+				for (size_t i = 0; i < n; ++i) {
+					min = std::min(min, total_pieces(data[i]));
+					max = std::max(max, total_pieces(data[i]));
+				}
+				return true;
+			};
+			CHECK(cpb::for_each_leaf<1>(it->second, ev, f));
+			CHECK_EQ(r->min, min);
+			CHECK_EQ(r->max, max);
+		}
+	}
+
+	SUBCASE("first level pruned")
+	{
+		cpb::querier Q;
+		REQUIRE(cpb::parse_query("T[T:28,30]", Q));
+
+		cpb::query_evaluator ev(Q, &index);
+		for (auto it = db.begin(); it != db.end(); ++it) {
+			const cpb::material_range *const r =
+				index.material.find(&it->second);
+			REQUIRE(r != nullptr);
+			CHECK_EQ(ev.accept_child<0>(it->first, it->second), r->max >= 28);
+		}
+	}
+
+	SUBCASE("queries")
+	{
+		check_query(db, index, "T[T:0,4]");
+		check_query(db, index, "T[T:10,14]");
+		check_query(db, index, "T[T:20,30]");
+		check_query(db, index, "T[T:28,30]");
+		check_query(db, index, "T[T:6,6]M[w]");
+		check_query(db, index, "T[T:8,16]q[w:1,1;]");
+		check_query(db, index, "T[T:5,12]p[t:2,6;]S[g1:K;]");
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,239 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+// cpb includes
+#include <cpb/pawn_structure.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// The pawns of @e p, as in @ref cpb::parse_pawn_query, without the mode.
+[[nodiscard]] std::string pawns_of(const cpb::position& p)
+{
+	std::string s;
+	for (const char pawn : {cpb::WHITE_PAWN, cpb::BLACK_PAWN}) {
+		if (pawn == cpb::BLACK_PAWN) {
+			s += '/';
+		}
+		bool first = true;
+		for (size_t i = 0; i < 64; ++i) {
+			if (p.pieces[i] != pawn) {
+				continue;
+			}
+			if (not first) {
+				s += ',';
+			}
+			s += static_cast<char>('a' + i % 8);
+			s += static_cast<char>('1' + i / 8);
+			first = false;
+		}
+	}
+	return s;
+}
+
+/// Does @e p have the pawns of @e P, checked square by square?
+[[nodiscard]] bool belongs(const cpb::position& p, const cpb::pawn_query& P)
+{
+	for (size_t i = 0; i < 64; ++i) {
+		const bool white = (P.pawns.white >> i) & 1;
+		const bool black = (P.pawns.black >> i) & 1;
+		if (white and p.pieces[i] != cpb::WHITE_PAWN) {
+			return false;
+		}
+		if (black and p.pieces[i] != cpb::BLACK_PAWN) {
+			return false;
+		}
+		if (P.mode == cpb::pawn_match::exact and not white and not black and
+			(p.pieces[i] == cpb::WHITE_PAWN or
+			 p.pieces[i] == cpb::BLACK_PAWN)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const cpb::database_index& summaries,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+	REQUIRE(Q.pawn_structure.has_value());
+
+	cpb::query_result without;
+	without.build(db, Q);
+	cpb::query_result with;
+	with.build(db, Q, {}, nullptr, &index);
+	cpb::query_result summarized;
+	summarized.build(db, Q, {}, nullptr, &summaries);
+
+	// without other constraints, all the positions with the pawns match
+	if (query.starts_with("P[") and query.find('[', 1) == query.npos) {
+		cpb::query_result all;
+		all.build(db, cpb::querier{});
+		size_t n = 0;
+		for (size_t k = 0; k < all.size(); ++k) {
+			n += belongs(all.seek(k), *Q.pawn_structure);
+		}
+		CHECK_EQ(without.size(), n);
+		CHECK_EQ(index.skeletons.find(db)->count(*Q.pawn_structure), n);
+	}
+
+	REQUIRE(with.size() == without.size());
+	REQUIRE(summarized.size() == without.size());
+	for (size_t k = 0; k < with.size(); ++k) {
+		CHECK(with.seek(k) == without.seek(k));
+		CHECK(summarized.seek(k) == without.seek(k));
+		CHECK(belongs(with.seek(k), *Q.pawn_structure));
+	}
+}
+
+TEST_CASE("pawn structures")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	SUBCASE("parse")
+	{
+		const auto P = cpb::parse_pawn_query("e:e3,d4/d5,e6");
+		REQUIRE(P.has_value());
+		CHECK(P->mode == cpb::pawn_match::exact);
+		CHECK_EQ(P->pawns.white, (uint64_t{1} << 20) | (uint64_t{1} << 27));
+		CHECK_EQ(P->pawns.black, (uint64_t{1} << 35) | (uint64_t{1} << 44));
+		CHECK_EQ(cpb::to_string(*P), "e:e3,d4/d5,e6");
+
+		// squares are written from a1 to h8
+		CHECK_EQ(
+			cpb::to_string(*cpb::parse_pawn_query("c:d4,e3/")), "c:e3,d4/"
+		);
+		CHECK_EQ(cpb::to_string(*cpb::parse_pawn_query("c:/")), "c:/");
+
+		CHECK_FALSE(cpb::parse_pawn_query("").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("x:d4/").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:d4").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:d4/d5/e6").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:d1/").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:/d8").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:i4/").has_value());
+		CHECK_FALSE(cpb::parse_pawn_query("e:d4/d4").has_value());
+
+		cpb::querier Q;
+		CHECK(cpb::parse_query("P[c:d4/d5]M[w]", Q));
+		CHECK_EQ(cpb::make_query_key(Q), "M[w]P[c:d4/d5]");
+		CHECK(cpb::parse_query("M[w]", Q));
+		CHECK_FALSE(Q.pawn_structure.has_value());
+		CHECK_FALSE(cpb::parse_query("P[d4/d5]", Q));
+	}
+
+	SUBCASE("skeletons")
+	{
+		cpb::position p;
+		std::fill(std::begin(p.pieces), std::end(p.pieces), cpb::EMPTY);
+		p["d4"] = cpb::WHITE_PAWN;
+		p["e3"] = cpb::WHITE_PAWN;
+		p["d5"] = cpb::BLACK_PAWN;
+		p["g1"] = cpb::WHITE_KING;
+
+		const cpb::pawn_skeleton s = cpb::make_pawn_skeleton(p);
+		CHECK_EQ(s.white, (uint64_t{1} << 20) | (uint64_t{1} << 27));
+		CHECK_EQ(s.black, uint64_t{1} << 35);
+
+		const auto exact = cpb::parse_pawn_query("e:d4,e3/d5");
+		const auto contains = cpb::parse_pawn_query("c:d4/d5");
+		const auto other = cpb::parse_pawn_query("c:d4/e6");
+		CHECK(exact->matches(s));
+		CHECK(contains->matches(s));
+		CHECK_FALSE(other->matches(s));
+		CHECK_FALSE(cpb::parse_pawn_query("e:d4/d5")->matches(s));
+		CHECK(contains->pawns.subset_of(s));
+		CHECK_FALSE(s.subset_of(contains->pawns));
+	}
+
+	SUBCASE("queries")
+	{
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db);
+		REQUIRE(loaded.has_value());
+
+		// the skeletons are only built when enabled
+		cpb::database_index index;
+		index.add(db);
+		CHECK(index.skeletons.find(db) == nullptr);
+		index.skeletons.enable(true);
+		index.add(db);
+		REQUIRE(index.skeletons.find(db) != nullptr);
+
+		// the leaves are skipped with their summaries only
+		cpb::database_index summaries;
+		summaries.summaries.add(db);
+
+		// the pawns of some positions of the database
+		cpb::query_result all;
+		all.build(db, cpb::querier{});
+		REQUIRE(all.size() > 0);
+		for (size_t k = 0; k < all.size(); k += 7) {
+			const std::string pawns = pawns_of(all.seek(k));
+			check_query(db, index, summaries, "P[e:" + pawns + "]");
+			check_query(db, index, summaries, "P[e:" + pawns + "]M[b]");
+		}
+
+		check_query(db, index, summaries, "P[c:/]");
+		check_query(db, index, summaries, "P[e:/]");
+		check_query(db, index, summaries, "P[c:d4/]");
+		check_query(db, index, summaries, "P[c:d4/d5]");
+		check_query(db, index, summaries, "P[c:f2,g2,h2/f7,g7,h7]");
+		check_query(db, index, summaries, "P[c:d4/]p[w:1,1;]");
+		check_query(db, index, summaries, "P[c:e4/e5]S[g1:K;]");
+		check_query(db, index, summaries, "P[c:a2/]E[KR*vKR*]");
+		check_query(db, index, summaries, "P[c:/h7]T[T:0,10]");
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,140 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <stop_token>
+#include <vector>
+
+// cpb includes
+#include <cpb/query_result.hpp>
+#include <cpb/query_batch.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+void check_batch(
+	const cpb::PuzzleDatabase& db, const std::vector<cpb::querier>& queries
+)
+{
+	cpb::query_batch batch(queries);
+	CHECK(batch.evaluate(db));
+	CHECK_EQ(batch.size(), queries.size());
+
+	for (std::size_t i = 0; i < queries.size(); ++i) {
+		cpb::query_result expected;
+		expected.build(db, queries[i]);
+
+		const cpb::query_result& res = batch.result(i);
+		CHECK_EQ(batch.count(i), expected.size());
+		CHECK_EQ(res.size(), expected.size());
+		for (std::size_t k = 0; k < res.size(); ++k) {
+			CHECK(res.seek(k) == expected.seek(k));
+		}
+	}
+}
+
+TEST_CASE("medium")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	SUBCASE("empty")
+	{
+		cpb::query_batch batch({});
+		CHECK(batch.evaluate(db));
+		CHECK_EQ(batch.size(), 0);
+	}
+	SUBCASE("one")
+	{
+		std::vector<cpb::querier> queries(1);
+		check_batch(db, queries);
+		cpb::query_batch batch(queries);
+		CHECK(batch.evaluate(db));
+		CHECK_EQ(batch.count(0), db.size());
+	}
+	SUBCASE("several")
+	{
+		std::vector<cpb::querier> queries(4);
+		queries[0].pawns.query_white = {.lb = 1, .ub = 3};
+		queries[1].query_total_pieces = {.lb = 4, .ub = 10};
+		queries[1].query_player_turn = cpb::TURN_BLACK;
+		queries[2].bishops.query_both = {.lb = 1, .ub = 2};
+		queries[2].queens.query_white = {.lb = 1, .ub = 1};
+		queries[3].rooks.query_white = {.lb = 5, .ub = 8};
+		check_batch(db, queries);
+	}
+	SUBCASE("many")
+	{
+		// more queries than bits in a word
+		std::vector<cpb::querier> queries;
+		for (int w = 0; w <= 8; ++w) {
+			for (int b = 0; b <= 8; ++b) {
+				cpb::querier& Q = queries.emplace_back();
+				Q.pawns.query_white = {.lb = w, .ub = 8};
+				Q.pawns.query_black = {.lb = 0, .ub = b};
+				if (b % 4 == 0) {
+					Q.query_player_turn = cpb::TURN_WHITE;
+				}
+				if (w % 3 == 0) {
+					Q.query_total_pieces = {.lb = 2, .ub = 12 + w};
+				}
+			}
+		}
+		CHECK_GT(queries.size(), 64);
+		check_batch(db, queries);
+	}
+	SUBCASE("stopped")
+	{
+		std::vector<cpb::querier> queries(3);
+		cpb::query_batch batch(queries);
+
+		std::stop_source source;
+		source.request_stop();
+		CHECK_FALSE(batch.evaluate(db, source.get_token()));
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			CHECK(batch.result(i).empty());
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
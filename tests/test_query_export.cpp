@@ -0,0 +1,245 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <stop_token>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// cpb includes
+#include <cpb/database_index.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/query_export.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/fen_parser.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+[[nodiscard]] std::string export_all(
+	const cpb::PuzzleDatabase& db,
+	const cpb::querier& Q,
+	const cpb::export_format format,
+	const cpb::export_options& options
+)
+{
+	std::string out;
+	const auto count = cpb::export_query(
+		db,
+		Q,
+		format,
+		[&](const std::string_view chunk)
+		{
+			out += chunk;
+			return true;
+		},
+		options
+	);
+	CHECK(count.has_value());
+	return out;
+}
+
+[[nodiscard]] std::vector<std::string> split_lines(const std::string& s)
+{
+	std::vector<std::string> lines;
+	size_t begin = 0;
+	while (begin < s.size()) {
+		const size_t end = s.find('\n', begin);
+		lines.push_back(s.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return lines;
+}
+
+void check_export(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	cpb::query_result res;
+	res.build(db, Q);
+
+	const std::string fen =
+		export_all(db, Q, cpb::export_format::fen, {.num_threads = 1});
+	const std::vector<std::string> lines = split_lines(fen);
+	CHECK_EQ(lines.size(), res.size());
+	for (std::size_t k = 0; k < std::min(lines.size(), res.size()); ++k) {
+		CHECK_EQ(lines[k], cpb::make_fen(res.seek(k)));
+	}
+
+	// the output does not depend on the threads nor on the chunks
+	const std::size_t chunk_sizes[] = {1, 100, 1 << 20};
+	for (std::size_t num_threads = 1; num_threads <= 4; num_threads *= 2) {
+		for (const std::size_t chunk_size : chunk_sizes) {
+			const cpb::export_options options{
+				.num_threads = num_threads, .chunk_size = chunk_size
+			};
+			CHECK_EQ(export_all(db, Q, cpb::export_format::fen, options), fen);
+		}
+	}
+}
+
+TEST_CASE("medium")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	SUBCASE("everything")
+	{
+		cpb::querier Q;
+		check_export(db, Q);
+	}
+	SUBCASE("pawns")
+	{
+		cpb::querier Q;
+		Q.pawns.query_white = {.lb = 1, .ub = 3};
+		Q.pawns.query_black = {.lb = 0, .ub = 4};
+		check_export(db, Q);
+	}
+	SUBCASE("nothing")
+	{
+		cpb::querier Q;
+		Q.rooks.query_white = {.lb = 5, .ub = 8};
+		check_export(db, Q);
+		CHECK(export_all(db, Q, cpb::export_format::fen, {}).empty());
+	}
+	SUBCASE("formats")
+	{
+		cpb::querier Q;
+		const std::vector<std::string> csv =
+			split_lines(export_all(db, Q, cpb::export_format::csv, {}));
+		CHECK_EQ(csv.size(), db.size() + 1);
+		CHECK_EQ(csv[0], "fen,board,turn");
+		CHECK_EQ(std::count(csv[1].begin(), csv[1].end(), ','), 2);
+
+		const std::vector<std::string> ndjson =
+			split_lines(export_all(db, Q, cpb::export_format::ndjson, {}));
+		CHECK_EQ(ndjson.size(), db.size());
+		for (const std::string& line : ndjson) {
+			CHECK(line.starts_with("{\"fen\":\""));
+			CHECK(line.ends_with("\"}"));
+		}
+
+		CHECK(cpb::parse_export_format("fen") == cpb::export_format::fen);
+		CHECK(cpb::parse_export_format("csv") == cpb::export_format::csv);
+		CHECK(
+			cpb::parse_export_format("ndjson") == cpb::export_format::ndjson
+		);
+		CHECK_FALSE(cpb::parse_export_format("xml"));
+	}
+	SUBCASE("stopped")
+	{
+		cpb::querier Q;
+		for (std::size_t num_threads = 1; num_threads <= 4; num_threads *= 4) {
+			const cpb::export_options options{
+				.num_threads = num_threads, .chunk_size = 100
+			};
+
+			std::size_t num_chunks = 0;
+			const auto count = cpb::export_query(
+				db,
+				Q,
+				cpb::export_format::fen,
+				[&](const std::string_view)
+				{
+					++num_chunks;
+					return false;
+				},
+				options
+			);
+			CHECK_FALSE(count.has_value());
+			CHECK_EQ(num_chunks, 1);
+
+			std::stop_source source;
+			source.request_stop();
+			const auto stopped = cpb::export_query(
+				db,
+				Q,
+				cpb::export_format::fen,
+				[](const std::string_view)
+				{
+					return true;
+				},
+				options,
+				source.get_token()
+			);
+			CHECK_FALSE(stopped.has_value());
+		}
+	}
+	SUBCASE("chunk size")
+	{
+		// a chunk of 64 bytes holds a single position, even when the runs
+		// of the index hold many
+		cpb::database_index index;
+		index.add(db);
+		for (const std::string_view query :
+			 {"E[K*vK*]", "E[KR*vKR*]", "E[KQ*vKQ*]", "E[KRR*vKRR*]"}) {
+			cpb::querier Q;
+			REQUIRE(cpb::parse_query(query, Q));
+			cpb::query_result res;
+			res.build(db, Q);
+
+			const cpb::export_options options{
+				.num_threads = 2, .chunk_size = 64, .index = &index
+			};
+			std::size_t count = 0;
+			const auto exported = cpb::export_query(
+				db,
+				Q,
+				cpb::export_format::fen,
+				[&](const std::string_view chunk)
+				{
+					const auto lines =
+						std::count(chunk.begin(), chunk.end(), '\n');
+					CHECK_EQ(lines, 1);
+					count += static_cast<std::size_t>(lines);
+					return true;
+				},
+				options
+			);
+			REQUIRE(exported.has_value());
+			CHECK_EQ(*exported, res.size());
+			CHECK_EQ(count, res.size());
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
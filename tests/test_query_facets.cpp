@@ -0,0 +1,237 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <stop_token>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// cpb includes
+#include <cpb/query_result.hpp>
+#include <cpb/query_facets.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+[[nodiscard]] std::size_t
+count(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	cpb::query_result res;
+	res.build(db, Q);
+	return res.size();
+}
+
+[[nodiscard]] std::size_t total(const cpb::facet& f)
+{
+	std::size_t t = 0;
+	for (const cpb::facet::bucket& b : f.buckets) {
+		t += b.count;
+	}
+	return t;
+}
+
+void set_exactly(cpb::query_data& q, const bool white, const int n)
+{
+	if (white) {
+		q.query_white = {.lb = n, .ub = n};
+	}
+	else {
+		q.query_black = {.lb = n, .ub = n};
+	}
+}
+
+void check_facets(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	const std::vector<cpb::facet_field> fields = {
+		cpb::facet_field::white_pawns,
+		cpb::facet_field::black_rooks,
+		cpb::facet_field::white_queens,
+		cpb::facet_field::turn,
+		cpb::facet_field::material
+	};
+
+	const auto facets = cpb::compute_facets(db, Q, fields);
+	CHECK(facets.has_value());
+	CHECK_EQ(facets->size(), fields.size());
+
+	const std::size_t n = count(db, Q);
+	for (const cpb::facet& f : *facets) {
+		CHECK_EQ(total(f), n);
+	}
+
+	// every bucket counts the positions with that value
+	const auto check_level =
+		[&](const cpb::facet& f, auto&& restrict_query)
+	{
+		for (const cpb::facet::bucket& b : f.buckets) {
+			cpb::querier R = Q;
+			restrict_query(R, b.key);
+			CHECK_EQ(count(db, R), b.count);
+		}
+	};
+	check_level(
+		(*facets)[0],
+		[](cpb::querier& R, const std::string& key)
+		{
+			set_exactly(R.pawns, true, std::stoi(key));
+		}
+	);
+	check_level(
+		(*facets)[1],
+		[](cpb::querier& R, const std::string& key)
+		{
+			set_exactly(R.rooks, false, std::stoi(key));
+		}
+	);
+	check_level(
+		(*facets)[2],
+		[](cpb::querier& R, const std::string& key)
+		{
+			set_exactly(R.queens, true, std::stoi(key));
+		}
+	);
+	check_level(
+		(*facets)[3],
+		[](cpb::querier& R, const std::string& key)
+		{
+			R.query_player_turn =
+				key == "w" ? cpb::TURN_WHITE : cpb::TURN_BLACK;
+		}
+	);
+	check_level(
+		(*facets)[4],
+		[](cpb::querier& R, const std::string& key)
+		{
+			const std::size_t v = key.find('v');
+			for (const bool white : {true, false}) {
+				const std::string side =
+					white ? key.substr(0, v) : key.substr(v + 1);
+				const auto num = [&](const char c)
+				{
+					return static_cast<int>(
+						std::count(side.begin(), side.end(), c)
+					);
+				};
+				set_exactly(R.pawns, white, num('P'));
+				set_exactly(R.rooks, white, num('R'));
+				set_exactly(R.knights, white, num('N'));
+				set_exactly(R.bishops, white, num('B'));
+				set_exactly(R.queens, white, num('Q'));
+			}
+		}
+	);
+
+	// the material is sorted by decreasing count
+	const auto& material = (*facets)[4].buckets;
+	CHECK(std::is_sorted(
+		material.begin(),
+		material.end(),
+		[](const cpb::facet::bucket& a, const cpb::facet::bucket& b)
+		{
+			return a.count > b.count;
+		}
+	));
+
+	// the threads do not change the counts
+	for (std::size_t num_threads = 2; num_threads <= 8; num_threads *= 2) {
+		const auto parallel = cpb::compute_facets(db, Q, fields, num_threads);
+		CHECK(parallel.has_value());
+		for (std::size_t i = 0; i < fields.size(); ++i) {
+			const auto& a = (*facets)[i].buckets;
+			const auto& b = (*parallel)[i].buckets;
+			CHECK_EQ(a.size(), b.size());
+			for (std::size_t k = 0; k < std::min(a.size(), b.size()); ++k) {
+				CHECK_EQ(a[k].key, b[k].key);
+				CHECK_EQ(a[k].count, b[k].count);
+			}
+		}
+	}
+}
+
+TEST_CASE("medium")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	SUBCASE("everything")
+	{
+		cpb::querier Q;
+		check_facets(db, Q);
+	}
+	SUBCASE("pawns")
+	{
+		cpb::querier Q;
+		Q.pawns.query_white = {.lb = 1, .ub = 3};
+		Q.pawns.query_black = {.lb = 0, .ub = 4};
+		check_facets(db, Q);
+	}
+	SUBCASE("nothing")
+	{
+		cpb::querier Q;
+		Q.rooks.query_white = {.lb = 5, .ub = 8};
+		check_facets(db, Q);
+	}
+	SUBCASE("names")
+	{
+		for (std::uint8_t i = 0; i <= 11; ++i) {
+			const auto field = static_cast<cpb::facet_field>(i);
+			CHECK(cpb::parse_facet_field(cpb::name_of(field)) == field);
+		}
+		CHECK_FALSE(cpb::parse_facet_field("kings"));
+	}
+	SUBCASE("stopped")
+	{
+		cpb::querier Q;
+		const cpb::facet_field fields[] = {cpb::facet_field::material};
+		std::stop_source source;
+		source.request_stop();
+		CHECK_FALSE(
+			cpb::compute_facets(db, Q, fields, 2, source.get_token())
+				.has_value()
+		);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,132 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string>
+
+// cpb includes
+#include <cpb/query_parser.hpp>
+#include <cpb/position.hpp>
+#include <cpb/query.hpp>
+
+TEST_CASE("parse")
+{
+	SUBCASE("empty")
+	{
+		cpb::querier Q;
+		CHECK(cpb::parse_query("", Q));
+		CHECK_FALSE(Q.pawns.query_white);
+		CHECK_FALSE(Q.query_total_pieces);
+		CHECK_FALSE(Q.query_player_turn);
+		CHECK_EQ(cpb::make_query_key(Q), "");
+	}
+	SUBCASE("pieces")
+	{
+		cpb::querier Q;
+		CHECK(cpb::parse_query("p[w:1,3;b:0,4;]q[t:1,2;]", Q));
+		CHECK(Q.pawns.query_white);
+		CHECK_EQ(Q.pawns.query_white->lb, 1);
+		CHECK_EQ(Q.pawns.query_white->ub, 3);
+		CHECK(Q.pawns.query_black);
+		CHECK_EQ(Q.pawns.query_black->lb, 0);
+		CHECK_EQ(Q.pawns.query_black->ub, 4);
+		CHECK_FALSE(Q.pawns.query_both);
+		CHECK(Q.queens.query_both);
+		CHECK_EQ(Q.queens.query_both->lb, 1);
+		CHECK_EQ(Q.queens.query_both->ub, 2);
+		CHECK_FALSE(Q.rooks.query_white);
+	}
+	SUBCASE("total and turn")
+	{
+		cpb::querier Q;
+		CHECK(cpb::parse_query("T[T:4,10]M[b]", Q));
+		CHECK(Q.query_total_pieces);
+		CHECK_EQ(Q.query_total_pieces->lb, 4);
+		CHECK_EQ(Q.query_total_pieces->ub, 10);
+		CHECK(Q.query_player_turn);
+		CHECK_EQ(*Q.query_player_turn, cpb::TURN_BLACK);
+	}
+	SUBCASE("previous fields are reset")
+	{
+		cpb::querier Q;
+		CHECK(cpb::parse_query("r[w:1,1;]", Q));
+		CHECK(cpb::parse_query("M[w]", Q));
+		CHECK_FALSE(Q.rooks.query_white);
+		CHECK(Q.query_player_turn);
+	}
+	SUBCASE("invalid")
+	{
+		cpb::querier Q;
+		CHECK_FALSE(cpb::parse_query("x[w:1,1;]", Q));
+		CHECK_FALSE(cpb::parse_query("p[w:1;]", Q));
+		CHECK_FALSE(cpb::parse_query("p[w:a,1;]", Q));
+		CHECK_FALSE(cpb::parse_query("M[x]", Q));
+		CHECK_FALSE(cpb::parse_query("T[x:1,2]", Q));
+		CHECK_FALSE(cpb::parse_query("p[x:1,2;]", Q));
+		CHECK_FALSE(cpb::parse_query("p[w:1,2;b:0,1]", Q));
+		CHECK_FALSE(cpb::parse_query("S[g1:K;e4:.]", Q));
+	}
+}
+
+TEST_CASE("key")
+{
+	SUBCASE("fixed order")
+	{
+		cpb::querier Q1;
+		CHECK(cpb::parse_query("M[w]q[b:0,1;]p[t:2,5;w:1,3;]", Q1));
+		cpb::querier Q2;
+		CHECK(cpb::parse_query("p[w:1,3;t:2,5;]q[b:0,1;]M[w]", Q2));
+		CHECK_EQ(cpb::make_query_key(Q1), cpb::make_query_key(Q2));
+		CHECK_EQ(cpb::make_query_key(Q1), "p[w:1,3;t:2,5;]q[b:0,1;]M[w]");
+	}
+	SUBCASE("round trip")
+	{
+		cpb::querier Q1;
+		CHECK(cpb::parse_query("k[w:0,2;]b[b:1,1;]T[T:3,12]M[b]", Q1));
+		const std::string key = cpb::make_query_key(Q1);
+
+		cpb::querier Q2;
+		CHECK(cpb::parse_query(key, Q2));
+		CHECK_EQ(cpb::make_query_key(Q2), key);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,299 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <algorithm>
+#include <vector>
+
+// cpb includes
+#include <cpb/query_planner.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/index_layouts.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/fen_parser.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// The addresses of the positions visited by a traversal, sorted.
+struct visited {
+	std::vector<const cpb::position *> positions;
+
+	bool operator() (const cpb::position *const data, const size_t n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			positions.push_back(data + i);
+		}
+		return true;
+	}
+
+	[[nodiscard]] std::vector<const cpb::position *> sorted() const
+	{
+		std::vector<const cpb::position *> v = positions;
+		std::sort(v.begin(), v.end());
+		return v;
+	}
+};
+
+/// Adds the position @e fen to @e db, with the default square levels.
+void add_fen(cpb::PuzzleDatabase& db, const std::string_view fen)
+{
+	auto parsed = cpb::parse_fen(fen);
+	REQUIRE(parsed.has_value());
+	cpb::position& p = parsed->first;
+	const cpb::position_info& info = parsed->second;
+	const cpb::square_levels levels;
+	const char turn = p.player_turn;
+	const char square_1 = p.pieces[levels.squares[0]];
+	const char square_2 = p.pieces[levels.squares[1]];
+	const char square_3 = p.pieces[levels.squares[2]];
+	const char square_4 = p.pieces[levels.squares[3]];
+	const char square_5 = p.pieces[levels.squares[4]];
+	db.add(
+		std::move(p),
+		info.n_white_pawns,
+		info.n_black_pawns,
+		info.n_white_rooks,
+		info.n_black_rooks,
+		info.n_white_knights,
+		info.n_black_knights,
+		info.n_white_bishops,
+		info.n_black_bishops,
+		info.n_white_queens,
+		info.n_black_queens,
+		turn,
+		square_1,
+		square_2,
+		square_3,
+		square_4,
+		square_5
+	);
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+
+	visited expected;
+	{
+		cpb::query_evaluator ev(Q, &index);
+		CHECK(cpb::for_each_leaf(db, ev, expected));
+	}
+
+	const cpb::database_layouts *const layouts = index.layouts.find(db);
+	REQUIRE(layouts != nullptr);
+
+	std::array<char, cpb::NUM_COUNT_LEVELS> counts{};
+	{
+		visited v;
+		cpb::query_evaluator ev(Q, &index);
+		CHECK(cpb::for_each_layout_leaf(
+			layouts->queens_first,
+			cpb::QUEENS_FIRST_FIELDS,
+			Q,
+			ev,
+			counts,
+			0,
+			v
+		));
+		CHECK(v.sorted() == expected.sorted());
+	}
+	{
+		visited v;
+		cpb::query_evaluator ev(Q, &index);
+		CHECK(cpb::for_each_layout_leaf(
+			layouts->material_first,
+			cpb::MATERIAL_FIRST_FIELDS,
+			Q,
+			ev,
+			counts,
+			0,
+			v
+		));
+		CHECK(v.sorted() == expected.sorted());
+	}
+	{
+		visited v;
+		CHECK(cpb::for_each_planned_leaf(db, Q, &index, v));
+		CHECK(v.sorted() == expected.sorted());
+	}
+
+	cpb::query_result result;
+	result.build(db, Q, {}, nullptr, &index);
+	CHECK_EQ(result.size(), expected.positions.size());
+}
+
+TEST_CASE("query planner")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	REQUIRE(loaded.has_value());
+
+	SUBCASE("parse")
+	{
+		const auto layouts =
+			cpb::parse_index_layouts("queens-first,material-first");
+		REQUIRE(layouts.has_value());
+		REQUIRE(layouts->size() == 2);
+		CHECK((*layouts)[0] == cpb::index_layout::queens_first);
+		CHECK((*layouts)[1] == cpb::index_layout::material_first);
+
+		CHECK_FALSE(cpb::parse_index_layouts("queens").has_value());
+		CHECK_FALSE(cpb::parse_index_layouts("").has_value());
+		CHECK_FALSE(cpb::parse_index_layouts("queens-first,").has_value());
+	}
+
+	SUBCASE("disabled")
+	{
+		cpb::database_index index;
+		index.add(db);
+		CHECK(index.layouts.find(db) == nullptr);
+
+		cpb::querier Q;
+		REQUIRE(cpb::parse_query("q[w:1,1;]T[T:2,6]", Q));
+		CHECK(cpb::plan_query(Q, nullptr).layout ==
+			  cpb::index_layout::pieces_first);
+	}
+
+	SUBCASE("layouts")
+	{
+		cpb::database_index index;
+		index.layouts.enable(
+			{cpb::index_layout::queens_first,
+			 cpb::index_layout::material_first}
+		);
+		index.add(db);
+
+		const cpb::database_layouts *const layouts = index.layouts.find(db);
+		REQUIRE(layouts != nullptr);
+		for (const cpb::layout_statistics& stats : layouts->statistics) {
+			CHECK_EQ(stats.num_positions, db.size());
+			CHECK_EQ(stats.nodes[0], 1);
+			CHECK(stats.nodes[stats.num_levels] <= stats.num_leaves);
+		}
+
+		check_query(db, index, "");
+		check_query(db, index, "q[w:1,1;b:1,1;]");
+		check_query(db, index, "q[t:0,0;]T[T:2,6]");
+		check_query(db, index, "T[T:10,14]M[w]");
+		check_query(db, index, "r[w:1,2;b:0,1;]q[w:1,1;]");
+		check_query(db, index, "p[w:5,8;t:8,12;]S[h2:P;g1:K;]");
+		check_query(db, index, "b[t:2,2;]k[w:1,1;]M[b]");
+		check_query(db, index, "S[e1:K;]");
+		check_query(db, index, "q[w:3,3;]");
+	}
+
+	SUBCASE("plan")
+	{
+		cpb::database_index index;
+		index.layouts.enable({cpb::index_layout::material_first});
+		index.add(db);
+		const cpb::database_layouts *const layouts = index.layouts.find(db);
+		REQUIRE(layouts != nullptr);
+
+		// nothing to prune: the database itself is used
+		cpb::querier everything;
+		CHECK(cpb::plan_query(everything, layouts).layout ==
+			  cpb::index_layout::pieces_first);
+
+		// only the total number of pieces is constrained
+		cpb::querier Q;
+		REQUIRE(cpb::parse_query("T[T:30,30]", Q));
+		const cpb::query_plan plan = cpb::plan_query(Q, layouts);
+		CHECK(plan.layout == cpb::index_layout::material_first);
+		CHECK(plan.cost < cpb::estimate_cost(
+							  Q,
+							  layouts->statistics[0],
+							  cpb::PIECES_FIRST_FIELDS
+						  ));
+	}
+
+	SUBCASE("same count path")
+	{
+		// two leaves that differ only in the content of a8
+		cpb::PuzzleDatabase small;
+		add_fen(small, "r6k/8/8/8/8/8/8/7K w - - 0 1");
+		add_fen(small, "7k/r7/8/8/8/8/8/7K w - - 0 1");
+		REQUIRE(small.size() == 2);
+
+		cpb::database_index index;
+		index.layouts.enable(
+			{cpb::index_layout::queens_first,
+			 cpb::index_layout::material_first}
+		);
+		index.add(small);
+
+		const cpb::database_layouts *const layouts =
+			index.layouts.find(small);
+		REQUIRE(layouts != nullptr);
+		for (const cpb::layout_statistics& stats : layouts->statistics) {
+			CHECK_EQ(stats.num_positions, 2);
+			CHECK_EQ(stats.num_leaves, 2);
+			// both leaves hang from the same path
+			for (size_t d = 0; d <= stats.num_levels; ++d) {
+				CHECK_EQ(stats.nodes[d], 1);
+			}
+		}
+
+		check_query(small, index, "");
+		check_query(small, index, "S[a8:r;]");
+		check_query(small, index, "r[b:1,1;]");
+	}
+
+	SUBCASE("stale layouts")
+	{
+		cpb::database_index index;
+		index.layouts.enable({cpb::index_layout::queens_first});
+		index.add(db);
+
+		cpb::PuzzleDatabase other;
+		CHECK(index.layouts.find(other) == nullptr);
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,336 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <stop_token>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ctree includes
+#include <ctree/range_iterator.hpp>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+[[nodiscard]] std::vector<cpb::position>
+iterate(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	cpb::query_evaluator ev(Q);
+
+	// clang-format off
+	auto it = db.get_const_range_iterator_begin(
+		[&](const char c) { return ev.accept<0>(c); },
+		[&](const char c) { return ev.accept<1>(c); },
+		[&](const char c) { return ev.accept<2>(c); },
+		[&](const char c) { return ev.accept<3>(c); },
+		[&](const char c) { return ev.accept<4>(c); },
+		[&](const char c) { return ev.accept<5>(c); },
+		[&](const char c) { return ev.accept<6>(c); },
+		[&](const char c) { return ev.accept<7>(c); },
+		[&](const char c) { return ev.accept<8>(c); },
+		[&](const char c) { return ev.accept<9>(c); },
+		[&](const char c) { return ev.accept<10>(c); },
+		[&](const char c) { return ev.accept<11>(c); },
+		[&](const char c) { return ev.accept<12>(c); },
+		[&](const char c) { return ev.accept<13>(c); },
+		[&](const char c) { return ev.accept<14>(c); },
+		[&](const char c) { return ev.accept<15>(c); }
+	);
+	// clang-format on
+
+	std::vector<cpb::position> v;
+	while (not it.end()) {
+		v.push_back(*it);
+		++it;
+	}
+	return v;
+}
+
+void check_query(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	const std::vector<cpb::position> expected = iterate(db, Q);
+
+	cpb::query_result res;
+	res.build(db, Q);
+
+	CHECK_EQ(res.size(), expected.size());
+	CHECK_EQ(res.empty(), expected.empty());
+
+	const cpb::position *first = cpb::find_first(db, Q);
+	CHECK_EQ(first == nullptr, expected.empty());
+	if (first != nullptr) {
+		CHECK(*first == expected[0]);
+	}
+	for (std::size_t k = 0; k < res.size(); ++k) {
+		CHECK(res.seek(k) == expected[k]);
+	}
+
+	// seeking backwards gives the same positions
+	for (std::size_t k = res.size(); k > 0; --k) {
+		CHECK(res.seek(k - 1) == expected[k - 1]);
+	}
+}
+
+TEST_CASE("medium")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	SUBCASE("everything")
+	{
+		cpb::querier Q;
+		check_query(db, Q);
+
+		cpb::query_result res;
+		res.build(db, Q);
+		CHECK_EQ(res.size(), db.size());
+	}
+	SUBCASE("pawns")
+	{
+		cpb::querier Q;
+		Q.pawns.query_white = {.lb = 1, .ub = 3};
+		Q.pawns.query_black = {.lb = 0, .ub = 4};
+		check_query(db, Q);
+	}
+	SUBCASE("total")
+	{
+		cpb::querier Q;
+		Q.query_total_pieces = {.lb = 4, .ub = 10};
+		Q.query_player_turn = cpb::TURN_BLACK;
+		check_query(db, Q);
+	}
+	SUBCASE("bishops and queens")
+	{
+		cpb::querier Q;
+		Q.bishops.query_both = {.lb = 1, .ub = 2};
+		Q.queens.query_white = {.lb = 1, .ub = 1};
+		check_query(db, Q);
+	}
+	SUBCASE("nothing")
+	{
+		cpb::querier Q;
+		Q.rooks.query_white = {.lb = 5, .ub = 8};
+		check_query(db, Q);
+
+		cpb::query_result res;
+		res.build(db, Q);
+		CHECK(res.empty());
+	}
+	SUBCASE("stopped")
+	{
+		cpb::querier Q;
+		cpb::query_result res;
+		CHECK(res.build(db, Q));
+		CHECK_EQ(res.size(), db.size());
+
+		std::stop_source source;
+		source.request_stop();
+		CHECK_FALSE(res.build(db, Q, source.get_token()));
+		CHECK(res.empty());
+		CHECK_EQ(cpb::find_first(db, Q, source.get_token()), nullptr);
+	}
+	SUBCASE("progress")
+	{
+		cpb::querier Q;
+		Q.pawns.query_white = {.lb = 1, .ub = 3};
+
+		std::atomic<std::size_t> num_found = 0;
+		cpb::query_result res;
+		CHECK(res.build(db, Q, {}, &num_found));
+		CHECK_EQ(num_found.load(), res.size());
+	}
+}
+
+TEST_CASE("chunks")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	std::vector<std::unique_ptr<cpb::PuzzleDatabase>> chunks;
+	std::size_t last_bytes_read = 0;
+	const auto loaded_chunks = cpb::lichess::load_database_chunked(
+		file,
+		30,
+		[&](std::unique_ptr<cpb::PuzzleDatabase> chunk,
+			const std::size_t bytes_read)
+		{
+			CHECK_GT(bytes_read, last_bytes_read);
+			last_bytes_read = bytes_read;
+			chunks.push_back(std::move(chunk));
+			return true;
+		}
+	);
+	CHECK(loaded_chunks.has_value());
+	CHECK_EQ(*loaded_chunks, *loaded);
+	CHECK_GT(chunks.size(), 1);
+
+	std::vector<const cpb::PuzzleDatabase *> parts;
+	for (const auto& chunk : chunks) {
+		parts.push_back(chunk.get());
+	}
+
+	const auto check_chunks = [&](const cpb::querier& Q)
+	{
+		std::vector<cpb::position> expected;
+		for (const cpb::PuzzleDatabase *part : parts) {
+			const std::vector<cpb::position> v = iterate(*part, Q);
+			expected.insert(expected.end(), v.begin(), v.end());
+		}
+
+		cpb::query_result res;
+		CHECK(res.build(parts, Q));
+		CHECK_EQ(res.size(), expected.size());
+		for (std::size_t k = 0; k < res.size(); ++k) {
+			CHECK(res.seek(k) == expected[k]);
+		}
+
+		const cpb::position *first = cpb::find_first(parts, Q);
+		CHECK_EQ(first == nullptr, expected.empty());
+		if (first != nullptr) {
+			CHECK(*first == expected[0]);
+		}
+	};
+
+	SUBCASE("everything")
+	{
+		cpb::querier Q;
+		check_chunks(Q);
+
+		// repeated positions are only removed within every chunk
+		cpb::query_result res;
+		res.build(parts, Q);
+		CHECK_GE(res.size(), db.size());
+	}
+	SUBCASE("pawns")
+	{
+		cpb::querier Q;
+		Q.pawns.query_white = {.lb = 1, .ub = 3};
+		Q.pawns.query_black = {.lb = 0, .ub = 4};
+		check_chunks(Q);
+	}
+	SUBCASE("nothing")
+	{
+		cpb::querier Q;
+		Q.rooks.query_white = {.lb = 5, .ub = 8};
+		check_chunks(Q);
+	}
+	SUBCASE("stopped")
+	{
+		std::size_t num_chunks = 0;
+		const auto stopped = cpb::lichess::load_database_chunked(
+			file,
+			30,
+			[&](std::unique_ptr<cpb::PuzzleDatabase>, const std::size_t)
+			{
+				++num_chunks;
+				return false;
+			}
+		);
+		CHECK(stopped.has_value());
+		CHECK_EQ(*stopped, 30);
+		CHECK_EQ(num_chunks, 1);
+	}
+}
+
+TEST_CASE("random")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	cpb::PuzzleDatabase db;
+	const auto loaded = cpb::lichess::load_database(file, db);
+	CHECK(loaded.has_value());
+
+	cpb::querier Q;
+	Q.pawns.query_both = {.lb = 2, .ub = 12};
+
+	cpb::query_result res;
+	res.build(db, Q);
+	REQUIRE(res.size() > 10);
+
+	std::mt19937_64 gen(1234);
+
+	SUBCASE("one")
+	{
+		for (std::size_t i = 0; i < 100; ++i) {
+			CHECK_LT(res.random_index(gen), res.size());
+		}
+	}
+	SUBCASE("without replacement")
+	{
+		for (std::size_t k = 0; k <= res.size(); ++k) {
+			const std::vector<std::size_t> indices =
+				res.random_indices(k, gen);
+
+			CHECK_EQ(indices.size(), k);
+			CHECK(std::is_sorted(indices.begin(), indices.end()));
+			CHECK(
+				std::adjacent_find(indices.begin(), indices.end()) ==
+				indices.end()
+			);
+			if (not indices.empty()) {
+				CHECK_LT(indices.back(), res.size());
+			}
+		}
+	}
+	SUBCASE("more than available")
+	{
+		const std::vector<std::size_t> indices =
+			res.random_indices(res.size() + 5, gen);
+		CHECK_EQ(indices.size(), res.size());
+		for (std::size_t k = 0; k < indices.size(); ++k) {
+			CHECK_EQ(indices[k], k);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
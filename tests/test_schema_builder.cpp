@@ -0,0 +1,131 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <sstream>
+
+// cpb includes
+#include <cpb/schema_builder.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+TEST_CASE("schema builder")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	SUBCASE("profile header")
+	{
+		const cpb::square_levels levels =
+			*cpb::parse_square_levels("g1,f7,e4,h2,g8");
+
+		std::stringstream ss;
+		cpb::write_profile_header(ss, levels);
+		ss << "1234\n";
+
+		const auto read = cpb::read_profile_header(ss);
+		REQUIRE(read.has_value());
+		CHECK(*read == levels);
+
+		size_t total_bytes = 0;
+		ss >> total_bytes;
+		CHECK_EQ(total_bytes, 1234);
+	}
+
+	SUBCASE("profile without header")
+	{
+		std::stringstream ss("1234\n");
+		const auto read = cpb::read_profile_header(ss);
+		REQUIRE(read.has_value());
+		CHECK(*read == cpb::square_levels{});
+
+		size_t total_bytes = 0;
+		ss >> total_bytes;
+		CHECK_EQ(total_bytes, 1234);
+	}
+
+	SUBCASE("invalid profile header")
+	{
+		std::stringstream ss("square-levels a1,a2\n1234\n");
+		CHECK_FALSE(cpb::read_profile_header(ss).has_value());
+	}
+
+	SUBCASE("empty sample")
+	{
+		cpb::PuzzleDatabase db;
+		CHECK(cpb::choose_square_levels(db) == cpb::square_levels{});
+	}
+
+	SUBCASE("chosen levels")
+	{
+		const auto levels = cpb::choose_square_levels(file, 100000);
+		REQUIRE(levels.has_value());
+
+		std::uint64_t seen = 0;
+		for (const uint8_t s : levels->squares) {
+			CHECK(s < 64);
+			CHECK_EQ(seen & (uint64_t{1} << s), 0);
+			seen |= uint64_t{1} << s;
+		}
+
+		// the whole file is the sample: the chosen levels cannot make the
+		// leaves larger than the default levels do
+		cpb::PuzzleDatabase by_default;
+		CHECK(cpb::lichess::load_database(file, by_default).has_value());
+		cpb::PuzzleDatabase chosen;
+		CHECK(cpb::lichess::load_database(file, chosen, *levels).has_value());
+		REQUIRE(by_default.size() == chosen.size());
+
+		const cpb::level_statistics d = cpb::measure_levels(by_default);
+		const cpb::level_statistics c = cpb::measure_levels(chosen);
+		CHECK(d.expected_leaf_size >= 1);
+		CHECK(c.expected_leaf_size >= 1);
+		CHECK(c.expected_leaf_size <= d.expected_leaf_size);
+	}
+
+	SUBCASE("missing file")
+	{
+		const auto levels = cpb::choose_square_levels("missing.csv", 1000);
+		REQUIRE(not levels.has_value());
+		CHECK(levels.error() == cpb::lichess::load_error::file_error);
+	}
+}
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
@@ -0,0 +1,222 @@
+/**
+ * Tests of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// doctest includes
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <doctest/doctest.h>
+
+// C++ includes
+#include <string_view>
+#include <vector>
+
+// ctree includes
+#include <ctree/range_iterator.hpp>
+
+// cpb includes
+#include <cpb/query_evaluator.hpp>
+#include <cpb/schema_builder.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/query_parser.hpp>
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/lichess.hpp>
+
+/// Filters the positions visited by a range iterator with the squares.
+[[nodiscard]] std::vector<cpb::position>
+brute_force(const cpb::PuzzleDatabase& db, const cpb::querier& Q)
+{
+	// the square levels are not used to prune the tree
+	cpb::querier without_squares = Q;
+	without_squares.squares.reset();
+	cpb::query_evaluator ev(without_squares);
+
+	// clang-format off
+	auto it = db.get_const_range_iterator_begin(
+		[&](const char c) { return ev.accept<0>(c); },
+		[&](const char c) { return ev.accept<1>(c); },
+		[&](const char c) { return ev.accept<2>(c); },
+		[&](const char c) { return ev.accept<3>(c); },
+		[&](const char c) { return ev.accept<4>(c); },
+		[&](const char c) { return ev.accept<5>(c); },
+		[&](const char c) { return ev.accept<6>(c); },
+		[&](const char c) { return ev.accept<7>(c); },
+		[&](const char c) { return ev.accept<8>(c); },
+		[&](const char c) { return ev.accept<9>(c); },
+		[&](const char c) { return ev.accept<10>(c); },
+		[&](const char c) { return ev.accept<11>(c); },
+		[&](const char c) { return ev.accept<12>(c); },
+		[&](const char c) { return ev.accept<13>(c); },
+		[&](const char c) { return ev.accept<14>(c); },
+		[&](const char c) { return ev.accept<15>(c); }
+	);
+	// clang-format on
+
+	std::vector<cpb::position> v;
+	while (not it.end()) {
+		if (Q.squares.matches(*it)) {
+			v.push_back(*it);
+		}
+		++it;
+	}
+	return v;
+}
+
+void check_query(
+	const cpb::PuzzleDatabase& db,
+	const cpb::database_index& index,
+	const std::string_view query
+)
+{
+	cpb::querier Q;
+	REQUIRE(cpb::parse_query(query, Q));
+
+	const std::vector<cpb::position> expected = brute_force(db, Q);
+
+	// without summaries
+	cpb::database_index levels_only;
+	levels_only.levels = index.levels;
+
+	cpb::query_result without;
+	without.build(db, Q, {}, nullptr, &levels_only);
+	cpb::query_result with;
+	with.build(db, Q, {}, nullptr, &index);
+
+	CHECK_EQ(without.size(), expected.size());
+	CHECK_EQ(with.size(), expected.size());
+	for (std::size_t k = 0; k < expected.size(); ++k) {
+		CHECK(without.seek(k) == expected[k]);
+		CHECK(with.seek(k) == expected[k]);
+	}
+
+	const cpb::position *first = cpb::find_first(db, Q, {}, &index);
+	CHECK_EQ(first == nullptr, expected.empty());
+	if (first != nullptr) {
+		CHECK(*first == expected[0]);
+	}
+}
+
+void check_queries(
+	const cpb::PuzzleDatabase& db, const cpb::database_index& index
+)
+{
+	check_query(db, index, "");
+	check_query(db, index, "S[g1:K;]");
+	check_query(db, index, "S[g8:k;f7:p;]");
+	check_query(db, index, "S[e4:.;]");
+	check_query(db, index, "S[a8:r;]");
+	check_query(db, index, "S[a8:.;b8:.;c8:.;d8:.;e8:.;]");
+	check_query(db, index, "S[e1:K;e8:k;]");
+	check_query(db, index, "S[e8:.;g1:K;f7:p;]");
+	check_query(db, index, "p[w:5,8;]S[h2:P;g1:K;]");
+	check_query(db, index, "S[a1:k;]");
+}
+
+TEST_CASE("squares")
+{
+	static const std::string_view file = "../../tests/lichess_medium.csv";
+
+	SUBCASE("parse")
+	{
+		cpb::querier Q;
+		CHECK(cpb::parse_query("S[g1:K;f7:p;e4:.;]", Q));
+		CHECK_EQ(cpb::make_query_key(Q), "S[g1:K;e4:.;f7:p;]");
+		CHECK_FALSE(cpb::parse_query("S[i1:K;]", Q));
+		CHECK_FALSE(cpb::parse_query("S[e4:x;]", Q));
+
+		// the last constraint on a square replaces the previous ones
+		CHECK(cpb::parse_query("S[e4:P;e4:p;]", Q));
+		CHECK_EQ(cpb::make_query_key(Q), "S[e4:p;]");
+	}
+
+	SUBCASE("parse square levels")
+	{
+		CHECK(cpb::parse_square_levels("a8,b8,c8,d8,e8") ==
+			  cpb::square_levels{});
+		const auto levels = cpb::parse_square_levels("g1,f7,e4,h2,g8");
+		REQUIRE(levels.has_value());
+		CHECK_EQ(cpb::to_string(*levels), "g1,f7,e4,h2,g8");
+
+		CHECK_FALSE(cpb::parse_square_levels("a8,b8,c8,d8").has_value());
+		CHECK_FALSE(cpb::parse_square_levels("a8,b8,c8,d8,e8,f8").has_value());
+		CHECK_FALSE(cpb::parse_square_levels("a8,b8,c8,d8,a8").has_value());
+		CHECK_FALSE(cpb::parse_square_levels("a8,b8,c8,d8,e9").has_value());
+	}
+
+	SUBCASE("default square levels")
+	{
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db);
+		CHECK(loaded.has_value());
+
+		cpb::database_index index;
+		index.add(db);
+		CHECK(index.summaries.size() > 0);
+
+		check_queries(db, index);
+	}
+
+	SUBCASE("other square levels")
+	{
+		cpb::database_index index;
+		index.levels = *cpb::parse_square_levels("g1,f7,e4,h2,g8");
+
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db, index.levels);
+		CHECK(loaded.has_value());
+		index.add(db);
+
+		check_queries(db, index);
+	}
+
+	SUBCASE("chosen square levels")
+	{
+		const auto levels = cpb::choose_square_levels(file, 100000);
+		REQUIRE(levels.has_value());
+
+		cpb::database_index index;
+		index.levels = *levels;
+
+		cpb::PuzzleDatabase db;
+		const auto loaded = cpb::lichess::load_database(file, db, index.levels);
+		CHECK(loaded.has_value());
+		index.add(db);
+
+		check_queries(db, index);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	doctest::Context context;
+	context.applyCommandLine(argc, argv);
+
+	const int res = context.run(); // run doctest
+
+	// important - query flags (and --exit) rely on the user doing this
+	if (context.shouldExit()) {
+		// propagate the result of the tests
+		return res;
+	}
+
+	return res;
+}
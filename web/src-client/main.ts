@@ -36,54 +36,79 @@ from '../src-client/query';
 
 let board: any = undefined;
 
-export async function previous(_event: any) {
-	const response = await fetch('/previous', {
-		method: 'GET',
-		headers: { 'Content-type': 'application/json; charset=UTF-8' }
-	});
+// number of positions requested to the server at a time
+const PAGE_SIZE = 64;
 
-	const data = await response.json();
-	if (data.position != "begin") {
-		const ori = data.position.includes(" w ") ? "white" : "black";
-		board.set({
-			fen: data.position,
-			orientation: ori
-		});
-		if (ori == "white") {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "visible";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "hidden";
-		}
-		else {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "hidden";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "visible";
-		}
+// time between two requests for the progress of a count, in milliseconds
+const PROGRESS_INTERVAL = 250;
+
+// identifier of the last query made, to ignore the answers to older ones
+let query_id = 0;
+
+// index (from 1) of the position shown and total number of positions
+let current = 0;
+let total = 0;
+
+// a page of positions of the current query, starting at 'page_from'
+let page_from = 0;
+let page: string[] = [];
+
+// shown after the counter while the database is still being loaded
+let loading_note = "";
+
+function show_position(fen_str: string) {
+	const ori = fen_str.includes(" w ") ? "white" : "black";
+	board.set({
+		fen: fen_str,
+		orientation: ori
+	});
+	if (ori == "white") {
+		(document.getElementById("white_square") as HTMLDivElement).style.visibility = "visible";
+		(document.getElementById("black_square") as HTMLDivElement).style.visibility = "hidden";
+	}
+	else {
+		(document.getElementById("white_square") as HTMLDivElement).style.visibility = "hidden";
+		(document.getElementById("black_square") as HTMLDivElement).style.visibility = "visible";
 	}
-	(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: ${data.current}/${data.total}`;
 }
 
-export async function next(_event: any) {
-	const response = await fetch('/next', {
+function show_counter() {
+	(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: ${current}/${total}${loading_note}`;
+}
+
+async function fetch_page(from: number) {
+	const response = await fetch(`/positions?from=${from}&count=${PAGE_SIZE}`, {
 		method: 'GET',
 		headers: { 'Content-type': 'application/json; charset=UTF-8' }
 	});
 
 	const data = await response.json();
-	if (data.position != "end") {
-		const ori = data.position.includes(" w ") ? "white" : "black";
-		board.set({
-			fen: data.position,
-			orientation: ori
-		});
-		if (ori == "white") {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "visible";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "hidden";
-		}
-		else {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "hidden";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "visible";
-		}
+	page_from = from;
+	page = data.positions.map((p: any) => p.position);
+}
+
+// shows the position at index 'index', fetching its page if needed
+async function go_to(index: number) {
+	if (index < page_from || index >= page_from + page.length) {
+		// center the page around the position when going backwards
+		const from = index < page_from ? Math.max(1, index - PAGE_SIZE + 1) : index;
+		await fetch_page(from);
+	}
+	current = index;
+	show_position(page[index - page_from]);
+	show_counter();
+}
+
+export async function previous(_event: any) {
+	if (current > 1) {
+		await go_to(current - 1);
+	}
+}
+
+export async function next(_event: any) {
+	if (current < total) {
+		await go_to(current + 1);
 	}
-	(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: ${data.current}/${data.total}`;
 }
 
 export async function query(_event: any) {
@@ -114,36 +139,75 @@ export async function query(_event: any) {
 		headers: { 'Content-type': 'application/json; charset=UTF-8' }
 	});
 
+	if (response.status == 503) {
+		(document.getElementById("counter") as HTMLLabelElement).innerHTML = "Server busy, try again later";
+		return;
+	}
+
 	const data = await response.json();
 
 	if (data['id'] != undefined) {
 		document.cookie = make_cookie_string("sessionid", data["id"], 1);
 	}
 
-	const fen_str = data.position;
-	if (fen_str != "end") {
-		const ori = fen_str.includes(" w ") ? "white" : "black";
-		board.set({
-			fen: fen_str,
-			orientation: ori
-		});
-		if (ori == "white") {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "visible";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "hidden";
-		}
-		else {
-			(document.getElementById("white_square") as HTMLDivElement).style.visibility = "hidden";
-			(document.getElementById("black_square") as HTMLDivElement).style.visibility = "visible";
-		}
+	++query_id;
+	current = 0;
+	total = 0;
+	page_from = 0;
+	page = [];
+	loading_note = data.partial ? ` (database loading ${data.loaded}%)` : "";
+	set_navigation(false);
+	if (data.position != "end") {
+		current = 1;
+		show_position(data.position);
 	}
 	//(document.getElementById("time") as HTMLLabelElement).innerHTML = `Time: ${data.time}`;
-	(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: 1/${data.count}`;
 
-	if (data.count > 0) {
-		let previous_button = document.getElementById("previous") as HTMLButtonElement;
-		previous_button.disabled = false;
-		let next_button = document.getElementById("next") as HTMLButtonElement;
-		next_button.disabled = false;
+	if (data.counting) {
+		// the first position is shown while the rest are counted
+		(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: ${current}/...${loading_note}`;
+		wait_for_count(query_id);
+		return;
+	}
+
+	total = Number(data.count);
+	show_counter();
+	set_navigation(total > 0);
+}
+
+function set_navigation(enabled: boolean) {
+	(document.getElementById("previous") as HTMLButtonElement).disabled = !enabled;
+	(document.getElementById("next") as HTMLButtonElement).disabled = !enabled;
+}
+
+// polls the server until the count of query 'id' is known
+async function wait_for_count(id: number) {
+	while (id == query_id) {
+		await new Promise(resolve => setTimeout(resolve, PROGRESS_INTERVAL));
+		if (id != query_id) {
+			return;
+		}
+
+		const response = await fetch('/progress', {
+			method: 'GET',
+			headers: { 'Content-type': 'application/json; charset=UTF-8' }
+		});
+		const data = await response.json();
+		if (id != query_id) {
+			return;
+		}
+
+		if (data.cancelled) {
+			(document.getElementById("counter") as HTMLLabelElement).innerHTML = "The query took too long";
+			return;
+		}
+		if (data.done) {
+			total = Number(data.count);
+			show_counter();
+			set_navigation(total > 0);
+			return;
+		}
+		(document.getElementById("counter") as HTMLLabelElement).innerHTML = `Counter: ${current}/${data.count}...${loading_note}`;
 	}
 }
 
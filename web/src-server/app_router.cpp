@@ -32,11 +32,23 @@
 
 void route_server(
 	httplib::Server& svr,
-	const cpb::PuzzleDatabase& db,
-	user_query_t& user_query
+	server_metrics& metrics,
+	const asset_cache& assets,
+	database_store& databases,
+	const database_sources& sources,
+	const std::string& admin_token,
+	session_store& user_query,
+	query_cache& cache,
+	query_pool& pool
 )
 {
-	route_server_files(svr);
-	route_server_database(svr, db, user_query);
-	route_server_controls(svr, user_query);
+	route_server_files(svr, assets);
+	route_server_database(svr, databases, user_query, cache, pool);
+	route_server_controls(svr, user_query, pool);
+	route_server_export(svr, databases, user_query, pool);
+	route_server_facets(svr, databases, user_query, pool);
+	route_server_metrics(
+		svr, metrics, assets, databases, user_query, cache, pool
+	);
+	route_server_admin(svr, databases, sources, metrics, cache, admin_token);
 }
@@ -31,18 +31,63 @@
 #include <cpb/query.hpp>
 
 // custom includes
+#include "src-server/database_store.hpp"
+#include "src-server/asset_cache.hpp"
+#include "src-server/query_cache.hpp"
+#include "src-server/metrics.hpp"
+#include "src-server/query_pool.hpp"
+#include "src-server/session_store.hpp"
 #include "src-server/query.hpp"
 
-void route_server_files(httplib::Server& svr);
+void route_server_files(httplib::Server& svr, const asset_cache& assets);
 void route_server_database(
 	httplib::Server& svr,
-	const cpb::PuzzleDatabase& db,
-	user_query_t& user_query
+	const database_store& databases,
+	session_store& user_query,
+	query_cache& cache,
+	query_pool& pool
+);
+void route_server_controls(
+	httplib::Server& svr, session_store& user_query, query_pool& pool
+);
+void route_server_export(
+	httplib::Server& svr,
+	const database_store& databases,
+	session_store& user_query,
+	query_pool& pool
+);
+void route_server_facets(
+	httplib::Server& svr,
+	const database_store& databases,
+	session_store& user_query,
+	query_pool& pool
+);
+void route_server_admin(
+	httplib::Server& svr,
+	database_store& databases,
+	const database_sources& sources,
+	server_metrics& metrics,
+	query_cache& cache,
+	const std::string& admin_token
+);
+void route_server_metrics(
+	httplib::Server& svr,
+	server_metrics& metrics,
+	const asset_cache& assets,
+	const database_store& databases,
+	const session_store& user_query,
+	const query_cache& cache,
+	const query_pool& pool
 );
-void route_server_controls(httplib::Server& svr, user_query_t& user_query);
 
 void route_server(
 	httplib::Server& svr,
-	const cpb::PuzzleDatabase& db,
-	user_query_t& user_query
+	server_metrics& metrics,
+	const asset_cache& assets,
+	database_store& databases,
+	const database_sources& sources,
+	const std::string& admin_token,
+	session_store& user_query,
+	query_cache& cache,
+	query_pool& pool
 );
@@ -0,0 +1,167 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <string_view>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// custom includes
+#include "src-server/database_store.hpp"
+#include "src-server/json_writer.hpp"
+#include "src-server/app_router.hpp"
+
+/**
+ * @brief Checks that @e req carries the administration token.
+ *
+ * The token is expected in the header 'Authorization: Bearer <token>'. Sets
+ * the status of @e res if it does not.
+ */
+[[nodiscard]] static bool is_admin(
+	const httplib::Request& req,
+	httplib::Response& res,
+	const std::string& admin_token
+)
+{
+	if (admin_token.empty()) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Administration is disabled.\n";
+		res.status = 403;
+		return false;
+	}
+
+	static constexpr std::string_view prefix = "Bearer ";
+	const std::string header = req.get_header_value("Authorization");
+	const std::string_view token =
+		std::string_view{header}.starts_with(prefix)
+			? std::string_view{header}.substr(prefix.size())
+			: std::string_view{};
+
+	// compare in constant time, so that the token cannot be guessed by time
+	bool equal = token.size() == admin_token.size();
+	for (size_t i = 0; i < admin_token.size(); ++i) {
+		const char c = i < token.size() ? token[i] : '\0';
+		equal &= c == admin_token[i];
+	}
+	if (not equal) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Invalid administration token.\n";
+		res.status = 401;
+		return false;
+	}
+	return true;
+}
+
+void route_server_admin(
+	httplib::Server& svr,
+	database_store& databases,
+	const database_sources& sources,
+	server_metrics& metrics,
+	query_cache& cache,
+	const std::string& admin_token
+)
+{
+	svr.Post(
+		"/admin/reload",
+		[&](const httplib::Request& req, httplib::Response& res)
+		{
+			if (not is_admin(req, res, admin_token)) {
+				return;
+			}
+
+			// the body may list new lichess files, one per line
+			database_sources new_sources = sources;
+			if (not req.body.empty()) {
+				// the memory profile describes the files it was written for
+				new_sources.files.clear();
+				new_sources.memory_profile.clear();
+				std::string_view body = req.body;
+				while (not body.empty()) {
+					const size_t end = body.find('\n');
+					std::string_view line = body.substr(0, end);
+					body = end == std::string_view::npos
+							   ? std::string_view{}
+							   : body.substr(end + 1);
+					if (not line.empty() and line.back() == '\r') {
+						line.remove_suffix(1);
+					}
+					if (not line.empty()) {
+						new_sources.files.emplace_back(
+							std::string{line}, cpb::database_format::lichess
+						);
+					}
+				}
+			}
+
+			const bool started = databases.reload(
+				std::move(new_sources),
+				metrics,
+				[&cache](const database_snapshot&)
+				{
+					// results of the old database are not useful anymore
+					cache.clear();
+				}
+			);
+			if (not started) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "A reload is already in progress.\n";
+				res.status = 409;
+				return;
+			}
+			res.status = 202;
+		}
+	);
+
+	svr.Get(
+		"/admin/status",
+		[&](const httplib::Request& req, httplib::Response& res)
+		{
+			if (not is_admin(req, res, admin_token)) {
+				return;
+			}
+
+			const std::shared_ptr<const database_snapshot> snapshot =
+				databases.current();
+
+			res.body.clear();
+			res.body += '{';
+			append_field(res.body, "version", snapshot->version);
+			res.body += ',';
+			append_field(res.body, "positions", snapshot->size());
+			res.body += ',';
+			append_field(res.body, "loaded", snapshot->loaded_percent);
+			res.body += ',';
+			append_field(res.body, "index_bytes", snapshot->index.num_bytes());
+			res.body += ",\"reloading\":";
+			res.body += databases.reloading() ? "true" : "false";
+			res.body += ",\"square_levels\":\"";
+			res.body += cpb::to_string(snapshot->index.levels);
+			res.body += "\"}";
+			res.status = 200;
+		}
+	);
+}
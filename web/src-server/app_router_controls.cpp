@@ -28,135 +28,463 @@
 #if defined DEBUG
 #include <cassert>
 #endif
+#include <string_view>
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <cstdint>
+#include <charconv>
+#include <memory>
+#include <ranges>
+#include <random>
 
 // cpb includes
 #include <cpb/fen_parser.hpp>
 
 // custom includes
+#include "src-server/session_store.hpp"
+#include "src-server/json_writer.hpp"
+#include "src-server/query_pool.hpp"
 #include "src-server/query.hpp"
 #include "src-server/cookies.hpp"
 
-void route_server_controls(httplib::Server& svr, user_query_t& user_query)
+[[nodiscard]] static std::optional<std::string>
+find_session_id(const httplib::Request& req, const std::string_view what)
+{
+	const std::string cookies = req.get_header_value("Cookie");
+	const cookie_map cs = parse_cookies_into_map(cookies);
+	const auto it = cs.find("sessionid");
+	if (it == cs.end()) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Token 'sessionid' not found in the cookie.\n";
+		std::cerr << "Cannot proceed with '" << what << "' position.\n";
+		return {};
+	}
+	return std::string{it->second};
+}
+
+[[nodiscard]] static std::optional<size_t>
+to_size_t(const std::string_view s) noexcept
+{
+	size_t v;
+	const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+	return ec == std::errc{} ? v : std::optional<size_t>{};
+}
+
+/// Maximum number of positions returned by a single page or sample.
+static constexpr size_t MAX_PAGE_SIZE = 256;
+
+/// The part of a session needed to answer a request, copied under the lock.
+struct session_view {
+	std::shared_ptr<const cpb::query_result> result;
+	size_t current;
+};
+
+static void make_position_response(
+	const session_view& q, const std::string_view marker, httplib::Response& res
+)
+{
+	res.body.clear();
+	res.body.reserve(cpb::MAX_FEN_LENGTH + 64);
+	res.body += '{';
+	if (marker.empty()) {
+		append_field(res.body, "position", q.result->seek(q.current - 1));
+	}
+	else {
+		append_field(res.body, "position", marker);
+	}
+	res.body += ',';
+	append_field(res.body, "current", q.current);
+	res.body += ',';
+	append_field(res.body, "total", q.result->size());
+	res.body += '}';
+	res.status = 200;
+}
+
+/// Writes the positions of @e result at @e indices into @e out.
+template <typename index_range_t>
+static void make_positions_list(
+	const cpb::query_result& result,
+	const index_range_t& indices,
+	std::string& out
+)
+{
+	out += "{\"positions\":[";
+	bool first = true;
+	for (const size_t k : indices) {
+		if (not first) {
+			out += ',';
+		}
+		first = false;
+		out += '{';
+		append_field(out, "index", k + 1);
+		out += ',';
+		append_field(out, "position", result.seek(k));
+		out += '}';
+	}
+	out += "],";
+	append_field(out, "total", result.size());
+	out += '}';
+}
+
+/**
+ * @brief Applies @e move to the session of the user that sent @e req.
+ *
+ * Function @e move is called under the lock of the session and returns
+ * whether or not the session moved to a new position. It is only called if
+ * the result of the session's query is available.
+ * @returns The session after the move, or nothing if it was not found or its
+ * result is not available. In that case, the status of @e res is set: 409
+ * while the query is being evaluated, and 503 for good if its evaluation was
+ * cancelled.
+ */
+template <typename function_t>
+[[nodiscard]] static std::optional<std::pair<session_view, bool>>
+move_session(
+	const httplib::Request& req,
+	httplib::Response& res,
+	session_store& user_query,
+	const std::string_view what,
+	function_t&& move
+)
+{
+	const std::optional<std::string> id = find_session_id(req, what);
+	if (not id) {
+		res.status = 400;
+		return {};
+	}
+
+	session_view view;
+	bool ready = false;
+	bool cancelled = false;
+	bool moved = false;
+	const bool found = user_query.with_session(
+		*id,
+		[&](web_query& q)
+		{
+			ready = q.ready();
+			if (not ready) {
+				cancelled = q.cancelled();
+				return;
+			}
+			moved = move(q);
+			view.result = q.result;
+			view.current = q.current;
+		}
+	);
+	if (not found) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "User with token does not exist.\n";
+		std::cerr << "Cannot proceed with '" << what << "' position.\n";
+		res.status = 400;
+		return {};
+	}
+	if (cancelled) {
+		// the result will never be available: the user has to query again
+		res.body = "{\"cancelled\":true}";
+		res.status = 503;
+		return {};
+	}
+	if (not ready) {
+		// the query is still being evaluated
+		res.status = 409;
+		return {};
+	}
+	return std::make_pair(std::move(view), moved);
+}
+
+void route_server_controls(
+	httplib::Server& svr, session_store& user_query, query_pool& pool
+)
 {
 	svr.Get(
-		"/next",
+		"/sessions",
+		[&user_query](const httplib::Request&, httplib::Response& res)
+		{
+			res.body = "{";
+			res.body += "\"sessions\":" + std::to_string(user_query.size());
+			res.body += ",\"max\":" + std::to_string(user_query.max_size());
+			res.body +=
+				",\"expired\":" + std::to_string(user_query.num_expired());
+			res.body +=
+				",\"evicted\":" + std::to_string(user_query.num_evicted());
+			res.body += "}";
+			res.status = 200;
+		}
+	);
+
+	svr.Get(
+		"/progress",
 		[&user_query](const httplib::Request& req, httplib::Response& res)
 		{
-			std::string id;
-
-			{
-				const std::string cookies = req.get_header_value("Cookie");
-				const cookie_map cs = parse_cookies_into_map(cookies);
-				const auto it = cs.find("sessionid");
-				if (it == cs.end()) {
-					std::cerr << __PRETTY_FUNCTION__ << '\n';
-					std::cerr << "Token 'sessionid' not found in the cookie.\n";
-					std::cerr << "Cannot proceed with 'next' position.\n";
-					res.status = 400;
-					return;
-				}
-				id = it->second;
+			const std::optional<std::string> id =
+				find_session_id(req, "progress");
+			if (not id) {
+				res.status = 400;
+				return;
 			}
 
-			auto it = user_query.find(id);
-			if (it == user_query.end()) {
+			size_t count = 0;
+			bool done = false;
+			bool cancelled = false;
+			const bool found = user_query.with_session(
+				*id,
+				[&](web_query& q)
+				{
+					if (q.ready()) {
+						count = q.result->size();
+						done = true;
+					}
+					else {
+						count = q.progress->num_found.load(
+							std::memory_order_relaxed
+						);
+						cancelled = q.cancelled();
+						done = cancelled;
+					}
+				}
+			);
+			if (not found) {
 				std::cerr << __PRETTY_FUNCTION__ << '\n';
 				std::cerr << "User with token does not exist.\n";
-				std::cerr << "Cannot proceed with 'next' position.\n";
 				res.status = 400;
 				return;
 			}
 
-			auto& db_it = it->second.it;
+			res.body.clear();
+			res.body += '{';
+			append_field(res.body, "count", count);
+			res.body += ",\"done\":";
+			res.body += done ? "true" : "false";
+			res.body += ",\"cancelled\":";
+			res.body += cancelled ? "true" : "false";
+			res.body += '}';
+			res.status = 200;
+		}
+	);
 
-			bool include_fen = false;
+	svr.Get(
+		"/next",
+		[&user_query](const httplib::Request& req, httplib::Response& res)
+		{
+			const auto view = move_session(
+				req,
+				res,
+				user_query,
+				"next",
+				[](web_query& q) -> bool
+				{
+					if (q.current < q.result->size()) {
+						++q.current;
+						return true;
+					}
+					return false;
+				}
+			);
+			if (not view) {
+				return;
+			}
+			make_position_response(view->first, view->second ? "" : "end", res);
+		}
+	);
 
-			if (not db_it.end()) {
-				++db_it;
-				if (db_it.end()) {
-					--db_it;
+	svr.Get(
+		"/previous",
+		[&user_query](const httplib::Request& req, httplib::Response& res)
+		{
+			const auto view = move_session(
+				req,
+				res,
+				user_query,
+				"previous",
+				[](web_query& q) -> bool
+				{
+					if (q.current > 1 and q.current <= q.result->size()) {
+						--q.current;
+						return true;
+					}
+					return false;
 				}
-				else {
-					++it->second.current;
-					include_fen = true;
+			);
+			if (not view) {
+				return;
+			}
+			make_position_response(
+				view->first, view->second ? "" : "begin", res
+			);
+		}
+	);
+
+	svr.Get(
+		"/goto",
+		[&user_query](const httplib::Request& req, httplib::Response& res)
+		{
+			// 'index' follows the same numbering as 'current': from 1 to
+			// the total number of positions.
+			const std::string index_str = req.get_param_value("index");
+			const std::optional<size_t> index = to_size_t(index_str);
+
+			const auto view = move_session(
+				req,
+				res,
+				user_query,
+				"goto",
+				[&](web_query& q) -> bool
+				{
+					if (not index or *index == 0 or
+						*index > q.result->size()) {
+						return false;
+					}
+					q.current = *index;
+					return true;
 				}
+			);
+			if (not view) {
+				return;
 			}
+			if (not view->second) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Invalid index '" << index_str << "'.\n";
+				res.status = 400;
+				return;
+			}
+			make_position_response(view->first, "", res);
+		}
+	);
 
-			res.body = "{";
-			if (include_fen) {
-				res.body +=
-					"\"position\":\"" + cpb::make_fen(*db_it) + "\",";
+	svr.Get(
+		"/positions",
+		[&user_query](const httplib::Request& req, httplib::Response& res)
+		{
+			// 'from' follows the same numbering as 'current': from 1 to
+			// the total number of positions.
+			const std::string from_str = req.get_param_value("from");
+			const std::string count_str = req.get_param_value("count");
+			const std::optional<size_t> from = to_size_t(from_str);
+			const std::optional<size_t> count = to_size_t(count_str);
+			if (not from or *from == 0 or not count) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Invalid page from '" << from_str << "' count '"
+						  << count_str << "'.\n";
+				res.status = 400;
+				return;
 			}
-			else {
-				res.body += "\"position\":\"end\",";
+
+			// the page does not move the session
+			const auto view = move_session(
+				req,
+				res,
+				user_query,
+				"positions",
+				[](web_query&) -> bool
+				{
+					return false;
+				}
+			);
+			if (not view) {
+				return;
 			}
-			res.body +=
-				"\"current\":\"" + std::to_string(it->second.current) + "\",";
-			res.body +=
-				"\"total\":\"" + std::to_string(it->second.total) + "\"";
-			res.body += "}";
+
+			const cpb::query_result& result = *view->first.result;
+			const size_t begin = std::min(*from - 1, result.size());
+			const size_t page_size =
+				std::min({*count, MAX_PAGE_SIZE, result.size() - begin});
+			const size_t end = begin + page_size;
+
+			res.body.clear();
+			res.body.reserve((end - begin) * (cpb::MAX_FEN_LENGTH + 32) + 64);
+			make_positions_list(result, std::views::iota(begin, end), res.body);
 			res.status = 200;
 		}
 	);
 
 	svr.Get(
-		"/previous",
-		[&user_query](const httplib::Request& req, httplib::Response& res)
+		"/random",
+		[&user_query,
+		 &pool](const httplib::Request& req, httplib::Response& res)
 		{
-			std::string id;
-
-			{
-				const std::string cookies = req.get_header_value("Cookie");
-				const cookie_map cs = parse_cookies_into_map(cookies);
-				const auto it = cs.find("sessionid");
-				if (it == cs.end()) {
-					std::cerr << __PRETTY_FUNCTION__ << '\n';
-					std::cerr << "Token 'sessionid' not found in the cookie.\n";
-					std::cerr << "Cannot proceed with 'previous' position.\n";
-					res.status = 400;
+			thread_local std::mt19937_64 gen(std::random_device{}());
+
+			// without 'count', move the session to a random position
+			if (not req.has_param("count")) {
+				const auto view = move_session(
+					req,
+					res,
+					user_query,
+					"random",
+					[](web_query& q) -> bool
+					{
+						if (q.result->empty()) {
+							return false;
+						}
+						q.current = q.result->random_index(gen) + 1;
+						return true;
+					}
+				);
+				if (not view) {
 					return;
 				}
-				id = it->second;
+				make_position_response(
+					view->first, view->second ? "" : "end", res
+				);
+				return;
 			}
 
-			auto it = user_query.find(id);
-			if (it == user_query.end()) {
+			// with 'count', return a sample without moving the session
+			const std::string count_str = req.get_param_value("count");
+			const std::optional<size_t> count = to_size_t(count_str);
+			if (not count) {
 				std::cerr << __PRETTY_FUNCTION__ << '\n';
-				std::cerr << "User with token does not exist.\n";
-				std::cerr << "Cannot proceed with 'previous' position.\n";
+				std::cerr << "Invalid count '" << count_str << "'.\n";
 				res.status = 400;
 				return;
 			}
 
-			auto& db_it = it->second.it;
-
-			bool include_fen = false;
-
-			if (not db_it.past_begin()) {
-				--db_it;
-				if (db_it.past_begin()) {
-					++db_it;
-				}
-				else {
-					--it->second.current;
-					include_fen = true;
+			const auto view = move_session(
+				req,
+				res,
+				user_query,
+				"random",
+				[](web_query&) -> bool
+				{
+					return false;
 				}
+			);
+			if (not view) {
+				return;
 			}
 
-			res.body = "{";
-			if (include_fen) {
-				res.body +=
-					"\"position\":\"" + cpb::make_fen(*db_it) + "\",";
-			}
-			else {
-				res.body += "\"position\":\"begin\",";
+			// sampling many positions is not cheap: do it in the pool, with
+			// a generator of its own since 'gen' is local to this thread
+			const cpb::query_result& result = *view->first.result;
+			const uint64_t seed = gen();
+			const query_status status = pool.run(
+				query_priority::interactive,
+				[&](std::stop_token stop)
+				{
+					std::mt19937_64 job_gen(seed);
+					const std::vector<size_t> indices =
+						result.random_indices(
+							std::min(*count, MAX_PAGE_SIZE), job_gen, stop
+						);
+					if (stop.stop_requested()) {
+						return;
+					}
+
+					res.body.clear();
+					res.body.reserve(
+						indices.size() * (cpb::MAX_FEN_LENGTH + 32) + 64
+					);
+					make_positions_list(result, indices, res.body);
+				}
+			);
+			if (status != query_status::completed) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Could not sample the positions in time.\n";
+				res.body.clear();
+				res.status = 503;
+				return;
 			}
-			res.body +=
-				"\"current\":\"" + std::to_string(it->second.current) + "\",";
-			res.body +=
-				"\"total\":\"" + std::to_string(it->second.total) + "\"";
-			res.body += "}";
 			res.status = 200;
 		}
 	);
@@ -25,120 +25,50 @@
 #include <httplib.h>
 
 // C++ includes
-#if defined DEBUG
-#include <cassert>
-#endif
+#include <iostream>
+#include <optional>
+#include <memory>
+#include <string>
 
 // cpb includes
+#include <cpb/query_result.hpp>
+#include <cpb/query_parser.hpp>
 #include <cpb/fen_parser.hpp>
 #include <cpb/database.hpp>
 #include <cpb/time.hpp>
 
 // custom includes
+#include "src-server/json_writer.hpp"
 #include "src-server/query.hpp"
 #include "src-server/app_router.hpp"
 #include "src-server/cookies.hpp"
 
-[[nodiscard]] static inline bool
-in_interval(const int l, const int v, const int u) noexcept
-{
-	return l <= v and v <= u;
-}
-
-[[nodiscard]] inline bool true_func(const char)
-{
-	return true;
-}
-
-auto make_empty_iterator(const cpb::PuzzleDatabase& db)
-{
-	return db.get_const_range_iterator(
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func
-	);
-}
-
-[[nodiscard]] bool white_inspect(
-	const cpb::querier& Q, const cpb::query_data& q, const int total_so_far
-)
-{
-	if (q.query_white) {
-		const bool cond =
-			in_interval(q.query_white->lb, q.num_white, q.query_white->ub);
-		if (not cond) {
-			return false;
-		}
-	}
+namespace {
 
-	const int both = q.num_white;
-	if (q.query_both) {
-		const bool cond = in_interval(0, both, q.query_both->ub);
-		if (not cond) {
-			return false;
-		}
-	}
+/**
+ * @brief Marks an evaluation as finished when destroyed.
+ *
+ * An evaluation that throws is then finished without a result, as if it
+ * had been cancelled, instead of being evaluated forever.
+ */
+struct finish_progress {
+	query_progress& progress;
 
-	if (Q.query_total_pieces) {
-		const bool cond =
-			in_interval(0, total_so_far, Q.query_total_pieces->ub);
-		if (not cond) {
-			return false;
-		}
+	~finish_progress()
+	{
+		progress.finished.store(true, std::memory_order_release);
 	}
-
-	return true;
 };
 
-[[nodiscard]] bool black_inspect(
-	const cpb::querier& Q, const cpb::query_data& q, const int total_so_far
-)
-{
-	if (q.query_black) {
-		const bool cond =
-			in_interval(q.query_black->lb, q.num_black, q.query_black->ub);
-		if (not cond) {
-			return false;
-		}
-	}
-
-	const int both = q.total();
-	if (q.query_both) {
-		const bool cond = in_interval(q.query_both->lb, both, q.query_both->ub);
-		if (not cond) {
-			return false;
-		}
-	}
-
-	if (Q.query_total_pieces) {
-		const bool cond =
-			in_interval(0, total_so_far, Q.query_total_pieces->ub);
-		if (not cond) {
-			return false;
-		}
-	}
-
-	return true;
-};
+} // namespace
 
 void make_query(
 	const httplib::Request& req,
 	httplib::Response& res,
-	const cpb::PuzzleDatabase& db,
-	user_query_t& user_query
+	const database_store& databases,
+	session_store& user_query,
+	query_cache& cache,
+	query_pool& pool
 )
 {
 	std::string id;
@@ -154,219 +84,176 @@ void make_query(
 		}
 	}
 
-	// with a cookie or not, try finding the id in the 'user_quer' object
-	auto query_it = user_query.find(id);
-
-	// if no valid id was found, make a new one
-	if (query_it == user_query.end()) {
-
-		const auto now = std::chrono::system_clock::now().time_since_epoch();
-		const auto now_ns =
-			std::chrono::duration_cast<std::chrono::nanoseconds>(now);
+	// parse body and find the first position, without holding any lock
 
-		// TODO: think about shuffling this?
-		// TODO: create an actual UUID
-		id = std::to_string(now_ns.count());
-
-		const auto [it, success] = user_query.insert(
-			{id,
-			 web_query{
-				 .Q = cpb::querier(),
-				 .it = make_empty_iterator(db),
-				 .current = 0,
-				 .total = 0
-			 }}
-		);
-#if defined DEBUG
-		assert(success);
-#endif
-		query_it = it;
-		new_id_created = true;
+	cpb::querier Q;
+	if (not cpb::parse_query(req.body, Q)) {
+		std::cerr << __PRETTY_FUNCTION__ << '\n';
+		std::cerr << "Invalid query '" << req.body << "'.\n";
+		res.status = 400;
+		return;
 	}
 
-	// parse body and assign values to 'query_it->second.Q'
-
-	cpb::querier& Q_ = query_it->second.Q;
-	parse_query_body(req.body, Q_);
-
-	// create lambda functions that take a reference to 'query_it->second.Q'
+	// the snapshot is kept alive until the query is answered
+	const std::shared_ptr<const database_snapshot> snapshot =
+		databases.current();
 
-	// pawns
-
-	auto white_pawns = [&](const char c) -> bool
-	{
-		Q_.pawns.num_white = c;
-		return white_inspect(Q_, Q_.pawns, Q_.pawns.num_white);
-	};
-
-	auto black_pawns = [&](const char c) -> bool
-	{
-		Q_.pawns.num_black = c;
-		return black_inspect(Q_, Q_.pawns, Q_.pawns.total());
-	};
-
-	// rooks
-
-	auto white_rooks = [&](const char c) -> bool
-	{
-		Q_.rooks.num_white = c;
-		return white_inspect(
-			Q_, Q_.rooks, Q_.pawns.total() + Q_.rooks.num_white
-		);
-	};
-
-	auto black_rooks = [&](const char c) -> bool
-	{
-		Q_.rooks.num_black = c;
-		return black_inspect(Q_, Q_.rooks, Q_.pawns.total() + Q_.rooks.total());
-	};
-
-	// knights
-
-	auto white_knights = [&](const char c) -> bool
-	{
-		Q_.knights.num_white = c;
-		return white_inspect(
-			Q_,
-			Q_.knights,
-			Q_.pawns.total() + Q_.rooks.total() + Q_.knights.num_white
-		);
-	};
-
-	auto black_knights = [&](const char c) -> bool
-	{
-		Q_.knights.num_black = c;
-		return black_inspect(
-			Q_,
-			Q_.knights,
-			Q_.pawns.total() + Q_.rooks.total() + Q_.knights.total()
-		);
-	};
-
-	// bishops
-
-	auto white_bishops = [&](const char c) -> bool
-	{
-		Q_.bishops.num_white = c;
-		return white_inspect(
-			Q_,
-			Q_.bishops,
-			Q_.pawns.total() + Q_.rooks.total() + Q_.knights.total() +
-				Q_.bishops.num_white
-		);
-	};
-
-	auto black_bishops = [&](const char c) -> bool
-	{
-		Q_.bishops.num_black = c;
-		return black_inspect(
-			Q_,
-			Q_.bishops,
-			Q_.pawns.total() + Q_.rooks.total() + Q_.knights.total() +
-				Q_.bishops.total()
-		);
-	};
-
-	// queens
-
-	auto white_queens = [&](const char c) -> bool
-	{
-		Q_.queens.num_white = c;
-		return white_inspect(
-			Q_,
-			Q_.queens,
-			Q_.pawns.total() + Q_.rooks.total() + Q_.knights.total() +
-				Q_.bishops.total() + Q_.queens.num_white
+	const auto begin = cpb::now();
+	std::shared_ptr<const cpb::query_result> result_ptr =
+		cache.find(Q, snapshot->version);
+	const bool cache_hit = result_ptr != nullptr;
+	std::shared_ptr<query_progress> progress;
+	const cpb::position *first = nullptr;
+
+	if (cache_hit) {
+		first = result_ptr->empty() ? nullptr : &result_ptr->seek(0);
+	}
+	else {
+		// finding the first position is usually cheap, but it may require
+		// traversing the whole database if the query is very selective
+		const query_status status = pool.run(
+			query_priority::interactive,
+			[&](std::stop_token stop)
+			{
+				first = cpb::find_first(
+					snapshot->parts(), Q, stop, &snapshot->index
+				);
+			}
 		);
-	};
-
-	auto black_queens = [&](const char c) -> bool
-	{
-		Q_.queens.num_black = c;
-		const int total_so_far = Q_.pawns.total() + Q_.rooks.total() +
-								 Q_.knights.total() + Q_.bishops.total() +
-								 Q_.queens.total();
+		if (status != query_status::completed) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			if (status == query_status::rejected) {
+				std::cerr << "Too many queries are pending.\n";
+			}
+			else if (status == query_status::failed) {
+				std::cerr << "The query could not be evaluated.\n";
+			}
+			else {
+				std::cerr << "The query took too long and was cancelled.\n";
+			}
+			res.status = 503;
+			return;
+		}
 
-		if (Q_.query_total_pieces) {
-			const bool cond = in_interval(
-				Q_.query_total_pieces->lb,
-				total_so_far,
-				Q_.query_total_pieces->ub
+		if (first == nullptr) {
+			// nothing matches: the result is known already
+			result_ptr = std::make_shared<const cpb::query_result>();
+		}
+		else {
+			// count the rest of the positions in the background
+			progress = std::make_shared<query_progress>();
+			const std::optional<std::stop_source> stop = pool.submit(
+				query_priority::counting,
+				[progress, Q, snapshot, &cache](std::stop_token token)
+				{
+					const finish_progress finish{*progress};
+					progress->result =
+						cache.build(snapshot, Q, token, &progress->num_found);
+				}
 			);
-			if (not cond) {
-				return false;
+			if (not stop) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Too many queries are pending.\n";
+				res.status = 503;
+				return;
 			}
+			progress->stop = *stop;
 		}
-		return black_inspect(Q_, Q_.queens, total_so_far);
-	};
-
-	// player turn
+	}
+	const auto end = cpb::now();
+	const auto total = cpb::elapsed_time(begin, end);
 
-	auto turn_func = [&](const unsigned i) -> bool
+	const auto update_session = [&](web_query& q)
 	{
-		return Q_.query_player_turn ? i == Q_.query_player_turn : true;
+		// the previous query of the user is no longer needed
+		if (q.progress != nullptr) {
+			q.progress->stop.request_stop();
+		}
+		q.Q = Q;
+		q.progress = progress;
+		q.result = result_ptr;
+		q.current = 1;
 	};
 
-	auto& db_it = query_it->second.it;
+	// with a cookie or not, try finding the id in the 'user_query' object
+	const bool found = user_query.with_session(id, update_session);
 
-	db_it.set_functions(
-		std::move(white_pawns),
-		std::move(black_pawns),
-		std::move(white_rooks),
-		std::move(black_rooks),
-		std::move(white_knights),
-		std::move(black_knights),
-		std::move(white_bishops),
-		std::move(black_bishops),
-		std::move(white_queens),
-		std::move(black_queens),
-		std::move(turn_func),
-		true_func,
-		true_func,
-		true_func,
-		true_func,
-		true_func
-	);
-
-	const auto begin = cpb::now();
-	const size_t count = db_it.count();
-	const auto end = cpb::now();
-	const auto total = cpb::elapsed_time(begin, end);
-
-	query_it->second.current = 1;
-	query_it->second.total = count;
-
-	[[maybe_unused]] const auto _ = db_it.to_begin();
+	// if no valid id was found, make a new one
+	if (not found) {
+		bool success = false;
+		while (not success) {
+			const auto now =
+				std::chrono::system_clock::now().time_since_epoch();
+			const auto now_ns =
+				std::chrono::duration_cast<std::chrono::nanoseconds>(now);
+
+			// TODO: think about shuffling this?
+			// TODO: create an actual UUID
+			id = std::to_string(now_ns.count());
+
+			// two users may have been given the same id at the same time
+			success = user_query.insert(
+				id,
+				web_query{
+					.Q = Q,
+					.progress = progress,
+					.result = result_ptr,
+					.current = 1
+				}
+			);
+		}
+		new_id_created = true;
+	}
 
-	res.body = "{";
+	res.body.clear();
+	res.body.reserve(cpb::MAX_FEN_LENGTH + 128);
+	res.body += '{';
 	if (new_id_created) {
-		res.body += "\"id\": \"" + id + "\",";
+		append_field(res.body, "id", id);
+		res.body += ',';
 	}
 
-	if (not db_it.end()) {
-		res.body += "\"position\":\"" + cpb::make_fen(*db_it) + "\",";
+	if (first != nullptr) {
+		append_field(res.body, "position", *first);
+	}
+	else {
+		append_field(res.body, "position", "end");
+	}
+	res.body += ',';
+	append_field(res.body, "time", cpb::time_to_str(total));
+	res.body += ",\"cached\":";
+	res.body += cache_hit ? "true" : "false";
+	res.body += ',';
+	if (result_ptr != nullptr) {
+		append_field(res.body, "count", result_ptr->size());
 	}
 	else {
-		res.body += "\"position\":\"end\",";
+		// the client has to ask for the progress of the count
+		res.body += "\"counting\":true";
+	}
+	if (not snapshot->complete()) {
+		// the database is still being loaded
+		res.body += ",\"partial\":true,";
+		append_field(res.body, "loaded", snapshot->loaded_percent);
 	}
-	res.body += "\"time\":\"" + cpb::time_to_str(total) + "\",";
-	res.body += "\"count\":\"" + std::to_string(count) + "\"";
-	res.body += "}";
+	res.body += '}';
 
 	res.status = 200;
 }
 
 void route_server_database(
 	httplib::Server& svr,
-	const cpb::PuzzleDatabase& db,
-	user_query_t& user_query
+	const database_store& databases,
+	session_store& user_query,
+	query_cache& cache,
+	query_pool& pool
 )
 {
 	svr.Post(
 		"/query",
 		[&](const httplib::Request& req, httplib::Response& res)
 		{
-			make_query(req, res, db, user_query);
+			make_query(req, res, databases, user_query, cache, pool);
 		}
 	);
 }
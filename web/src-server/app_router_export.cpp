@@ -0,0 +1,164 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <string_view>
+#include <iostream>
+#include <optional>
+#include <memory>
+#include <string>
+
+// cpb includes
+#include <cpb/query_export.hpp>
+#include <cpb/query.hpp>
+
+// custom includes
+#include "src-server/database_store.hpp"
+#include "src-server/session_store.hpp"
+#include "src-server/query_pool.hpp"
+#include "src-server/app_router.hpp"
+#include "src-server/cookies.hpp"
+#include "src-server/query.hpp"
+
+/// Size of the chunks sent to the client, in bytes.
+static constexpr size_t EXPORT_CHUNK_SIZE = 64 * 1024;
+
+[[nodiscard]] static std::string_view
+content_type(const cpb::export_format format) noexcept
+{
+	switch (format) {
+	case cpb::export_format::fen:
+		return "text/plain";
+	case cpb::export_format::csv:
+		return "text/csv";
+	case cpb::export_format::ndjson:
+		return "application/x-ndjson";
+	}
+	return "text/plain";
+}
+
+void route_server_export(
+	httplib::Server& svr,
+	const database_store& databases,
+	session_store& user_query,
+	query_pool& pool
+)
+{
+	svr.Get(
+		"/export",
+		[&](const httplib::Request& req, httplib::Response& res)
+		{
+			const std::string format_str =
+				req.has_param("format") ? req.get_param_value("format")
+										: std::string{"ndjson"};
+			const std::optional<cpb::export_format> format =
+				cpb::parse_export_format(format_str);
+			if (not format) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "Invalid export format '" << format_str << "'\n";
+				res.status = 400;
+				return;
+			}
+
+			std::string id;
+			{
+				const std::string cookies = req.get_header_value("Cookie");
+				const cookie_map cs = parse_cookies_into_map(cookies);
+				const auto it = cs.find("sessionid");
+				if (it != cs.end()) {
+					id = it->second;
+				}
+			}
+
+			cpb::querier Q;
+			const bool found = user_query.with_session(
+				id,
+				[&](web_query& q)
+				{
+					Q = q.Q;
+				}
+			);
+			if (not found) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "User with token does not exist.\n";
+				res.status = 400;
+				return;
+			}
+
+			// the snapshot is kept alive until the export finishes
+			std::shared_ptr<const database_snapshot> snapshot =
+				databases.current();
+
+			res.set_header(
+				"Content-Disposition",
+				"attachment; filename=\"positions." + format_str + '"'
+			);
+			res.set_chunked_content_provider(
+				std::string{content_type(*format)},
+				[snapshot = std::move(snapshot), Q, format = *format, &pool](
+					size_t, httplib::DataSink& sink
+				)
+				{
+					// the positions are produced in the pool, at the lowest
+					// priority, and written as they are produced; the export
+					// has no deadline and ends early only when the client
+					// disconnects, which makes the sink fail
+					const auto parts = snapshot->parts();
+					std::optional<size_t> exported;
+					const query_status status = pool.run(
+						query_priority::exporting,
+						[&](std::stop_token stop)
+						{
+							exported = cpb::export_query(
+								parts,
+								Q,
+								format,
+								[&sink](const std::string_view chunk)
+								{
+									return sink.write(
+										chunk.data(), chunk.size()
+									);
+								},
+								{.num_threads = 1,
+								 .chunk_size = EXPORT_CHUNK_SIZE,
+								 .index = &snapshot->index},
+								stop
+							);
+						}
+					);
+					if (status != query_status::completed or not exported) {
+						std::cerr << __PRETTY_FUNCTION__ << '\n';
+						std::cerr << "The export could not be completed.\n";
+						// closes the connection without finishing the body
+						return false;
+					}
+					sink.done();
+					return true;
+				}
+			);
+		}
+	);
+}
@@ -0,0 +1,177 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <string_view>
+#include <iostream>
+#include <optional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// cpb includes
+#include <cpb/query_facets.hpp>
+#include <cpb/query.hpp>
+
+// custom includes
+#include "src-server/database_store.hpp"
+#include "src-server/session_store.hpp"
+#include "src-server/json_writer.hpp"
+#include "src-server/query_pool.hpp"
+#include "src-server/app_router.hpp"
+#include "src-server/cookies.hpp"
+#include "src-server/query.hpp"
+
+/**
+ * @brief Parses a comma-separated list of facet fields.
+ * @returns The fields, or nothing if some field is not valid.
+ */
+[[nodiscard]] static std::optional<std::vector<cpb::facet_field>>
+parse_fields(std::string_view list)
+{
+	std::vector<cpb::facet_field> fields;
+	while (not list.empty()) {
+		const size_t comma = list.find(',');
+		const std::string_view name = list.substr(0, comma);
+		list = comma == std::string_view::npos ? std::string_view{}
+											   : list.substr(comma + 1);
+
+		const std::optional<cpb::facet_field> f = cpb::parse_facet_field(name);
+		if (not f) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "Invalid facet field '" << name << "'\n";
+			return {};
+		}
+		fields.push_back(*f);
+	}
+	return fields;
+}
+
+void route_server_facets(
+	httplib::Server& svr,
+	const database_store& databases,
+	session_store& user_query,
+	query_pool& pool
+)
+{
+	svr.Get(
+		"/facets",
+		[&](const httplib::Request& req, httplib::Response& res)
+		{
+			const std::optional<std::vector<cpb::facet_field>> fields =
+				parse_fields(
+					req.has_param("fields") ? req.get_param_value("fields")
+											: std::string{"material"}
+				);
+			if (not fields or fields->empty()) {
+				res.status = 400;
+				return;
+			}
+
+			std::string id;
+			{
+				const std::string cookies = req.get_header_value("Cookie");
+				const cookie_map cs = parse_cookies_into_map(cookies);
+				const auto it = cs.find("sessionid");
+				if (it != cs.end()) {
+					id = it->second;
+				}
+			}
+
+			cpb::querier Q;
+			const bool found = user_query.with_session(
+				id,
+				[&](web_query& q)
+				{
+					Q = q.Q;
+				}
+			);
+			if (not found) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "User with token does not exist.\n";
+				res.status = 400;
+				return;
+			}
+
+			const std::shared_ptr<const database_snapshot> snapshot =
+				databases.current();
+
+			std::optional<std::vector<cpb::facet>> facets;
+			const query_status status = pool.run(
+				query_priority::counting,
+				[&](std::stop_token stop)
+				{
+					facets = cpb::compute_facets(
+						snapshot->parts(), Q, *fields, 1, stop, &snapshot->index
+					);
+				}
+			);
+			if (status != query_status::completed or not facets) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				if (status == query_status::rejected) {
+					std::cerr << "Too many queries are pending.\n";
+				}
+				else if (status == query_status::failed) {
+					std::cerr << "The query could not be evaluated.\n";
+				}
+				else {
+					std::cerr << "The query took too long and was cancelled.\n";
+				}
+				res.status = 503;
+				return;
+			}
+
+			res.body.clear();
+			res.body += '{';
+			bool first_facet = true;
+			for (const cpb::facet& f : *facets) {
+				if (not first_facet) {
+					res.body += ',';
+				}
+				first_facet = false;
+
+				res.body += '"';
+				res.body += cpb::name_of(f.field);
+				res.body += "\":[";
+				bool first_bucket = true;
+				for (const cpb::facet::bucket& b : f.buckets) {
+					if (not first_bucket) {
+						res.body += ',';
+					}
+					first_bucket = false;
+					res.body += '{';
+					append_field(res.body, "key", b.key);
+					res.body += ',';
+					append_field(res.body, "count", b.count);
+					res.body += '}';
+				}
+				res.body += ']';
+			}
+			res.body += '}';
+			res.status = 200;
+		}
+	);
+}
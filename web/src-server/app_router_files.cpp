@@ -24,47 +24,37 @@
 // HTTP lib includes
 #include <httplib.h>
 
-// cpb includes
-#include <cpb/database.hpp>
-
 // custom includes
-#include "src-server/utils/files.hpp"
+#include "src-server/asset_cache.hpp"
+#include "src-server/app_router.hpp"
 
-void route_server_files(httplib::Server& svr)
+void route_server_files(httplib::Server& svr, const asset_cache& assets)
 {
-	svr.Get(
-		"",
-		[](const httplib::Request& /*req*/, httplib::Response& res)
-		{
-			res.set_file_content(utils::get_filename("html/main.html"));
-		}
-	);
-	svr.Get(
-		"/",
-		[](const httplib::Request& /*req*/, httplib::Response& res)
-		{
-			res.set_file_content(utils::get_filename("html/main.html"));
-		}
-	);
-	svr.Get(
-		R"(/js/[a-zA-Z0-9_/]*.js)",
-		[](const httplib::Request& req, httplib::Response& res)
-		{
-			res.set_file_content(utils::get_filename(req.target));
+	const auto serve_path =
+		[&assets](const std::string& path, const httplib::Request& req,
+				  httplib::Response& res)
+	{
+		const asset *a = assets.find(path);
+		if (a == nullptr) {
+			res.status = 404;
+			return;
 		}
-	);
-	svr.Get(
-		R"(/css/[a-zA-Z0-9_/\-]*.css)",
-		[](const httplib::Request& req, httplib::Response& res)
-		{
-			res.set_file_content(utils::get_filename(req.target));
-		}
-	);
-	svr.Get(
-		R"(/node_modules/@[a-zA-Z0-9_/\-]*.css)",
-		[](const httplib::Request& req, httplib::Response& res)
-		{
-			res.set_file_content(utils::get_filename(req.target));
-		}
-	);
+		asset_cache::serve(*a, req, res);
+	};
+	const auto serve_main =
+		[serve_path](const httplib::Request& req, httplib::Response& res)
+	{
+		serve_path("/html/main.html", req, res);
+	};
+	const auto serve_request =
+		[serve_path](const httplib::Request& req, httplib::Response& res)
+	{
+		serve_path(req.path, req, res);
+	};
+
+	svr.Get("", serve_main);
+	svr.Get("/", serve_main);
+	svr.Get(R"(/js/[a-zA-Z0-9_/]*.js)", serve_request);
+	svr.Get(R"(/css/[a-zA-Z0-9_/\-]*.css)", serve_request);
+	svr.Get(R"(/node_modules/@[a-zA-Z0-9_/\-]*.css)", serve_request);
 }
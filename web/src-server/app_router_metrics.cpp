@@ -0,0 +1,224 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <string>
+
+// POSIX includes
+#include <unistd.h>
+
+// custom includes
+#include "src-server/database_store.hpp"
+#include "src-server/asset_cache.hpp"
+#include "src-server/app_router.hpp"
+#include "src-server/metrics.hpp"
+
+/// Returns the resident memory of this process, in bytes.
+[[nodiscard]] static size_t resident_memory() noexcept
+{
+	// the second field is the number of resident pages
+	std::ifstream fin("/proc/self/statm");
+	size_t total_pages = 0;
+	size_t resident_pages = 0;
+	if (not (fin >> total_pages >> resident_pages)) {
+		return 0;
+	}
+	return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void route_server_metrics(
+	httplib::Server& svr,
+	server_metrics& metrics,
+	const asset_cache& assets,
+	const database_store& databases,
+	const session_store& user_query,
+	const query_cache& cache,
+	const query_pool& pool
+)
+{
+	// every request is handled from start to end by the same thread
+	thread_local std::chrono::steady_clock::time_point request_begin;
+
+	svr.set_pre_routing_handler(
+		[](const httplib::Request&, httplib::Response&)
+		{
+			request_begin = std::chrono::steady_clock::now();
+			return httplib::Server::HandlerResponse::Unhandled;
+		}
+	);
+	svr.set_logger(
+		[&metrics](const httplib::Request& req, const httplib::Response&)
+		{
+			const std::chrono::nanoseconds elapsed =
+				std::chrono::steady_clock::now() - request_begin;
+			metrics.histogram(server_metrics::group_of(req.path))
+				.record(elapsed);
+		}
+	);
+
+	svr.Get(
+		"/metrics",
+		[&](const httplib::Request&, httplib::Response& res)
+		{
+			std::string out;
+			out.reserve(16 * 1024);
+			metrics.write(out);
+
+			const auto as_double = [](const size_t v)
+			{
+				return static_cast<double>(v);
+			};
+
+			const std::shared_ptr<const database_snapshot> snapshot =
+				databases.current();
+			write_metric(
+				out,
+				"cpb_database_positions",
+				"gauge",
+				"Positions in the database.",
+				as_double(snapshot->size())
+			);
+			write_metric(
+				out,
+				"cpb_database_version",
+				"gauge",
+				"Version of the database served.",
+				as_double(snapshot->version)
+			);
+			write_metric(
+				out,
+				"cpb_database_loaded_percent",
+				"gauge",
+				"Percentage of the database files loaded.",
+				as_double(snapshot->loaded_percent)
+			);
+			write_metric(
+				out,
+				"cpb_database_index_bytes",
+				"gauge",
+				"Bytes used by the index of the database, approximately.",
+				as_double(snapshot->index.num_bytes())
+			);
+			write_metric(
+				out,
+				"cpb_database_reloading",
+				"gauge",
+				"Whether or not the database is being reloaded.",
+				databases.reloading() ? 1.0 : 0.0
+			);
+			write_metric(
+				out,
+				"cpb_sessions",
+				"gauge",
+				"Open sessions.",
+				as_double(user_query.size())
+			);
+			write_metric(
+				out,
+				"cpb_sessions_expired_total",
+				"counter",
+				"Sessions removed for being idle.",
+				as_double(user_query.num_expired())
+			);
+			write_metric(
+				out,
+				"cpb_sessions_evicted_total",
+				"counter",
+				"Sessions evicted to make room for new ones.",
+				as_double(user_query.num_evicted())
+			);
+			write_metric(
+				out,
+				"cpb_query_cache_entries",
+				"gauge",
+				"Results in the query cache.",
+				as_double(cache.size())
+			);
+			write_metric(
+				out,
+				"cpb_query_cache_bytes",
+				"gauge",
+				"Bytes used by the results in the query cache.",
+				as_double(cache.num_bytes())
+			);
+			write_metric(
+				out,
+				"cpb_query_cache_hits_total",
+				"counter",
+				"Queries answered from the query cache.",
+				as_double(cache.num_hits())
+			);
+			write_metric(
+				out,
+				"cpb_query_cache_misses_total",
+				"counter",
+				"Queries not found in the query cache.",
+				as_double(cache.num_misses())
+			);
+			write_metric(
+				out,
+				"cpb_query_pool_pending",
+				"gauge",
+				"Jobs waiting in the query pool.",
+				as_double(pool.num_pending())
+			);
+			write_metric(
+				out,
+				"cpb_query_pool_rejected_total",
+				"counter",
+				"Jobs rejected because the query pool was full.",
+				as_double(pool.num_rejected())
+			);
+			write_metric(
+				out,
+				"cpb_query_pool_timed_out_total",
+				"counter",
+				"Jobs cancelled because they did not finish in time.",
+				as_double(pool.num_timed_out())
+			);
+			write_metric(
+				out,
+				"cpb_static_files_bytes",
+				"gauge",
+				"Bytes used by the static files held in memory.",
+				as_double(assets.num_bytes())
+			);
+			write_metric(
+				out,
+				"cpb_resident_memory_bytes",
+				"gauge",
+				"Resident memory of the server.",
+				as_double(resident_memory())
+			);
+
+			res.set_content(std::move(out), "text/plain; version=0.0.4");
+			res.status = 200;
+		}
+	);
+}
@@ -0,0 +1,279 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <system_error>
+#include <string_view>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <array>
+
+// compression includes
+#include <zlib.h>
+#if defined CPB_USE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+// custom includes
+#include "src-server/asset_cache.hpp"
+
+namespace {
+
+/// Returns the MIME type of a file from its extension, or empty.
+[[nodiscard]] std::string_view
+content_type_of(const std::filesystem::path& p) noexcept
+{
+	const std::string ext = p.extension().string();
+	if (ext == ".html") {
+		return "text/html";
+	}
+	if (ext == ".js") {
+		return "text/javascript";
+	}
+	if (ext == ".css") {
+		return "text/css";
+	}
+	return "";
+}
+
+/// 64-bit FNV-1a hash of @e s in hexadecimal.
+[[nodiscard]] std::string hash_of(const std::string_view s)
+{
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (const char c : s) {
+		h ^= static_cast<unsigned char>(c);
+		h *= 0x100000001b3ull;
+	}
+
+	static constexpr std::string_view digits = "0123456789abcdef";
+	std::string hex(16, '0');
+	for (size_t i = 16; i > 0; --i) {
+		hex[i - 1] = digits[h & 0xf];
+		h >>= 4;
+	}
+	return hex;
+}
+
+/// Compresses @e s with gzip. Returns empty if compression failed.
+[[nodiscard]] std::string gzip(const std::string& s)
+{
+	z_stream zs{};
+	// 15 bits of window, plus 16 to write a gzip header
+	if (deflateInit2(
+			&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY
+		) != Z_OK) {
+		return {};
+	}
+
+	std::string out(deflateBound(&zs, s.size()), '\0');
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(s.data()));
+	zs.avail_in = static_cast<uInt>(s.size());
+	zs.next_out = reinterpret_cast<Bytef *>(out.data());
+	zs.avail_out = static_cast<uInt>(out.size());
+
+	const bool ok = deflate(&zs, Z_FINISH) == Z_STREAM_END;
+	out.resize(zs.total_out);
+	deflateEnd(&zs);
+	return ok ? out : std::string{};
+}
+
+#if defined CPB_USE_BROTLI
+/// Compresses @e s with brotli. Returns empty if compression failed.
+[[nodiscard]] std::string brotli(const std::string& s)
+{
+	size_t size = BrotliEncoderMaxCompressedSize(s.size());
+	std::string out(size, '\0');
+	const bool ok = BrotliEncoderCompress(
+		BROTLI_MAX_QUALITY,
+		BROTLI_DEFAULT_WINDOW,
+		BROTLI_MODE_TEXT,
+		s.size(),
+		reinterpret_cast<const uint8_t *>(s.data()),
+		&size,
+		reinterpret_cast<uint8_t *>(out.data())
+	);
+	out.resize(size);
+	return ok ? out : std::string{};
+}
+#endif
+
+/// Does the value of header Accept-Encoding @e accepted include @e coding?
+[[nodiscard]] bool
+accepts(const std::string_view accepted, const std::string_view coding) noexcept
+{
+	size_t begin = 0;
+	while (begin < accepted.size()) {
+		size_t end = accepted.find(',', begin);
+		if (end == std::string_view::npos) {
+			end = accepted.size();
+		}
+
+		std::string_view token = accepted.substr(begin, end - begin);
+		token = token.substr(0, token.find(';'));
+		while (not token.empty() and token.front() == ' ') {
+			token.remove_prefix(1);
+		}
+		while (not token.empty() and token.back() == ' ') {
+			token.remove_suffix(1);
+		}
+		if (token == coding) {
+			return true;
+		}
+
+		begin = end + 1;
+	}
+	return false;
+}
+
+/// Does the value of header If-None-Match @e tags include @e etag?
+[[nodiscard]] bool
+matches(const std::string_view tags, const std::string_view etag) noexcept
+{
+	if (tags == "*") {
+		return true;
+	}
+	// entity tags are quoted and cannot contain quotes, so a quoted tag
+	// cannot be found inside another one. Weak tags (W/"...") also match, as
+	// the comparison for this header is weak.
+	return tags.find(etag) != std::string_view::npos;
+}
+
+} // namespace
+
+size_t asset_cache::load(const std::string_view root)
+{
+	namespace fs = std::filesystem;
+
+	// directories with files that can be served
+	static constexpr std::array<std::string_view, 4> directories = {
+		"html", "js", "css", "node_modules/@lichess-org"
+	};
+
+	size_t num_loaded = 0;
+	for (const std::string_view dir : directories) {
+		const fs::path dir_path = fs::path(root) / dir;
+		std::error_code ec;
+		if (not fs::is_directory(dir_path, ec)) {
+			continue;
+		}
+
+		for (const fs::directory_entry& e :
+			 fs::recursive_directory_iterator(dir_path, ec)) {
+			if (not e.is_regular_file()) {
+				continue;
+			}
+			const std::string_view type = content_type_of(e.path());
+			if (type.empty()) {
+				continue;
+			}
+
+			std::ifstream fin(e.path(), std::ios::binary);
+			if (not fin.is_open()) {
+				std::cerr << __PRETTY_FUNCTION__ << '\n';
+				std::cerr << "File '" << e.path() << "' could not be read.\n";
+				continue;
+			}
+
+			asset a;
+			a.content_type = type;
+			a.body.resize(e.file_size());
+			fin.read(
+				a.body.data(), static_cast<std::streamsize>(a.body.size())
+			);
+			a.hash = hash_of(a.body);
+
+			// keep the compressed variants only if they are smaller
+			a.gzip_body = gzip(a.body);
+			if (a.gzip_body.size() >= a.body.size()) {
+				a.gzip_body.clear();
+			}
+#if defined CPB_USE_BROTLI
+			a.brotli_body = brotli(a.body);
+			if (a.brotli_body.size() >= a.body.size()) {
+				a.brotli_body.clear();
+			}
+#endif
+
+			const std::string path =
+				"/" + fs::relative(e.path(), root).generic_string();
+			m_assets.insert_or_assign(path, std::move(a));
+			++num_loaded;
+		}
+	}
+	return num_loaded;
+}
+
+void asset_cache::serve(
+	const asset& a, const httplib::Request& req, httplib::Response& res
+)
+{
+	const std::string accepted = req.get_header_value("Accept-Encoding");
+
+	// every representation of the file has its own entity tag
+	const std::string *body = &a.body;
+	std::string_view encoding;
+	if (not a.brotli_body.empty() and accepts(accepted, "br")) {
+		body = &a.brotli_body;
+		encoding = "br";
+	}
+	else if (not a.gzip_body.empty() and accepts(accepted, "gzip")) {
+		body = &a.gzip_body;
+		encoding = "gzip";
+	}
+
+	std::string etag = "\"" + a.hash;
+	if (not encoding.empty()) {
+		etag += "-";
+		etag += encoding;
+	}
+	etag += "\"";
+
+	res.set_header("ETag", etag);
+	res.set_header("Vary", "Accept-Encoding");
+	res.set_header("Cache-Control", "no-cache");
+
+	if (matches(req.get_header_value("If-None-Match"), etag)) {
+		res.status = 304;
+		return;
+	}
+
+	if (not encoding.empty()) {
+		res.set_header("Content-Encoding", std::string{encoding});
+	}
+	res.set_content(*body, a.content_type);
+	res.status = 200;
+}
+
+size_t asset_cache::num_bytes() const noexcept
+{
+	size_t total = 0;
+	for (const auto& [path, a] : m_assets) {
+		total += a.body.size() + a.gzip_body.size() + a.brotli_body.size();
+	}
+	return total;
+}
@@ -0,0 +1,93 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// HTTP lib includes
+#include <httplib.h>
+
+// C++ includes
+#include <unordered_map>
+#include <string_view>
+#include <string>
+
+/// A static file served by the web server.
+struct asset {
+	/// MIME type of the file.
+	std::string content_type;
+	/// Contents of the file.
+	std::string body;
+	/// Contents of the file compressed with gzip. Empty if not worth it.
+	std::string gzip_body;
+	/// Contents of the file compressed with brotli. Empty if not worth it.
+	std::string brotli_body;
+	/// Hash of the contents, used to make the entity tags of the file.
+	std::string hash;
+};
+
+/**
+ * @brief The static files served by the web server, held in memory.
+ *
+ * All files are read and compressed once when the server starts, so that
+ * serving them never touches the disk or the compressor.
+ */
+class asset_cache {
+public:
+
+	/**
+	 * @brief Loads all servable files under directory @e root.
+	 *
+	 * These are the HTML pages, the JavaScript bundles and the stylesheets
+	 * (including those of chessground).
+	 * @returns The number of files loaded.
+	 */
+	size_t load(const std::string_view root);
+
+	/**
+	 * @brief Returns the file at @e path, relative to the root.
+	 * @returns The file or a null pointer if it is not in the cache.
+	 */
+	[[nodiscard]] const asset *find(const std::string& path) const noexcept
+	{
+		const auto it = m_assets.find(path);
+		return it != m_assets.end() ? &it->second : nullptr;
+	}
+
+	/// Answers request @e req with file @e a.
+	static void
+	serve(const asset& a, const httplib::Request& req, httplib::Response& res);
+
+	/// Number of files in the cache.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_assets.size();
+	}
+
+	/// Number of bytes used by the files in the cache.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+
+private:
+
+	/// The files, indexed by their path relative to the root.
+	std::unordered_map<std::string, asset> m_assets;
+};
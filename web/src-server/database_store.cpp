@@ -0,0 +1,350 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <utility>
+#include <print>
+
+// ctree includes
+#include <ctree/memory_profile.hpp>
+
+// cpb includes
+#include <cpb/index_layouts.hpp>
+#include <cpb/profiler.hpp>
+#include <cpb/lichess.hpp>
+#include <cpb/time.hpp>
+
+// custom includes
+#include "src-server/database_store.hpp"
+
+namespace {
+
+void load_lichess_database(
+	const std::string_view file,
+	const bool read_memory_profile,
+	const cpb::square_levels& levels,
+	cpb::PuzzleDatabase& db,
+	server_metrics& metrics
+)
+{
+	PROFILE_FUNCTION;
+
+	const size_t initial_db_size = db.size();
+	const auto begin = cpb::now();
+	const auto res =
+		(read_memory_profile
+			 ? cpb::lichess::load_database_initialized(file, db, levels)
+			 : cpb::lichess::load_database(file, db, levels));
+	const auto end = cpb::now();
+
+	if (res.has_value()) {
+		metrics.add_load(
+			{.file = std::string{file},
+			 .seconds = cpb::elapsed_time(begin, end) / 1e6,
+			 .positions_read = *res,
+			 .positions_added = db.size() - initial_db_size}
+		);
+		std::print("Total fen read: {}.\n", *res);
+		std::print("Added {} new positions.\n", db.size() - initial_db_size);
+		std::print(
+			"    From {} positions to {} positions.\n",
+			initial_db_size,
+			db.size()
+		);
+	}
+	else {
+		std::print(std::cerr, "The database could not be read.\n");
+		if (res.error() == cpb::lichess::load_error::file_error) {
+			std::print(std::cerr, "    File could not be loaded.\n");
+		}
+		else if (res.error() == cpb::lichess::load_error::invalid_position) {
+			std::print(std::cerr, "    Contains some invalid position.\n");
+		}
+	}
+}
+
+/**
+ * @brief Adds the positions of @e chunk to @e db, and those of them that
+ * were not in @e db yet also to @e fresh.
+ */
+void add_chunk(
+	const cpb::PuzzleDatabase& chunk,
+	cpb::PuzzleDatabase& db,
+	cpb::PuzzleDatabase& fresh
+)
+{
+	for (const cpb::keyed_leaf& leaf : cpb::collect_leaves(chunk)) {
+		[&]<size_t... l>(std::index_sequence<l...>)
+		{
+			for (size_t i = 0; i < leaf.ref.size; ++i) {
+				const cpb::position& p = leaf.ref.data[i];
+				const size_t size_before = db.size();
+				db.add(cpb::position{p}, leaf.keys[l]...);
+				if (db.size() != size_before) {
+					fresh.add(cpb::position{p}, leaf.keys[l]...);
+				}
+			}
+		}(std::make_index_sequence<cpb::NUM_LEVELS>{});
+	}
+}
+
+} // namespace
+
+std::shared_ptr<database_snapshot> new_snapshot()
+{
+	// versions are unique for the whole lifetime of the server
+	static std::atomic<uint64_t> next_version = 1;
+
+	auto snapshot = std::make_shared<database_snapshot>();
+	snapshot->version = next_version.fetch_add(1, std::memory_order_relaxed);
+	return snapshot;
+}
+
+std::shared_ptr<database_snapshot>
+load_snapshot(const database_sources& sources, server_metrics& metrics)
+{
+	PROFILE_FUNCTION;
+
+	std::shared_ptr<database_snapshot> snapshot = new_snapshot();
+	snapshot->index.levels = sources.levels;
+
+	const bool read_memory_profile = not sources.memory_profile.empty();
+	if (read_memory_profile) {
+		std::print("--------------------------\n");
+		std::print("Reading memory profile '{}'.\n", sources.memory_profile);
+
+		std::ifstream fin(sources.memory_profile);
+		if (not fin.is_open()) {
+			std::print(
+				std::cerr,
+				"Input memory profile file '{}' could not be opened.\n",
+				sources.memory_profile
+			);
+			return nullptr;
+		}
+
+		// the tree has to be filled with the levels it was profiled with
+		const std::optional<cpb::square_levels> levels =
+			cpb::read_profile_header(fin);
+		if (not levels) {
+			std::print(std::cerr, "Invalid memory profile header.\n");
+			return nullptr;
+		}
+		if (*levels != sources.levels) {
+			std::print(
+				"    Using the square levels of the profile: {}\n",
+				cpb::to_string(*levels)
+			);
+		}
+		snapshot->index.levels = *levels;
+
+		size_t total_bytes;
+		fin >> total_bytes;
+		std::print("    Total bytes: {}\n", total_bytes);
+		snapshot->arena.initialize(total_bytes);
+
+		classtree::initialize(snapshot->db, fin, &snapshot->arena);
+		fin.close();
+	}
+
+	for (const auto& [file, format] : sources.files) {
+		if (format == cpb::database_format::lichess) {
+			std::print("--------------------------\n");
+			std::print("Loading lichess database {}\n", file);
+			load_lichess_database(
+				file,
+				read_memory_profile,
+				snapshot->index.levels,
+				snapshot->db,
+				metrics
+			);
+		}
+	}
+
+	snapshot->index.layouts.enable(sources.layouts);
+	snapshot->index.skeletons.enable(sources.index_pawns);
+	snapshot->index.kings.enable(sources.index_kings);
+	snapshot->index.add(snapshot->db);
+	return snapshot;
+}
+
+bool database_store::reload(
+	database_sources sources,
+	server_metrics& metrics,
+	std::function<void(const database_snapshot&)> on_publish
+)
+{
+	bool expected = false;
+	if (not m_reloading.compare_exchange_strong(expected, true)) {
+		return false;
+	}
+
+	std::lock_guard lock(m_loader_mutex);
+	// the previous loader has finished already, this only joins it
+	m_loader = std::jthread(
+		[this,
+		 sources = std::move(sources),
+		 &metrics,
+		 on_publish = std::move(on_publish)]
+		{
+			std::shared_ptr<const database_snapshot> s =
+				load_snapshot(sources, metrics);
+			if (s != nullptr) {
+				publish(s);
+				on_publish(*s);
+				std::print(
+					"Published database version {} with {} positions.\n",
+					s->version,
+					s->size()
+				);
+			}
+			m_reloading.store(false, std::memory_order_relaxed);
+		}
+	);
+	return true;
+}
+
+bool database_store::load_progressively(
+	database_sources sources,
+	server_metrics& metrics,
+	std::function<void(const database_snapshot&)> on_publish,
+	const size_t chunk_size
+)
+{
+	bool expected = false;
+	if (not m_reloading.compare_exchange_strong(expected, true)) {
+		return false;
+	}
+
+	sources.memory_profile.clear();
+
+	std::lock_guard lock(m_loader_mutex);
+	// the previous loader has finished already, this only joins it
+	m_loader = std::jthread(
+		[this,
+		 sources = std::move(sources),
+		 &metrics,
+		 on_publish = std::move(on_publish),
+		 chunk_size](std::stop_token stop)
+		{
+			PROFILE_SCOPE("load progressively");
+
+			size_t total_bytes = 0;
+			for (const auto& [file, format] : sources.files) {
+				std::error_code ec;
+				const auto bytes = std::filesystem::file_size(file, ec);
+				total_bytes += ec ? 0 : bytes;
+			}
+			total_bytes = std::max<size_t>(total_bytes, 1);
+
+			// the chunks only have the positions not in the previous ones,
+			// and all of them are also added to the complete database
+			std::vector<std::shared_ptr<const cpb::PuzzleDatabase>> chunks;
+			cpb::PuzzleDatabase complete;
+			size_t bytes_done = 0;
+
+			const auto publish_chunks = [&](const size_t bytes_read) -> bool
+			{
+				if (stop.stop_requested()) {
+					return false;
+				}
+				const std::shared_ptr<database_snapshot> s = new_snapshot();
+				s->chunks = chunks;
+				s->index.levels = sources.levels;
+				// the last percent is left for the complete database
+				s->loaded_percent =
+					std::min<size_t>(99, (bytes_read * 100) / total_bytes);
+				publish(s);
+				on_publish(*s);
+				return true;
+			};
+
+			for (const auto& [file, format] : sources.files) {
+				if (format != cpb::database_format::lichess) {
+					continue;
+				}
+				std::print("--------------------------\n");
+				std::print("Loading lichess database {} in chunks\n", file);
+
+				const size_t initial_size = complete.size();
+				const auto begin = cpb::now();
+				const auto res = cpb::lichess::load_database_chunked(
+					file,
+					chunk_size,
+					[&](std::unique_ptr<cpb::PuzzleDatabase> chunk,
+						const size_t bytes_read)
+					{
+						auto fresh = std::make_shared<cpb::PuzzleDatabase>();
+						add_chunk(*chunk, complete, *fresh);
+						chunk.reset();
+						chunks.push_back(std::move(fresh));
+						return publish_chunks(bytes_done + bytes_read);
+					},
+					sources.levels
+				);
+				const auto end = cpb::now();
+				if (res.has_value()) {
+					metrics.add_load(
+						{.file = file,
+						 .seconds = cpb::elapsed_time(begin, end) / 1e6,
+						 .positions_read = *res,
+						 .positions_added = complete.size() - initial_size}
+					);
+				}
+				else {
+					std::print(std::cerr, "The database could not be read.\n");
+				}
+
+				std::error_code ec;
+				const auto bytes = std::filesystem::file_size(file, ec);
+				bytes_done += ec ? 0 : bytes;
+			}
+
+			// the complete database replaces the chunks, which are freed as
+			// soon as no query uses them anymore
+			if (not stop.stop_requested()) {
+				chunks.clear();
+				const std::shared_ptr<database_snapshot> s = new_snapshot();
+				s->index.levels = sources.levels;
+				s->db = std::move(complete);
+				s->index.layouts.enable(sources.layouts);
+				s->index.skeletons.enable(sources.index_pawns);
+				s->index.kings.enable(sources.index_kings);
+				s->index.add(s->db);
+				publish(s);
+				on_publish(*s);
+				std::print(
+					"Published database version {} with {} positions.\n",
+					s->version,
+					s->size()
+				);
+			}
+			m_reloading.store(false, std::memory_order_relaxed);
+		}
+	);
+	return true;
+}
@@ -0,0 +1,210 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+// cpb includes
+#include <cpb/arena_allocator.hpp>
+#include <cpb/database_index.hpp>
+#include <cpb/database.hpp>
+#include <cpb/formats.hpp>
+
+// custom includes
+#include "src-server/metrics.hpp"
+
+/**
+ * @brief A database, together with the memory it is stored in.
+ *
+ * While the database files are being loaded, a snapshot is made of the
+ * chunks loaded so far instead, and @ref db is empty.
+ */
+struct database_snapshot {
+	/// Memory of the database, when it is loaded with a memory profile.
+	/// Declared before the database so that it is destroyed after it.
+	cpb::arena_allocator arena;
+	/// The database.
+	cpb::PuzzleDatabase db;
+	/// The chunks loaded so far, shared with the following snapshots.
+	std::vector<std::shared_ptr<const cpb::PuzzleDatabase>> chunks;
+	/// Index of @ref db and of the chunks. The chunks are not summarized.
+	cpb::database_index index;
+	/// Number of this snapshot. Every new snapshot has a greater number.
+	uint64_t version = 0;
+	/// Percentage of the database files loaded in this snapshot.
+	size_t loaded_percent = 100;
+
+	/// Are all the database files loaded in this snapshot?
+	[[nodiscard]] bool complete() const noexcept
+	{
+		return loaded_percent == 100;
+	}
+
+	/// The databases to be queried, in order.
+	[[nodiscard]] std::vector<const cpb::PuzzleDatabase *> parts() const
+	{
+		if (chunks.empty()) {
+			return {&db};
+		}
+		std::vector<const cpb::PuzzleDatabase *> v;
+		v.reserve(chunks.size());
+		for (const auto& chunk : chunks) {
+			v.push_back(chunk.get());
+		}
+		return v;
+	}
+
+	/// Number of positions in this snapshot.
+	[[nodiscard]] size_t size() const noexcept
+	{
+		size_t s = db.size();
+		for (const auto& chunk : chunks) {
+			s += chunk->size();
+		}
+		return s;
+	}
+};
+
+/// The files a database is loaded from.
+struct database_sources {
+	/// The database files and their formats.
+	std::vector<std::pair<std::string, cpb::database_format>> files;
+	/// Memory profile used to allocate the database. Empty if none.
+	std::string memory_profile;
+	/// The squares of the square levels of the database.
+	cpb::square_levels levels;
+	/// The secondary layouts built for the complete database.
+	std::vector<cpb::index_layout> layouts;
+	/// Is the complete database indexed by pawn skeleton?
+	bool index_pawns = false;
+	/// Is the complete database indexed by the squares of the kings?
+	bool index_kings = false;
+};
+
+/// Returns an empty snapshot with a new version number.
+[[nodiscard]] std::shared_ptr<database_snapshot> new_snapshot();
+
+/**
+ * @brief Loads a new database from @e sources.
+ *
+ * Files that cannot be read are skipped.
+ * @returns The new database, or a null pointer if the memory profile could
+ * not be read.
+ */
+[[nodiscard]] std::shared_ptr<database_snapshot>
+load_snapshot(const database_sources& sources, server_metrics& metrics);
+
+/**
+ * @brief The database currently served, which can be replaced at any time.
+ *
+ * Requests take a reference to the current snapshot and use it until they
+ * finish; the results of the queries keep a reference to the snapshot they
+ * point into. Publishing a new snapshot does not wait for anything: an old
+ * snapshot is freed when the last request, session or cached result using
+ * it goes away.
+ */
+class database_store {
+public:
+
+	/// Constructor with the first snapshot.
+	explicit database_store(std::shared_ptr<const database_snapshot> s) noexcept
+		: m_current(std::move(s))
+	{}
+
+	/// Returns the current snapshot.
+	[[nodiscard]] std::shared_ptr<const database_snapshot>
+	current() const noexcept
+	{
+		return m_current.load(std::memory_order_acquire);
+	}
+
+	/// Makes @e s the current snapshot.
+	void publish(std::shared_ptr<const database_snapshot> s) noexcept
+	{
+		m_current.store(std::move(s), std::memory_order_release);
+	}
+
+	/**
+	 * @brief Loads a new snapshot from @e sources in the background.
+	 *
+	 * The new snapshot is published when it is complete, and then function
+	 * @e on_publish is called with it.
+	 * @returns Whether or not the reload was started, that is, false if
+	 * another reload is in progress.
+	 */
+	bool reload(
+		database_sources sources,
+		server_metrics& metrics,
+		std::function<void(const database_snapshot&)> on_publish
+	);
+
+	/**
+	 * @brief Loads a new snapshot from @e sources in the background, making
+	 * every chunk of @e chunk_size positions visible as soon as it is read.
+	 *
+	 * A new snapshot with all the chunks read so far is published after
+	 * every chunk. Every chunk only keeps the positions that are not in the
+	 * previous ones, and all of them are also added to a complete database,
+	 * so the files are read only once. That database, indexed, replaces the
+	 * chunks at the end. While loading, the chunks and the complete database
+	 * take about twice the memory of the database. Function @e on_publish is
+	 * called after every publication. The memory profile of @e sources is
+	 * ignored.
+	 * @returns Whether or not the loading was started, that is, false if
+	 * another reload is in progress.
+	 */
+	bool load_progressively(
+		database_sources sources,
+		server_metrics& metrics,
+		std::function<void(const database_snapshot&)> on_publish,
+		const size_t chunk_size
+	);
+
+	/// Is a reload in progress?
+	[[nodiscard]] bool reloading() const noexcept
+	{
+		return m_reloading.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	/// The current snapshot.
+	std::atomic<std::shared_ptr<const database_snapshot>> m_current;
+
+	/// Is a reload in progress?
+	std::atomic<bool> m_reloading = false;
+	/// Mutex to protect @ref m_loader.
+	std::mutex m_loader_mutex;
+	/// Thread loading the new snapshot. Declared last so that it is stopped
+	/// before anything else is destroyed.
+	std::jthread m_loader;
+};
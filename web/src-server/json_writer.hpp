@@ -0,0 +1,89 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <charconv>
+#include <cstddef>
+#include <string>
+
+// cpb includes
+#include <cpb/fen_parser.hpp>
+#include <cpb/position.hpp>
+
+/*
+ * Functions to write the bodies of the responses directly into their final
+ * string, without building temporary strings along the way.
+ */
+
+/// Appends the decimal representation of @e v to @e out.
+inline void append_size(std::string& out, const size_t v)
+{
+	char buf[24];
+	const auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+	out.append(buf, ptr);
+}
+
+/// Appends the FEN string of @e p to @e out.
+inline void append_fen(std::string& out, const cpb::position& p)
+{
+	char buf[cpb::MAX_FEN_LENGTH];
+	out.append(buf, cpb::make_fen(p, buf));
+}
+
+/// Appends the JSON field @e name with the string value @e v to @e out.
+inline void append_field(
+	std::string& out, const std::string_view name, const std::string_view v
+)
+{
+	out += '"';
+	out += name;
+	out += "\":\"";
+	out += v;
+	out += '"';
+}
+
+/// Appends the JSON field @e name with a number (as a string) to @e out.
+inline void
+append_field(std::string& out, const std::string_view name, const size_t v)
+{
+	out += '"';
+	out += name;
+	out += "\":\"";
+	append_size(out, v);
+	out += '"';
+}
+
+/// Appends the JSON field @e name with the FEN string of @e p to @e out.
+inline void append_field(
+	std::string& out, const std::string_view name, const cpb::position& p
+)
+{
+	out += '"';
+	out += name;
+	out += "\":\"";
+	append_fen(out, p);
+	out += '"';
+}
@@ -22,7 +22,11 @@
  */
 
 // C++ includes
+#include <algorithm>
+#include <optional>
 #include <fstream>
+#include <chrono>
+#include <thread>
 #include <print>
 
 // HTTP lib includes
@@ -33,14 +37,20 @@
 #include <ctree/memory_profile.hpp>
 
 // cpb includes
-#include <cpb/arena_allocator.hpp>
+#include <cpb/schema_builder.hpp>
+#include <cpb/index_layouts.hpp>
 #include <cpb/profiler.hpp>
 #include <cpb/database.hpp>
-#include <cpb/lichess.hpp>
 #include <cpb/formats.hpp>
 
 // server includes
 #include "src-server/app_router.hpp"
+#include "src-server/database_store.hpp"
+#include "src-server/asset_cache.hpp"
+#include "src-server/metrics.hpp"
+#include "src-server/query_cache.hpp"
+#include "src-server/query_pool.hpp"
+#include "src-server/session_store.hpp"
 #include "src-server/query.hpp"
 
 template <class... Args>
@@ -49,39 +59,6 @@ void printerr(std::format_string<Args...>&& fmt, Args&&...args)
 	std::print(std::cerr, std::move(fmt), std::forward<Args...>(args)...);
 }
 
-void load_lichess_database(
-	const std::string_view file,
-	const bool read_memory_profile,
-	cpb::PuzzleDatabase& db
-)
-{
-	PROFILE_FUNCTION;
-
-	const size_t initial_db_size = db.size();
-	const auto res =
-		(read_memory_profile ? cpb::lichess::load_database_initialized(file, db)
-							 : cpb::lichess::load_database(file, db));
-
-	if (res.has_value()) {
-		std::print("Total fen read: {}.\n", *res);
-		std::print("Added {} new positions.\n", db.size() - initial_db_size);
-		std::print(
-			"    From {} positions to {} positions.\n",
-			initial_db_size,
-			db.size()
-		);
-	}
-	else {
-		printerr("The database could not be read.\n");
-		if (res.error() == cpb::lichess::load_error::file_error) {
-			printerr("    File could not be loaded.\n");
-		}
-		else if (res.error() == cpb::lichess::load_error::invalid_position) {
-			printerr("    Contains some invalid position.\n");
-		}
-	}
-}
-
 int main(int argc, char *argv[])
 {
 	std::cout << "CPB_WORK_DIR: " << CPB_WORK_DIR << '\n';
@@ -95,6 +72,37 @@ int main(int argc, char *argv[])
 	bool read_memory_profile = false;
 	std::string_view input_memory_profile;
 
+	// token required by the administration routes, disabled if empty
+	std::string admin_token;
+
+	// memory budget of the cache of query results, in megabytes
+	size_t query_cache_size = 256;
+	// maximum number of sessions held by the server
+	size_t max_sessions = 100000;
+	// idle time, in minutes, after which a session is removed
+	size_t session_timeout = 30;
+	// threads evaluating queries, apart from those of the HTTP server
+	size_t query_threads =
+		std::max(2u, std::thread::hardware_concurrency() / 2);
+	// maximum number of queries of each priority waiting to be evaluated
+	size_t max_pending_queries = 32;
+	// time, in seconds, after which a query is cancelled
+	size_t query_timeout = 30;
+	// positions in every chunk of the database made visible while loading
+	size_t load_chunk_size = 100000;
+	// squares of the last levels of the database
+	cpb::square_levels square_levels;
+	// choose the squares of the last levels from a sample of the database
+	bool auto_square_levels = false;
+	// positions in the sample used to choose the square levels
+	size_t schema_sample_size = 100000;
+	// secondary layouts of the database used by the query planner
+	std::vector<cpb::index_layout> index_layouts;
+	// index the positions by pawn skeleton
+	bool index_pawns = false;
+	// index the positions by the squares of the kings
+	bool index_kings = false;
+
 	std::vector<std::pair<std::string_view, cpb::database_format>>
 		lichess_databases;
 
@@ -116,6 +124,73 @@ int main(int argc, char *argv[])
 			output_memory_profile = argv[i + 1];
 			++i;
 		}
+		else if (option_name == "--admin-token") {
+			admin_token = argv[i + 1];
+			++i;
+		}
+		else if (option_name == "--query-cache-size") {
+			query_cache_size = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--max-sessions") {
+			max_sessions = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--session-timeout") {
+			session_timeout = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--query-threads") {
+			query_threads = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--max-pending-queries") {
+			max_pending_queries = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--query-timeout") {
+			query_timeout = std::stoul(argv[i + 1]);
+			++i;
+		}
+		else if (option_name == "--load-chunk-size") {
+			load_chunk_size = std::max(1ul, std::stoul(argv[i + 1]));
+			++i;
+		}
+		else if (option_name == "--square-levels") {
+			if (std::string_view{argv[i + 1]} == "auto") {
+				auto_square_levels = true;
+				++i;
+				continue;
+			}
+			const std::optional<cpb::square_levels> levels =
+				cpb::parse_square_levels(argv[i + 1]);
+			if (not levels) {
+				printerr("Invalid square levels '{}'\n", argv[i + 1]);
+				return 1;
+			}
+			square_levels = *levels;
+			auto_square_levels = false;
+			++i;
+		}
+		else if (option_name == "--index-layouts") {
+			const auto layouts = cpb::parse_index_layouts(argv[i + 1]);
+			if (not layouts) {
+				printerr("Invalid index layouts '{}'\n", argv[i + 1]);
+				return 1;
+			}
+			index_layouts = *layouts;
+			++i;
+		}
+		else if (option_name == "--index-pawns") {
+			index_pawns = true;
+		}
+		else if (option_name == "--index-kings") {
+			index_kings = true;
+		}
+		else if (option_name == "--schema-sample-size") {
+			schema_sample_size = std::max(1ul, std::stoul(argv[i + 1]));
+			++i;
+		}
 #if defined USE_INSTRUMENTATION
 		else if (option_name == "--profiler-session") {
 			profiler_session = argv[i + 1];
@@ -136,39 +211,63 @@ int main(int argc, char *argv[])
 	PROFILER_START_SESSION(profiler_session, "id");
 	PROFILE_FUNCTION;
 
-	cpb::arena_allocator arena;
-	cpb::PuzzleDatabase db;
+	server_metrics metrics;
 
-	if (read_memory_profile) {
+	// a memory profile has its own square levels
+	if (auto_square_levels and not read_memory_profile and
+		not lichess_databases.empty()) {
 		std::print("--------------------------\n");
-		std::print("Reading memory profile '{}'.\n", input_memory_profile);
-
-		std::ifstream fin(input_memory_profile.data());
-
-		size_t total_bytes;
-		fin >> total_bytes;
-		std::print("    Total bytes: {}\n", total_bytes);
-		arena.initialize(total_bytes);
-
-		if (not fin.is_open()) {
-			printerr(
-				"Input memory profile file '{}' could not be opened.\n",
-				input_memory_profile
-			);
+		std::print(
+			"Choosing the square levels from {} positions of '{}'.\n",
+			schema_sample_size,
+			lichess_databases.front().first
+		);
+		const auto levels = cpb::choose_square_levels(
+			lichess_databases.front().first, schema_sample_size
+		);
+		if (not levels) {
+			if (levels.error() == cpb::lichess::load_error::file_error) {
+				printerr("Error when opening the file.\n");
+			}
+			else {
+				printerr("Invalid position found in the file.\n");
+			}
 			return 1;
 		}
-
-		classtree::initialize(db, fin, &arena);
-		fin.close();
+		square_levels = *levels;
+		std::print("    Square levels: {}\n", cpb::to_string(square_levels));
 	}
 
+	database_sources sources;
+	if (read_memory_profile) {
+		sources.memory_profile = input_memory_profile;
+	}
+	sources.levels = square_levels;
+	sources.layouts = index_layouts;
+	sources.index_pawns = index_pawns;
+	sources.index_kings = index_kings;
 	for (const auto& [file, format] : lichess_databases) {
-		if (format == cpb::database_format::lichess) {
-			std::cout << "--------------------------\n";
-			std::cout << "Loading lichess database " << file << '\n';
-			load_lichess_database(file, read_memory_profile, db);
+		sources.files.emplace_back(std::string{file}, format);
+	}
+
+	// Memory profiles describe the complete database: only then is the
+	// database loaded before the server starts. Otherwise, the server starts
+	// with an empty database and queries see the database as it is loaded.
+	const bool load_before_serving =
+		read_memory_profile or write_memory_profile;
+
+	std::shared_ptr<const database_snapshot> snapshot;
+	if (load_before_serving) {
+		snapshot = load_snapshot(sources, metrics);
+		if (snapshot == nullptr) {
+			return 1;
 		}
 	}
+	else {
+		const std::shared_ptr<database_snapshot> empty = new_snapshot();
+		empty->loaded_percent = sources.files.empty() ? 100 : 0;
+		snapshot = empty;
+	}
 
 	if (write_memory_profile) {
 		std::print("--------------------------\n");
@@ -181,14 +280,56 @@ int main(int argc, char *argv[])
 			);
 			return 1;
 		}
-		classtree::output_profile<true>(db, fout);
+		cpb::write_profile_header(fout, snapshot->index.levels);
+		classtree::output_profile<true>(snapshot->db, fout);
 		fout.close();
 	}
 
+	asset_cache assets;
+	{
+		std::print("--------------------------\n");
+		std::print("Loading static files.\n");
+		const size_t num_files = assets.load(CPB_WORK_DIR);
+		std::print(
+			"    Loaded {} files ({} bytes).\n", num_files, assets.num_bytes()
+		);
+	}
+
 	httplib::Server svr;
 
-	user_query_t user_query;
-	route_server(svr, db, user_query);
+	session_store user_query(
+		max_sessions,
+		std::chrono::minutes(session_timeout),
+		std::chrono::minutes(1)
+	);
+	query_cache cache(query_cache_size * 1024 * 1024);
+	query_pool pool(
+		query_threads, max_pending_queries, std::chrono::seconds(query_timeout)
+	);
+	database_store databases(std::move(snapshot));
+	if (not load_before_serving and not sources.files.empty()) {
+		[[maybe_unused]] const bool _ = databases.load_progressively(
+			sources,
+			metrics,
+			[&cache](const database_snapshot&)
+			{
+				// results of the previous snapshot are not useful anymore
+				cache.clear();
+			},
+			load_chunk_size
+		);
+	}
+	route_server(
+		svr,
+		metrics,
+		assets,
+		databases,
+		sources,
+		admin_token,
+		user_query,
+		cache,
+		pool
+	);
 
 	svr.listen("0.0.0.0", 8080);
 }
@@ -0,0 +1,252 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <iterator>
+#include <format>
+
+// custom includes
+#include "src-server/metrics.hpp"
+
+void latency_histogram::record(const std::chrono::nanoseconds d) noexcept
+{
+	const double seconds = std::chrono::duration<double>(d).count();
+	size_t b = 0;
+	while (b < BOUNDS.size() and seconds > BOUNDS[b]) {
+		++b;
+	}
+
+	slot& s = m_slots[this_thread_slot()];
+	s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+	s.sum_ns.fetch_add(
+		static_cast<uint64_t>(d.count()), std::memory_order_relaxed
+	);
+}
+
+latency_histogram::snapshot latency_histogram::read() const noexcept
+{
+	snapshot snap;
+	uint64_t sum_ns = 0;
+	for (const slot& s : m_slots) {
+		for (size_t b = 0; b < NUM_BUCKETS; ++b) {
+			const uint64_t n = s.buckets[b].load(std::memory_order_relaxed);
+			snap.buckets[b] += n;
+			snap.count += n;
+		}
+		sum_ns += s.sum_ns.load(std::memory_order_relaxed);
+	}
+	snap.sum = static_cast<double>(sum_ns) / 1e9;
+	return snap;
+}
+
+size_t latency_histogram::this_thread_slot() noexcept
+{
+	// threads are given slots in order of arrival
+	static std::atomic<size_t> next_slot = 0;
+	thread_local const size_t slot_index =
+		next_slot.fetch_add(1, std::memory_order_relaxed) % NUM_SLOTS;
+	return slot_index;
+}
+
+route_group server_metrics::group_of(const std::string_view path) noexcept
+{
+	if (path == "/query") {
+		return route_group::query;
+	}
+	if (path == "/progress") {
+		return route_group::progress;
+	}
+	if (path == "/next") {
+		return route_group::next;
+	}
+	if (path == "/previous") {
+		return route_group::previous;
+	}
+	if (path == "/goto") {
+		return route_group::go_to;
+	}
+	if (path == "/positions") {
+		return route_group::positions;
+	}
+	if (path == "/random") {
+		return route_group::random;
+	}
+	if (path == "/export") {
+		return route_group::export_positions;
+	}
+	if (path == "/facets") {
+		return route_group::facets;
+	}
+	if (path.empty() or path == "/" or path.starts_with("/js/") or
+		path.starts_with("/css/") or path.starts_with("/node_modules/")) {
+		return route_group::static_files;
+	}
+	return route_group::other;
+}
+
+std::string_view server_metrics::name_of(const route_group g) noexcept
+{
+	switch (g) {
+	case route_group::query:
+		return "query";
+	case route_group::progress:
+		return "progress";
+	case route_group::next:
+		return "next";
+	case route_group::previous:
+		return "previous";
+	case route_group::go_to:
+		return "goto";
+	case route_group::positions:
+		return "positions";
+	case route_group::random:
+		return "random";
+	case route_group::export_positions:
+		return "export";
+	case route_group::facets:
+		return "facets";
+	case route_group::static_files:
+		return "static";
+	case route_group::other:
+		return "other";
+	}
+	return "other";
+}
+
+void server_metrics::add_load(load_record&& r)
+{
+	std::lock_guard lock(m_loads_mutex);
+	const auto it = std::find_if(
+		m_loads.begin(),
+		m_loads.end(),
+		[&](const load_record& l) noexcept
+		{
+			return l.file == r.file;
+		}
+	);
+	if (it != m_loads.end()) {
+		*it = std::move(r);
+	}
+	else {
+		m_loads.push_back(std::move(r));
+	}
+}
+
+std::vector<load_record> server_metrics::loads() const
+{
+	std::lock_guard lock(m_loads_mutex);
+	return m_loads;
+}
+
+void server_metrics::write(std::string& out) const
+{
+	out += "# HELP cpb_request_duration_seconds Latency of the requests.\n";
+	out += "# TYPE cpb_request_duration_seconds histogram\n";
+	for (size_t g = 0; g < NUM_GROUPS; ++g) {
+		const std::string_view name = name_of(static_cast<route_group>(g));
+		const latency_histogram::snapshot snap = m_histograms[g].read();
+
+		// buckets are cumulative in the Prometheus format
+		uint64_t cumulative = 0;
+		for (size_t b = 0; b < latency_histogram::NUM_BUCKETS; ++b) {
+			cumulative += snap.buckets[b];
+			const std::string le =
+				b < latency_histogram::BOUNDS.size()
+					? std::format("{}", latency_histogram::BOUNDS[b])
+					: std::string{"+Inf"};
+			std::format_to(
+				std::back_inserter(out),
+				"cpb_request_duration_seconds_bucket"
+				"{{route=\"{}\",le=\"{}\"}} {}\n",
+				name,
+				le,
+				cumulative
+			);
+		}
+		std::format_to(
+			std::back_inserter(out),
+			"cpb_request_duration_seconds_sum{{route=\"{}\"}} {}\n",
+			name,
+			snap.sum
+		);
+		std::format_to(
+			std::back_inserter(out),
+			"cpb_request_duration_seconds_count{{route=\"{}\"}} {}\n",
+			name,
+			snap.count
+		);
+	}
+
+	const std::vector<load_record> records = loads();
+	out += "# HELP cpb_database_load_seconds Time to load a database file.\n";
+	out += "# TYPE cpb_database_load_seconds gauge\n";
+	for (const load_record& r : records) {
+		std::format_to(
+			std::back_inserter(out),
+			"cpb_database_load_seconds{{file=\"{}\"}} {}\n",
+			r.file,
+			r.seconds
+		);
+	}
+	out += "# HELP cpb_database_positions_read Positions read from a file.\n";
+	out += "# TYPE cpb_database_positions_read gauge\n";
+	for (const load_record& r : records) {
+		std::format_to(
+			std::back_inserter(out),
+			"cpb_database_positions_read{{file=\"{}\"}} {}\n",
+			r.file,
+			r.positions_read
+		);
+	}
+	out += "# HELP cpb_database_positions_added New positions from a file.\n";
+	out += "# TYPE cpb_database_positions_added gauge\n";
+	for (const load_record& r : records) {
+		std::format_to(
+			std::back_inserter(out),
+			"cpb_database_positions_added{{file=\"{}\"}} {}\n",
+			r.file,
+			r.positions_added
+		);
+	}
+}
+
+void write_metric(
+	std::string& out,
+	const std::string_view name,
+	const std::string_view type,
+	const std::string_view help,
+	const double value
+)
+{
+	std::format_to(
+		std::back_inserter(out),
+		"# HELP {} {}\n# TYPE {} {}\n{} {}\n",
+		name,
+		help,
+		name,
+		type,
+		name,
+		value
+	);
+}
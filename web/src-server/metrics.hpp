@@ -0,0 +1,197 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <array>
+#include <mutex>
+
+/**
+ * @brief Histogram of latencies that can be recorded from many threads.
+ *
+ * Every thread records into its own slot of counters, so recording is a
+ * couple of uncontended atomic increments and never takes a lock. Reading
+ * the histogram adds up all the slots.
+ */
+class latency_histogram {
+public:
+
+	/// Upper bounds of the buckets, in seconds. The last bucket is unbounded.
+	static constexpr std::array<double, 16> BOUNDS = {
+		0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+		0.05,	0.1,	 0.25,	 0.5,	1.0,	2.5,   5.0,	 10.0
+	};
+	/// Number of buckets.
+	static constexpr size_t NUM_BUCKETS = BOUNDS.size() + 1;
+
+	/// Contents of the histogram at some point in time.
+	struct snapshot {
+		/// Number of samples in every bucket (not cumulative).
+		std::array<uint64_t, NUM_BUCKETS> buckets{};
+		/// Number of samples.
+		uint64_t count = 0;
+		/// Sum of all samples, in seconds.
+		double sum = 0;
+	};
+
+	/// Adds a sample of duration @e d.
+	void record(const std::chrono::nanoseconds d) noexcept;
+
+	/// Returns the contents of the histogram.
+	[[nodiscard]] snapshot read() const noexcept;
+
+private:
+
+	/// Number of slots. Threads share slots if there are more threads.
+	static constexpr size_t NUM_SLOTS = 32;
+
+	/// Counters of a thread, aligned to avoid false sharing.
+	struct alignas(64) slot {
+		/// Number of samples in every bucket.
+		std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+		/// Sum of all samples, in nanoseconds.
+		std::atomic<uint64_t> sum_ns = 0;
+	};
+
+	/// Returns the index of the slot of the calling thread.
+	[[nodiscard]] static size_t this_thread_slot() noexcept;
+
+private:
+
+	/// The slots of the threads.
+	std::array<slot, NUM_SLOTS> m_slots;
+};
+
+/// The groups of routes whose latency is measured.
+enum class route_group : uint8_t {
+	query,
+	progress,
+	next,
+	previous,
+	go_to,
+	positions,
+	random,
+	export_positions,
+	facets,
+	static_files,
+	other,
+};
+
+/// Time it took to load a database file.
+struct load_record {
+	/// Name of the file.
+	std::string file;
+	/// Time it took, in seconds.
+	double seconds;
+	/// Number of positions read from the file.
+	size_t positions_read;
+	/// Number of new positions added to the database.
+	size_t positions_added;
+};
+
+/**
+ * @brief Metrics of the web server.
+ *
+ * Holds the latency histograms of all routes and the times it took to load
+ * the databases. Everything else is read from its owner when the metrics
+ * are requested.
+ */
+class server_metrics {
+public:
+
+	/// Returns the route group of the path of a request.
+	[[nodiscard]] static route_group
+	group_of(const std::string_view path) noexcept;
+
+	/// Returns the name of a route group.
+	[[nodiscard]] static std::string_view
+	name_of(const route_group g) noexcept;
+
+	/// Number of route groups.
+	static constexpr size_t NUM_GROUPS =
+		static_cast<size_t>(route_group::other) + 1;
+
+	/// Returns the histogram of route group @e g.
+	[[nodiscard]] latency_histogram& histogram(const route_group g) noexcept
+	{
+		return m_histograms[static_cast<size_t>(g)];
+	}
+	/// Returns the histogram of route group @e g.
+	[[nodiscard]] const latency_histogram&
+	histogram(const route_group g) const noexcept
+	{
+		return m_histograms[static_cast<size_t>(g)];
+	}
+
+	/**
+	 * @brief Records that loading a database file took some time.
+	 *
+	 * The record replaces that of an earlier load of the same file, so that
+	 * every file has a single series.
+	 */
+	void add_load(load_record&& r);
+
+	/// Returns the times it took to load the database files.
+	[[nodiscard]] std::vector<load_record> loads() const;
+
+	/**
+	 * @brief Appends the latency histograms and the loading times to @e out.
+	 *
+	 * The metrics are written in the Prometheus text format.
+	 */
+	void write(std::string& out) const;
+
+private:
+
+	/// One histogram for every route group.
+	std::array<latency_histogram, NUM_GROUPS> m_histograms;
+
+	/// Times it took to load the database files.
+	std::vector<load_record> m_loads;
+	/// Mutex to protect @ref m_loads.
+	mutable std::mutex m_loads_mutex;
+};
+
+/**
+ * @brief Appends one metric to @e out in the Prometheus text format.
+ * @param out The output.
+ * @param name Name of the metric.
+ * @param type Type of the metric ("gauge", "counter").
+ * @param help Description of the metric.
+ * @param value Value of the metric.
+ */
+void write_metric(
+	std::string& out,
+	const std::string_view name,
+	const std::string_view type,
+	const std::string_view help,
+	const double value
+);
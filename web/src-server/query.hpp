@@ -24,46 +24,62 @@
 #pragma once
 
 // C++ includes
-#include <string>
-#include <map>
-
-// ctree includes
-#include <ctree/ctree.hpp>
-#include <ctree/range_iterator.hpp>
+#include <stop_token>
+#include <memory>
+#include <atomic>
 
 // cpb includes
+#include <cpb/query_result.hpp>
 #include <cpb/query.hpp>
-#include <cpb/position.hpp>
 
-typedef classtree::const_range_iterator<
-	cpb::position,
-	void,
-	char, // white pawns
-	char, // black pawns
-	char, // white rooks
-	char, // black rooks
-	char, // white knights
-	char, // black knights
-	char, // white bishops
-	char, // black bishops
-	char, // white queens
-	char, // black queens
-	char, // player turn
-	char, // fake: a8
-	char, // fake: b8
-	char, // fake: c8
-	char, // fake: d8
-	char  // fake: e8
-	>
-	iterator_t;
+/**
+ * @brief The evaluation of a query running in the background.
+ *
+ * The number of positions found so far can be read at any time. The result
+ * can be read only after @ref finished is set.
+ */
+struct query_progress {
+	/// Number of positions found so far.
+	std::atomic<size_t> num_found = 0;
+	/// Is the evaluation finished? Set after @ref result.
+	std::atomic<bool> finished = false;
+	/// The result, null if the evaluation was cancelled.
+	std::shared_ptr<const cpb::query_result> result;
+	/// Used to cancel the evaluation.
+	std::stop_source stop;
+};
 
 struct web_query {
 	cpb::querier Q;
-	iterator_t it;
+	/// The evaluation of the query, null if the result was already known.
+	std::shared_ptr<query_progress> progress;
+	/// The result, null while the query is being evaluated.
+	std::shared_ptr<const cpb::query_result> result;
 	size_t current;
-	size_t total;
-};
 
-typedef std::map<std::string, web_query> user_query_t;
+	/**
+	 * @brief Is the result of the query available?
+	 *
+	 * Takes the result from the evaluation of the query, if it finished.
+	 */
+	[[nodiscard]] bool ready() noexcept
+	{
+		if (result == nullptr and progress != nullptr and
+			progress->finished.load(std::memory_order_acquire)) {
+			result = progress->result;
+		}
+		return result != nullptr;
+	}
 
-void parse_query_body(const std::string_view s, cpb::querier& Q) noexcept;
+	/**
+	 * @brief Was the evaluation of the query cancelled?
+	 *
+	 * The result of a cancelled query never becomes available.
+	 */
+	[[nodiscard]] bool cancelled() const noexcept
+	{
+		return result == nullptr and progress != nullptr and
+			   progress->finished.load(std::memory_order_acquire) and
+			   progress->result == nullptr;
+	}
+};
@@ -0,0 +1,144 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <memory>
+#include <string>
+#include <mutex>
+
+// cpb includes
+#include <cpb/query_parser.hpp>
+
+// custom includes
+#include "src-server/query_cache.hpp"
+#include "src-server/query.hpp"
+
+/// Returns the key of query @e Q on the database with version @e version.
+[[nodiscard]] static std::string
+make_key(const cpb::querier& Q, const uint64_t version)
+{
+	return std::to_string(version) + ":" + cpb::make_query_key(Q);
+}
+
+std::shared_ptr<const cpb::query_result>
+query_cache::find(const cpb::querier& Q, const uint64_t version)
+{
+	const std::string key = make_key(Q, version);
+
+	std::lock_guard lock(m_mutex);
+	const auto it = m_positions.find(key);
+	if (it == m_positions.end()) {
+		++m_misses;
+		return nullptr;
+	}
+
+	// move the entry to the front of the list
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	++m_hits;
+	return it->second->second;
+}
+
+std::shared_ptr<const cpb::query_result> query_cache::build(
+	const std::shared_ptr<const database_snapshot>& snapshot,
+	const cpb::querier& Q,
+	const std::stop_token& stop,
+	std::atomic<size_t> *const num_found
+)
+{
+	// the result points into the database: it has to keep it alive
+	struct result_in_snapshot {
+		std::shared_ptr<const database_snapshot> snapshot;
+		cpb::query_result result;
+	};
+	auto holder = std::make_shared<result_in_snapshot>();
+	holder->snapshot = snapshot;
+	const bool completed = holder->result.build(
+		snapshot->parts(), Q, stop, num_found, &snapshot->index
+	);
+	if (not completed) {
+		return nullptr;
+	}
+	const std::shared_ptr<const cpb::query_result> result(
+		holder, &holder->result
+	);
+
+	const std::string key = make_key(Q, snapshot->version);
+
+	std::lock_guard lock(m_mutex);
+
+	// another thread may have built the same result in the meantime
+	const auto it = m_positions.find(key);
+	if (it != m_positions.end()) {
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return it->second->second;
+	}
+
+	m_entries.emplace_front(key, result);
+	m_positions.emplace(key, m_entries.begin());
+	m_bytes += result->num_bytes();
+	evict();
+	return result;
+}
+
+void query_cache::clear() noexcept
+{
+	std::lock_guard lock(m_mutex);
+	m_entries.clear();
+	m_positions.clear();
+	m_bytes = 0;
+}
+
+size_t query_cache::size() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_entries.size();
+}
+
+size_t query_cache::num_bytes() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_bytes;
+}
+
+size_t query_cache::num_hits() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_hits;
+}
+
+size_t query_cache::num_misses() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_misses;
+}
+
+void query_cache::evict() noexcept
+{
+	// always keep the most recent result, even if it exceeds the budget
+	while (m_bytes > m_max_bytes and m_entries.size() > 1) {
+		const entry& e = m_entries.back();
+		m_bytes -= e.second->num_bytes();
+		m_positions.erase(e.first);
+		m_entries.pop_back();
+	}
+}
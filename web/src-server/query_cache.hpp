@@ -0,0 +1,131 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <unordered_map>
+#include <stop_token>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <mutex>
+#include <list>
+
+// cpb includes
+#include <cpb/query_result.hpp>
+#include <cpb/database.hpp>
+#include <cpb/query.hpp>
+
+// custom includes
+#include "src-server/database_store.hpp"
+
+/**
+ * @brief Cache of query results shared by all users.
+ *
+ * Results are indexed by the version of the database and the normalized form
+ * of the query (see @ref cpb::make_query_key), and evicted in
+ * least-recently-used order whenever the memory they use exceeds the budget.
+ * Evicting a result does not invalidate it for the sessions that still hold
+ * it.
+ */
+class query_cache {
+public:
+
+	/// Constructor with the memory budget in bytes.
+	explicit query_cache(const size_t max_bytes) noexcept
+		: m_max_bytes(max_bytes)
+	{}
+
+	/**
+	 * @brief Returns the result of query @e Q on a database if it is in the
+	 * cache.
+	 * @param Q The query.
+	 * @param version Version of the database snapshot.
+	 * @returns The result, or a null pointer if it is not in the cache.
+	 */
+	[[nodiscard]] std::shared_ptr<const cpb::query_result>
+	find(const cpb::querier& Q, const uint64_t version);
+
+	/**
+	 * @brief Evaluates query @e Q on @e snapshot and stores the result.
+	 *
+	 * The query is evaluated outside the lock. If another thread stored the
+	 * same result in the meantime, that one is returned instead. The result
+	 * keeps the snapshot alive.
+	 * @param snapshot The database.
+	 * @param Q The query.
+	 * @param stop Used to cancel the evaluation of the query.
+	 * @param num_found If not null, updated with the number of positions
+	 * found so far.
+	 * @returns The result, or a null pointer if the evaluation was cancelled.
+	 */
+	[[nodiscard]] std::shared_ptr<const cpb::query_result> build(
+		const std::shared_ptr<const database_snapshot>& snapshot,
+		const cpb::querier& Q,
+		const std::stop_token& stop,
+		std::atomic<size_t> *const num_found = nullptr
+	);
+
+	/// Removes all results from the cache.
+	void clear() noexcept;
+
+	/// Number of results in the cache.
+	[[nodiscard]] size_t size() const noexcept;
+	/// Number of bytes used by the results in the cache.
+	[[nodiscard]] size_t num_bytes() const noexcept;
+	/// Number of queries answered from the cache.
+	[[nodiscard]] size_t num_hits() const noexcept;
+	/// Number of queries not found in the cache.
+	[[nodiscard]] size_t num_misses() const noexcept;
+
+private:
+
+	/// Removes the least recently used results until the budget is met.
+	void evict() noexcept;
+
+private:
+
+	typedef std::pair<std::string, std::shared_ptr<const cpb::query_result>>
+		entry;
+	typedef std::list<entry> entry_list;
+
+	/// Results, from most recently used to least recently used.
+	entry_list m_entries;
+	/// Position in @ref m_entries of every key.
+	std::unordered_map<std::string, entry_list::iterator> m_positions;
+
+	/// Memory budget.
+	const size_t m_max_bytes;
+	/// Bytes used by the results in the cache.
+	size_t m_bytes = 0;
+
+	/// Number of queries answered from the cache.
+	size_t m_hits = 0;
+	/// Number of queries not found in the cache.
+	size_t m_misses = 0;
+
+	/// Mutex to protect all the members above.
+	mutable std::mutex m_mutex;
+};
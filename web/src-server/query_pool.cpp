@@ -0,0 +1,228 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <mutex>
+
+// custom includes
+#include "src-server/query_pool.hpp"
+
+query_pool::query_pool(
+	const size_t num_threads,
+	const size_t max_pending,
+	const clock::duration timeout
+)
+	: m_max_pending(max_pending),
+	  m_timeout(timeout)
+{
+	const size_t n = std::max<size_t>(2, num_threads);
+	m_threads.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		// the first thread is reserved for interactive work
+		m_threads.emplace_back(
+			[this, i](std::stop_token stop)
+			{
+				work(stop, i == 0);
+			}
+		);
+	}
+
+	m_watchdog = std::jthread(
+		[this](std::stop_token stop)
+		{
+			watch(stop);
+		}
+	);
+}
+
+query_status query_pool::run(
+	const query_priority priority, std::function<void(std::stop_token)> f
+)
+{
+	const std::shared_ptr<job> j = enqueue(priority, std::move(f));
+	if (j == nullptr) {
+		return query_status::rejected;
+	}
+
+	// the job is always run, even if it was cancelled before it started, and
+	// is expected to return soon after its deadline
+	j->done.get_future().wait();
+	if (j->failed) {
+		return query_status::failed;
+	}
+	return j->stop.stop_requested() ? query_status::timed_out
+									: query_status::completed;
+}
+
+std::optional<std::stop_source> query_pool::submit(
+	const query_priority priority, std::function<void(std::stop_token)> f
+)
+{
+	const std::shared_ptr<job> j = enqueue(priority, std::move(f));
+	if (j == nullptr) {
+		return {};
+	}
+	return j->stop;
+}
+
+std::shared_ptr<query_pool::job> query_pool::enqueue(
+	const query_priority priority, std::function<void(std::stop_token)> f
+)
+{
+	auto j = std::make_shared<job>();
+	j->f = std::move(f);
+	// exports are limited by the network, not by the work they do: they are
+	// stopped by their sink instead
+	j->deadline = priority == query_priority::exporting
+					  ? clock::time_point::max()
+					  : clock::now() + m_timeout;
+
+	{
+		std::lock_guard lock(m_mutex);
+		auto& queue = m_pending[static_cast<size_t>(priority)];
+		if (queue.size() >= m_max_pending) {
+			++m_num_rejected;
+			return nullptr;
+		}
+		queue.push_back(j);
+	}
+	// the reserved thread may not be able to take this job
+	m_cv.notify_all();
+	return j;
+}
+
+size_t query_pool::num_pending() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	size_t total = 0;
+	for (const auto& queue : m_pending) {
+		total += queue.size();
+	}
+	return total;
+}
+
+size_t query_pool::num_rejected() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_num_rejected;
+}
+
+size_t query_pool::num_timed_out() const noexcept
+{
+	std::lock_guard lock(m_mutex);
+	return m_num_timed_out;
+}
+
+void query_pool::work(std::stop_token stop, const bool interactive_only)
+{
+	while (true) {
+		std::shared_ptr<job> j;
+		{
+			std::unique_lock lock(m_mutex);
+			const bool found = m_cv.wait(
+				lock,
+				stop,
+				[&]
+				{
+					j = pop(interactive_only);
+					return j != nullptr;
+				}
+			);
+			if (not found) {
+				return;
+			}
+			m_running.push_back(j);
+		}
+
+		// cancelled jobs are run too, they return as soon as they start; an
+		// exception must not kill the thread nor leave the job unfinished
+		try {
+			j->f(j->stop.get_token());
+		}
+		catch (const std::exception& e) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "A job of the pool threw: " << e.what() << '\n';
+			j->failed = true;
+		}
+		catch (...) {
+			std::cerr << __PRETTY_FUNCTION__ << '\n';
+			std::cerr << "A job of the pool threw.\n";
+			j->failed = true;
+		}
+		j->done.set_value();
+
+		std::lock_guard lock(m_mutex);
+		std::erase(m_running, j);
+	}
+}
+
+std::shared_ptr<query_pool::job> query_pool::pop(const bool interactive_only)
+{
+	const size_t num_queues = interactive_only ? 1 : NUM_PRIORITIES;
+	for (size_t p = 0; p < num_queues; ++p) {
+		if (not m_pending[p].empty()) {
+			std::shared_ptr<job> j = std::move(m_pending[p].front());
+			m_pending[p].pop_front();
+			return j;
+		}
+	}
+	return nullptr;
+}
+
+void query_pool::watch(std::stop_token stop)
+{
+	// deadlines are checked with a precision of a tenth of the timeout
+	const clock::duration interval = std::max<clock::duration>(
+		m_timeout / 10, std::chrono::milliseconds(10)
+	);
+
+	std::unique_lock lock(m_mutex);
+	while (not stop.stop_requested()) {
+		// returns early only when a stop is requested
+		m_watchdog_cv.wait_for(
+			lock,
+			stop,
+			interval,
+			[]
+			{
+				return false;
+			}
+		);
+
+		const clock::time_point now = clock::now();
+		const auto cancel_if_late = [&](const std::shared_ptr<job>& j)
+		{
+			if (j->deadline <= now and not j->stop.stop_requested()) {
+				j->stop.request_stop();
+				++m_num_timed_out;
+			}
+		};
+		for (const auto& queue : m_pending) {
+			std::for_each(queue.begin(), queue.end(), cancel_if_late);
+		}
+		std::for_each(m_running.begin(), m_running.end(), cancel_if_late);
+	}
+}
@@ -0,0 +1,199 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <condition_variable>
+#include <stop_token>
+#include <functional>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <array>
+#include <deque>
+#include <mutex>
+
+/// Priority classes of the work done by the @ref query_pool.
+enum class query_priority : uint8_t {
+	/// Navigation through the results of a query.
+	interactive = 0,
+	/// Evaluation of a query on the database.
+	counting = 1,
+	/// Export of the results of a query. Exports have no deadline.
+	exporting = 2,
+};
+
+/// Outcome of the work sent to a @ref query_pool.
+enum class query_status : uint8_t {
+	/// The work was completed.
+	completed,
+	/// The pool was full and the work was not accepted.
+	rejected,
+	/// The work did not finish in time and was cancelled.
+	timed_out,
+	/// The work threw an exception.
+	failed,
+};
+
+/**
+ * @brief Bounded pool of threads that evaluate queries.
+ *
+ * Expensive queries are evaluated in this pool instead of in the threads of
+ * the HTTP server, so that they cannot make the server unresponsive.
+ *
+ * - Pending work is served in order of priority, and one of the threads only
+ * serves interactive work so that it is never stuck behind a heavy query.
+ * - The number of pending jobs of every priority is bounded, and further
+ * work is rejected instead of queued.
+ * - Work that does not finish in time is cancelled through its stop token.
+ * A watchdog thread checks the deadlines of the jobs regularly. Exports,
+ * which are paced by the client, have no deadline.
+ *
+ * Work can be waited for (see @ref run) or left to run in the background
+ * (see @ref submit).
+ */
+class query_pool {
+public:
+
+	/// Clock used to measure timeouts.
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Constructor.
+	 * @param num_threads Number of threads of the pool, at least 2.
+	 * @param max_pending Maximum number of pending jobs of every priority.
+	 * @param timeout Maximum time a job may wait and run for.
+	 */
+	query_pool(
+		const size_t num_threads,
+		const size_t max_pending,
+		const clock::duration timeout
+	);
+
+	/**
+	 * @brief Runs @e f in the pool and waits for it to finish.
+	 *
+	 * Function @e f receives a stop token that is triggered when the timeout
+	 * of the pool has elapsed, unless @e priority is
+	 * @ref query_priority::exporting; it should check it regularly and return
+	 * early when it is. Either way, this function does not return while @e f is
+	 * running, so @e f may safely capture local variables by reference.
+	 * Exceptions thrown by @e f are logged and reported as
+	 * @ref query_status::failed.
+	 */
+	query_status
+	run(const query_priority priority, std::function<void(std::stop_token)> f);
+
+	/**
+	 * @brief Runs @e f in the pool in the background.
+	 *
+	 * Function @e f receives a stop token that is triggered when the timeout
+	 * of the pool has elapsed or when a stop is requested through the stop
+	 * source returned; it should check it regularly and return early when
+	 * it is. Jobs cancelled before they start are run all the same, and
+	 * should return as soon as they start. Exceptions thrown by @e f are
+	 * logged.
+	 * @returns A stop source to cancel the job, or nothing if the job was
+	 * rejected.
+	 */
+	[[nodiscard]] std::optional<std::stop_source> submit(
+		const query_priority priority, std::function<void(std::stop_token)> f
+	);
+
+	/// Number of jobs waiting to be run.
+	[[nodiscard]] size_t num_pending() const noexcept;
+	/// Number of jobs rejected because the pool was full.
+	[[nodiscard]] size_t num_rejected() const noexcept;
+	/// Number of jobs cancelled because they did not finish in time.
+	[[nodiscard]] size_t num_timed_out() const noexcept;
+
+private:
+
+	/// Number of priority classes.
+	static constexpr size_t NUM_PRIORITIES = 3;
+
+	/// A job sent to the pool.
+	struct job {
+		/// The work to do.
+		std::function<void(std::stop_token)> f;
+		/// Used to cancel the work.
+		std::stop_source stop;
+		/// Set when the work is finished, whether or not it threw.
+		std::promise<void> done;
+		/// Did the work throw an exception? Set before @ref done.
+		bool failed = false;
+		/// Time by which the work has to be finished.
+		clock::time_point deadline;
+	};
+
+	/// Adds a new job to the queue of @e priority.
+	/// @returns The job, or a null pointer if the queue was full.
+	[[nodiscard]] std::shared_ptr<job> enqueue(
+		const query_priority priority, std::function<void(std::stop_token)> f
+	);
+
+	/// Main loop of the threads of the pool.
+	void work(std::stop_token stop, const bool interactive_only);
+
+	/// Removes the next job a thread may run. Requires holding the lock.
+	[[nodiscard]] std::shared_ptr<job> pop(const bool interactive_only);
+
+	/// Cancels the jobs past their deadline every so often until stopped.
+	void watch(std::stop_token stop);
+
+private:
+
+	/// Pending jobs, one queue per priority.
+	std::array<std::deque<std::shared_ptr<job>>, NUM_PRIORITIES> m_pending;
+	/// Jobs being run.
+	std::vector<std::shared_ptr<job>> m_running;
+	/// Maximum number of pending jobs of every priority.
+	const size_t m_max_pending;
+	/// Maximum time a job may wait and run for.
+	const clock::duration m_timeout;
+
+	/// Number of jobs rejected because the pool was full.
+	size_t m_num_rejected = 0;
+	/// Number of jobs cancelled because they did not finish in time.
+	size_t m_num_timed_out = 0;
+
+	/// Mutex to protect all the members above.
+	mutable std::mutex m_mutex;
+	/// Used to wake up the threads when there is new work.
+	std::condition_variable_any m_cv;
+
+	/// Used to wake up the watchdog when the pool is destroyed.
+	std::condition_variable_any m_watchdog_cv;
+
+	/// The threads of the pool. Declared last so that they are stopped
+	/// before anything else is destroyed.
+	std::vector<std::jthread> m_threads;
+	/// Thread that cancels the jobs past their deadline.
+	std::jthread m_watchdog;
+};
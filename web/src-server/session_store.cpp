@@ -0,0 +1,117 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+// C++ includes
+#include <algorithm>
+#include <string>
+#include <mutex>
+
+// custom includes
+#include "src-server/session_store.hpp"
+
+session_store::session_store(
+	const size_t max_sessions,
+	const clock::duration idle_timeout,
+	const clock::duration sweep_interval
+)
+	: m_num_shards(std::clamp<size_t>(max_sessions, 1, NUM_SHARDS)),
+	  m_max_per_shard(std::max<size_t>(1, max_sessions / m_num_shards)),
+	  m_idle_timeout(idle_timeout),
+	  m_sweep_interval(sweep_interval),
+	  m_sweeper(
+		  [this](std::stop_token stop)
+		  {
+			  sweep(stop);
+		  }
+	  )
+{ }
+
+bool session_store::insert(const std::string& id, web_query&& q)
+{
+	shard& s = get_shard(id);
+	std::lock_guard lock(s.mutex);
+	if (s.index.contains(id)) {
+		return false;
+	}
+
+	if (s.sessions.size() >= m_max_per_shard) {
+		s.index.erase(s.sessions.back().id);
+		s.sessions.pop_back();
+		m_num_evicted.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	s.sessions.emplace_front(id, std::move(q), clock::now());
+	s.index.emplace(id, s.sessions.begin());
+	return true;
+}
+
+size_t session_store::expire()
+{
+	const clock::time_point oldest_allowed = clock::now() - m_idle_timeout;
+
+	size_t removed = 0;
+	for (shard& s : m_shards) {
+		std::lock_guard lock(s.mutex);
+		// sessions are sorted by last access, the idle ones are at the back
+		while (not s.sessions.empty() and
+			   s.sessions.back().last_access < oldest_allowed) {
+			s.index.erase(s.sessions.back().id);
+			s.sessions.pop_back();
+			++removed;
+		}
+	}
+
+	m_num_expired.fetch_add(removed, std::memory_order_relaxed);
+	return removed;
+}
+
+size_t session_store::size() const noexcept
+{
+	size_t total = 0;
+	for (const shard& s : m_shards) {
+		std::lock_guard lock(s.mutex);
+		total += s.sessions.size();
+	}
+	return total;
+}
+
+void session_store::sweep(std::stop_token stop)
+{
+	std::unique_lock lock(m_sweeper_mutex);
+	while (not stop.stop_requested()) {
+		// returns early only when a stop is requested
+		m_sweeper_cv.wait_for(
+			lock,
+			stop,
+			m_sweep_interval,
+			[]
+			{
+				return false;
+			}
+		);
+		if (stop.stop_requested()) {
+			break;
+		}
+		expire();
+	}
+}
@@ -0,0 +1,195 @@
+/**
+ * Web Server of the Chess Puzzle Database Explorer
+ * Copyright (C) 2025 - 2026  Lluís Alemany Puig
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Contact:
+ *
+ * 		Lluís Alemany Puig
+ * 		https://github.com/lluisalemanypuig
+ */
+
+#pragma once
+
+// C++ includes
+#include <condition_variable>
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <array>
+#include <mutex>
+#include <list>
+
+// custom includes
+#include "src-server/query.hpp"
+
+/**
+ * @brief Concurrent table of the sessions of the users.
+ *
+ * Sessions are distributed among a fixed number of shards by the hash of
+ * their id, and every shard has its own lock. Requests of different users
+ * rarely compete for the same lock, so session operations scale with the
+ * number of threads of the server.
+ *
+ * The memory used by the table is bounded in two ways. Every shard keeps its
+ * sessions in order of last access and, when full, evicts the least recently
+ * used one to make room for a new session. A background thread periodically
+ * removes the sessions that have been idle for longer than a timeout.
+ */
+class session_store {
+public:
+
+	/// Clock used to measure the idleness of sessions.
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Constructor.
+	 *
+	 * Starts the thread that sweeps the idle sessions.
+	 * @param max_sessions Maximum number of sessions held at the same time,
+	 * rounded down to a multiple of the number of shards used (see
+	 * @ref max_size).
+	 * @param idle_timeout Sessions not accessed for this long are removed.
+	 * @param sweep_interval Time between two sweeps of idle sessions.
+	 */
+	session_store(
+		const size_t max_sessions,
+		const clock::duration idle_timeout,
+		const clock::duration sweep_interval
+	);
+
+	/**
+	 * @brief Calls @e f on the session with identifier @e id.
+	 *
+	 * Function @e f is called while holding the lock of the session's shard,
+	 * so it should do as little work as possible. Accessing a session makes
+	 * it the most recently used one of its shard.
+	 * @returns Whether or not the session exists.
+	 */
+	template <typename function_t>
+	bool with_session(const std::string& id, function_t&& f)
+	{
+		shard& s = get_shard(id);
+		std::lock_guard lock(s.mutex);
+		const auto it = s.index.find(id);
+		if (it == s.index.end()) {
+			return false;
+		}
+		s.sessions.splice(s.sessions.begin(), s.sessions, it->second);
+		it->second->last_access = clock::now();
+		f(it->second->query);
+		return true;
+	}
+
+	/**
+	 * @brief Adds a new session with identifier @e id.
+	 *
+	 * If the shard of the session is full, its least recently used session
+	 * is evicted.
+	 * @returns Whether or not the session was added, that is, false if
+	 * there already was a session with the same identifier.
+	 */
+	bool insert(const std::string& id, web_query&& q);
+
+	/**
+	 * @brief Removes the sessions that have been idle for too long.
+	 * @returns The number of sessions removed.
+	 */
+	size_t expire();
+
+	/// Total number of sessions.
+	[[nodiscard]] size_t size() const noexcept;
+	/// Maximum number of sessions, as enforced by the shards used.
+	[[nodiscard]] size_t max_size() const noexcept
+	{
+		return m_max_per_shard * m_num_shards;
+	}
+	/// Number of sessions removed for being idle.
+	[[nodiscard]] size_t num_expired() const noexcept
+	{
+		return m_num_expired.load(std::memory_order_relaxed);
+	}
+	/// Number of sessions evicted to make room for new ones.
+	[[nodiscard]] size_t num_evicted() const noexcept
+	{
+		return m_num_evicted.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	/// Maximum number of shards.
+	static constexpr size_t NUM_SHARDS = 64;
+
+	/// A session and the last time it was accessed.
+	struct entry {
+		/// Identifier of the session.
+		std::string id;
+		/// The session.
+		web_query query;
+		/// Last time the session was accessed.
+		clock::time_point last_access;
+	};
+
+	/// A part of the table, aligned to avoid false sharing of the locks.
+	struct alignas(64) shard {
+		/// Lock of this shard.
+		mutable std::mutex mutex;
+		/// Sessions in this shard, from most to least recently used.
+		std::list<entry> sessions;
+		/// Position of every session in @ref sessions.
+		std::unordered_map<std::string, std::list<entry>::iterator> index;
+	};
+
+	/// Returns the shard where the session @e id is stored.
+	[[nodiscard]] shard& get_shard(const std::string& id) noexcept
+	{
+		return m_shards[std::hash<std::string>{}(id) % m_num_shards];
+	}
+
+	/// Calls @ref expire every @ref m_sweep_interval until stopped.
+	void sweep(std::stop_token stop);
+
+private:
+
+	/// The shards of the table.
+	std::array<shard, NUM_SHARDS> m_shards;
+
+	/// Number of shards used, fewer than @ref NUM_SHARDS when the maximum
+	/// number of sessions is smaller.
+	const size_t m_num_shards;
+	/// Maximum number of sessions in a shard.
+	const size_t m_max_per_shard;
+	/// Time after which an idle session is removed.
+	const clock::duration m_idle_timeout;
+	/// Time between two sweeps.
+	const clock::duration m_sweep_interval;
+
+	/// Number of sessions removed for being idle.
+	std::atomic<size_t> m_num_expired = 0;
+	/// Number of sessions evicted to make room for new ones.
+	std::atomic<size_t> m_num_evicted = 0;
+
+	/// Lock used to wait between sweeps.
+	std::mutex m_sweeper_mutex;
+	/// Used to wake up the sweeper when the table is destroyed.
+	std::condition_variable_any m_sweeper_cv;
+	/// The thread removing idle sessions. Declared last so that it is
+	/// stopped before anything else is destroyed.
+	std::jthread m_sweeper;
+};